@@ -0,0 +1,869 @@
+/*
+ * delta - binary delta patches between two releases of a tool
+ *
+ *   delta apply <old> <patch> <new>         rebuild <new> from <old>
+ *   delta apply-bundle <bundle> <install>   apply a whole per-arch bundle
+ *   delta info <patch>
+ *   delta diff <old> <new> <patch>          (host build, -DDELTA_WITH_DIFF)
+ *
+ * The diff is bsdiff-style: the new file is described as runs of bytes
+ * "added" to a region of the old file (the differences are mostly zero for
+ * recompiled code that only moved) plus runs of fresh "extra" bytes. Each
+ * stream is packed with a small LZ77 codec so the apply side needs no
+ * compression library and stays a few KB when linked statically.
+ *
+ * Every patch records the SHA-256 of the file it was made against and of
+ * the file it produces; apply refuses a different base and never renames
+ * a result into place unless it matches.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PATCH_MAGIC     "SDP1"
+#define INDEX_NAME      "DELTA"
+#define TMP_SUFFIX      ".delta-new"
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} buf_t;
+
+static void die(const char *fmt, const char *arg) {
+    fprintf(stderr, "delta: ");
+    fprintf(stderr, fmt, arg);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void *xmalloc(size_t len) {
+    void *p = malloc(len ? len : 1);
+    if (!p)
+        die("%s", "out of memory");
+    return p;
+}
+
+static void buf_put(buf_t *b, const void *src, size_t len) {
+    if (b->len + len > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + len)
+            cap *= 2;
+        b->data = realloc(b->data, cap);
+        if (!b->data)
+            die("%s", "out of memory");
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, src, len);
+    b->len += len;
+}
+
+#ifdef DELTA_WITH_DIFF
+static void buf_byte(buf_t *b, uint8_t c) {
+    buf_put(b, &c, 1);
+}
+
+static void buf_varint(buf_t *b, uint64_t v) {
+    while (v >= 0x80) {
+        buf_byte(b, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    buf_byte(b, (uint8_t)v);
+}
+#endif
+
+// Reads a varint at *pos; returns -1 on truncated input
+static int get_varint(const uint8_t *p, size_t len, size_t *pos, uint64_t *out) {
+    uint64_t v = 0;
+    int shift = 0;
+
+    while (*pos < len && shift < 64) {
+        uint8_t c = p[(*pos)++];
+        v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            *out = v;
+            return 0;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+static int read_file(const char *path, buf_t *b) {
+    FILE *f = fopen(path, "rb");
+    uint8_t chunk[65536];
+    size_t n;
+
+    memset(b, 0, sizeof(*b));
+    if (!f)
+        return -1;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buf_put(b, chunk, n);
+    if (ferror(f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+// ---------------------------------------------------------------- SHA-256
+
+typedef struct {
+    uint32_t h[8];
+    uint64_t bytes;
+    uint8_t block[64];
+} sha256_t;
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(sha256_t *s, const uint8_t *p) {
+    uint32_t w[64], a, b, c, d, e, f, g, h, t1, t2;
+    int i;
+
+    for (i = 0; i < 16; i++)
+        w[i] = (uint32_t)p[i * 4] << 24 | (uint32_t)p[i * 4 + 1] << 16 |
+               (uint32_t)p[i * 4 + 2] << 8 | p[i * 4 + 3];
+    for (i = 16; i < 64; i++)
+        w[i] = w[i - 16] + (ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+               w[i - 7] + (ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10));
+
+    a = s->h[0]; b = s->h[1]; c = s->h[2]; d = s->h[3];
+    e = s->h[4]; f = s->h[5]; g = s->h[6]; h = s->h[7];
+    for (i = 0; i < 64; i++) {
+        t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    s->h[0] += a; s->h[1] += b; s->h[2] += c; s->h[3] += d;
+    s->h[4] += e; s->h[5] += f; s->h[6] += g; s->h[7] += h;
+}
+
+static void sha256(const uint8_t *data, size_t len, uint8_t out[32]) {
+    static const uint32_t init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    sha256_t s;
+    size_t i;
+
+    memcpy(s.h, init, sizeof(init));
+    s.bytes = len;
+    for (; len >= 64; data += 64, len -= 64)
+        sha256_block(&s, data);
+
+    memset(s.block, 0, sizeof(s.block));
+    memcpy(s.block, data, len);
+    s.block[len] = 0x80;
+    if (len >= 56) {
+        sha256_block(&s, s.block);
+        memset(s.block, 0, sizeof(s.block));
+    }
+    for (i = 0; i < 8; i++)
+        s.block[63 - i] = (uint8_t)((s.bytes * 8) >> (i * 8));
+    sha256_block(&s, s.block);
+
+    for (i = 0; i < 32; i++)
+        out[i] = (uint8_t)(s.h[i / 4] >> (24 - (i % 4) * 8));
+}
+
+static void hex_digest(const uint8_t digest[32], char out[65]) {
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        out[i * 2] = hex[digest[i] >> 4];
+        out[i * 2 + 1] = hex[digest[i] & 15];
+    }
+    out[64] = '\0';
+}
+
+// ---------------------------------------------------------------- LZ77
+//
+// A stream is a series of sequences: token byte (literal count in the high
+// nibble, match length - 4 in the low one, 15 meaning "more follows as a
+// varint"), the literals, then the match offset as a varint. The last
+// sequence ends after its literals, which the decoder knows from the
+// uncompressed length stored in front of the stream.
+
+#define LZ_MIN_MATCH    4
+#define LZ_HASH_BITS    16
+#define LZ_CHAIN_DEPTH  32
+
+#ifdef DELTA_WITH_DIFF
+static uint32_t lz_hash(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void lz_sequence(buf_t *out, const uint8_t *lit, size_t nlit, size_t mlen, size_t off) {
+    size_t mcode = mlen ? mlen - LZ_MIN_MATCH : 0;
+
+    buf_byte(out, (uint8_t)((nlit < 15 ? nlit : 15) << 4 | (mcode < 15 ? mcode : 15)));
+    if (nlit >= 15)
+        buf_varint(out, nlit - 15);
+    buf_put(out, lit, nlit);
+    if (!mlen)
+        return;
+    if (mcode >= 15)
+        buf_varint(out, mcode - 15);
+    buf_varint(out, off);
+}
+
+static void lz_compress(const uint8_t *in, size_t len, buf_t *out) {
+    int32_t *head = xmalloc(sizeof(int32_t) << LZ_HASH_BITS);
+    int32_t *prev = xmalloc(sizeof(int32_t) * (len ? len : 1));
+    size_t pos = 0, anchor = 0;
+
+    memset(head, 0xff, sizeof(int32_t) << LZ_HASH_BITS);
+    while (pos + LZ_MIN_MATCH <= len) {
+        uint32_t h = lz_hash(in + pos);
+        size_t best_len = 0, best_off = 0;
+        int32_t cand = head[h];
+        int depth = LZ_CHAIN_DEPTH;
+
+        for (; cand >= 0 && depth--; cand = prev[cand]) {
+            size_t n = 0;
+            while (pos + n < len && in[cand + n] == in[pos + n])
+                n++;
+            if (n > best_len) {
+                best_len = n;
+                best_off = pos - (size_t)cand;
+            }
+        }
+        prev[pos] = head[h];
+        head[h] = (int32_t)pos;
+
+        if (best_len < LZ_MIN_MATCH) {
+            pos++;
+            continue;
+        }
+        lz_sequence(out, in + anchor, pos - anchor, best_len, best_off);
+        // Index the matched bytes too, so long runs keep finding themselves
+        while (--best_len) {
+            pos++;
+            if (pos + LZ_MIN_MATCH <= len) {
+                h = lz_hash(in + pos);
+                prev[pos] = head[h];
+                head[h] = (int32_t)pos;
+            }
+        }
+        anchor = ++pos;
+    }
+    lz_sequence(out, in + anchor, len - anchor, 0, 0);
+    free(head);
+    free(prev);
+}
+#endif
+
+static int lz_decompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    size_t ip = 0, op = 0;
+
+    while (op < out_len || ip < in_len) {
+        uint64_t nlit, mlen, off;
+        uint8_t token;
+
+        if (ip >= in_len)
+            return -1;
+        token = in[ip++];
+        nlit = token >> 4;
+        if (nlit == 15) {
+            if (get_varint(in, in_len, &ip, &nlit) < 0)
+                return -1;
+            nlit += 15;
+        }
+        if (nlit > in_len - ip || nlit > out_len - op)
+            return -1;
+        memcpy(out + op, in + ip, nlit);
+        ip += nlit;
+        op += nlit;
+        if (op == out_len)
+            return ip == in_len ? 0 : -1;
+
+        mlen = token & 15;
+        if (mlen == 15) {
+            if (get_varint(in, in_len, &ip, &mlen) < 0)
+                return -1;
+            mlen += 15;
+        }
+        mlen += LZ_MIN_MATCH;
+        if (get_varint(in, in_len, &ip, &off) < 0 || off == 0 || off > op || mlen > out_len - op)
+            return -1;
+        // Byte by byte: overlapping copies are how runs are encoded
+        for (; mlen; mlen--, op++)
+            out[op] = out[op - off];
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------- patch format
+//
+//   "SDP1"
+//   varint old_size, varint new_size
+//   old SHA-256 (32 bytes), new SHA-256 (32 bytes)
+//   3 x { varint raw_len, varint packed_len, LZ77 data }
+//        control: (add, extra, zigzag seek) varint triples
+//        diff:    new - old bytes for every "add" run
+//        extra:   verbatim bytes for every "extra" run
+
+typedef struct {
+    uint64_t old_size;
+    uint64_t new_size;
+    uint8_t old_sha[32];
+    uint8_t new_sha[32];
+    buf_t stream[3];
+} patch_t;
+
+enum { CTRL, DIFF, EXTRA };
+
+static int parse_patch(const buf_t *file, patch_t *p) {
+    const uint8_t *d = file->data;
+    size_t pos = 4;
+    int i;
+
+    memset(p, 0, sizeof(*p));
+    if (file->len < 4 || memcmp(d, PATCH_MAGIC, 4) != 0)
+        return -1;
+    if (get_varint(d, file->len, &pos, &p->old_size) < 0 ||
+        get_varint(d, file->len, &pos, &p->new_size) < 0 || file->len - pos < 64)
+        return -1;
+    memcpy(p->old_sha, d + pos, 32);
+    memcpy(p->new_sha, d + pos + 32, 32);
+    pos += 64;
+
+    for (i = 0; i < 3; i++) {
+        uint64_t raw, packed;
+        if (get_varint(d, file->len, &pos, &raw) < 0 ||
+            get_varint(d, file->len, &pos, &packed) < 0 || packed > file->len - pos)
+            return -1;
+        // A stream never expands beyond the file it rebuilds, plus the
+        // control triples; reject absurd sizes before allocating
+        if (raw > p->new_size * 2 + 4096)
+            return -1;
+        p->stream[i].data = xmalloc(raw);
+        p->stream[i].len = raw;
+        if (lz_decompress(d + pos, packed, p->stream[i].data, raw) < 0)
+            return -1;
+        pos += packed;
+    }
+    return pos == file->len ? 0 : -1;
+}
+
+static void free_patch(patch_t *p) {
+    int i;
+    for (i = 0; i < 3; i++)
+        free(p->stream[i].data);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// Rebuilds the new file into *out; returns an error string or NULL
+static const char *apply_patch(const buf_t *old, const patch_t *p, buf_t *out) {
+    const buf_t *ctrl = &p->stream[CTRL];
+    size_t cpos = 0, dpos = 0, epos = 0;
+    uint64_t newpos = 0;
+    int64_t oldpos = 0;
+    uint8_t digest[32];
+
+    if (old->len != p->old_size)
+        return "base file has the wrong size";
+    sha256(old->data, old->len, digest);
+    if (memcmp(digest, p->old_sha, 32) != 0)
+        return "base file checksum does not match the patch";
+
+    memset(out, 0, sizeof(*out));
+    out->data = xmalloc(p->new_size);
+    out->cap = p->new_size;
+
+    while (newpos < p->new_size) {
+        uint64_t add, extra, seek, i;
+
+        if (get_varint(ctrl->data, ctrl->len, &cpos, &add) < 0 ||
+            get_varint(ctrl->data, ctrl->len, &cpos, &extra) < 0 ||
+            get_varint(ctrl->data, ctrl->len, &cpos, &seek) < 0)
+            return "truncated control stream";
+
+        if (add > p->new_size - newpos || add > p->stream[DIFF].len - dpos ||
+            oldpos < 0 || add > old->len - (uint64_t)oldpos)
+            return "corrupt add run";
+        for (i = 0; i < add; i++)
+            out->data[newpos + i] = p->stream[DIFF].data[dpos + i] + old->data[oldpos + i];
+        newpos += add;
+        dpos += add;
+        oldpos += add;
+
+        if (extra > p->new_size - newpos || extra > p->stream[EXTRA].len - epos)
+            return "corrupt extra run";
+        memcpy(out->data + newpos, p->stream[EXTRA].data + epos, extra);
+        newpos += extra;
+        epos += extra;
+
+        oldpos += unzigzag(seek);
+    }
+    out->len = p->new_size;
+
+    sha256(out->data, out->len, digest);
+    if (memcmp(digest, p->new_sha, 32) != 0)
+        return "result checksum does not match the patch";
+    return NULL;
+}
+
+// Writes next to the destination and fsyncs, so a rename can publish it
+static int write_tmp(const char *dest, const buf_t *data, mode_t mode, char *tmp, size_t tmp_len) {
+    FILE *f;
+    int ok;
+
+    snprintf(tmp, tmp_len, "%s%s", dest, TMP_SUFFIX);
+    f = fopen(tmp, "wb");
+    if (!f)
+        return -1;
+    ok = fwrite(data->data, 1, data->len, f) == data->len && fflush(f) == 0 &&
+         fsync(fileno(f)) == 0;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || chmod(tmp, mode) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static int load_patch(const char *path, patch_t *p) {
+    buf_t file;
+    int rc;
+
+    if (read_file(path, &file) < 0)
+        return -1;
+    rc = parse_patch(&file, p);
+    free(file.data);
+    return rc;
+}
+
+static int cmd_apply(const char *old_path, const char *patch_path, const char *new_path) {
+    buf_t old, out;
+    patch_t p;
+    const char *err;
+    char tmp[4096];
+    struct stat st;
+    mode_t mode = 0755;
+
+    if (load_patch(patch_path, &p) < 0)
+        die("%s: not a valid patch", patch_path);
+    if (read_file(old_path, &old) < 0)
+        die("cannot read %s", old_path);
+    if (stat(old_path, &st) == 0 && S_ISREG(st.st_mode))
+        mode = st.st_mode & 07777;
+
+    err = apply_patch(&old, &p, &out);
+    if (err)
+        die("%s", err);
+    if (write_tmp(new_path, &out, mode, tmp, sizeof(tmp)) < 0 || rename(tmp, new_path) < 0)
+        die("cannot write %s", new_path);
+
+    printf("%s: %llu bytes, sha256 verified\n", new_path, (unsigned long long)out.len);
+    free(old.data);
+    free(out.data);
+    free_patch(&p);
+    return 0;
+}
+
+static int cmd_info(const char *patch_path) {
+    patch_t p;
+    char hex[65];
+
+    if (load_patch(patch_path, &p) < 0)
+        die("%s: not a valid patch", patch_path);
+    hex_digest(p.old_sha, hex);
+    printf("old: %llu bytes  sha256 %s\n", (unsigned long long)p.old_size, hex);
+    hex_digest(p.new_sha, hex);
+    printf("new: %llu bytes  sha256 %s\n", (unsigned long long)p.new_size, hex);
+    printf("diff %zu bytes, extra %zu bytes\n", p.stream[DIFF].len, p.stream[EXTRA].len);
+    free_patch(&p);
+    return 0;
+}
+
+// ---------------------------------------------------------------- bundles
+//
+// A bundle directory holds an index named DELTA plus patches/<entry>.sdp.
+// Index lines:
+//   patch <mode> <old sha256 | -> <new sha256> <entry>
+//   delete <old sha256> <entry>
+// "-" means the entry is new and the patch applies to an empty file.
+
+typedef struct {
+    char kind[8];
+    unsigned mode;
+    char old_sha[65];
+    char new_sha[65];
+    char entry[1024];
+} index_line_t;
+
+static int file_sha(const char *path, char hex[65]) {
+    buf_t b;
+    uint8_t digest[32];
+
+    if (read_file(path, &b) < 0)
+        return -1;
+    sha256(b.data, b.len, digest);
+    hex_digest(digest, hex);
+    free(b.data);
+    return 0;
+}
+
+static int parse_index_line(const char *line, index_line_t *l) {
+    memset(l, 0, sizeof(*l));
+    if (sscanf(line, "patch %o %64s %64s %1023s", &l->mode, l->old_sha, l->new_sha, l->entry) == 4) {
+        strcpy(l->kind, "patch");
+        return 0;
+    }
+    if (sscanf(line, "delete %64s %1023s", l->old_sha, l->entry) == 2) {
+        strcpy(l->kind, "delete");
+        return 0;
+    }
+    return -1;
+}
+
+static void make_parents(const char *path) {
+    char dir[4096];
+    char *p;
+
+    snprintf(dir, sizeof(dir), "%s", path);
+    for (p = dir + 1; (p = strchr(p, '/')); p++) {
+        *p = '\0';
+        mkdir(dir, 0755);
+        *p = '/';
+    }
+}
+
+// Two passes: first build and verify every patched file next to its
+// destination, then rename them all, so a bad bundle leaves the install
+// untouched rather than half updated.
+static int cmd_apply_bundle(const char *bundle, const char *install) {
+    char path[4096], target[4096], tmp[4096 + sizeof(TMP_SUFFIX)], line[2048], have[65];
+    int pass, applied = 0, skipped = 0, removed = 0, failed = 0;
+
+    for (pass = 0; pass < 2 && !failed; pass++) {
+        FILE *idx;
+
+        snprintf(path, sizeof(path), "%s/%s", bundle, INDEX_NAME);
+        idx = fopen(path, "r");
+        if (!idx)
+            die("cannot open %s", path);
+
+        while (fgets(line, sizeof(line), idx)) {
+            index_line_t l;
+
+            if (line[0] == '#' || line[0] == '\n')
+                continue;
+            if (parse_index_line(line, &l) < 0 || strstr(l.entry, "..") || l.entry[0] == '/') {
+                fprintf(stderr, "delta: bad index line: %s", line);
+                failed++;
+                continue;
+            }
+            snprintf(target, sizeof(target), "%s/%s", install, l.entry);
+
+            if (strcmp(l.kind, "delete") == 0) {
+                if (pass == 1 && file_sha(target, have) == 0 && strcmp(have, l.old_sha) == 0 &&
+                    unlink(target) == 0)
+                    removed++;
+                continue;
+            }
+
+            if (file_sha(target, have) == 0 && strcmp(have, l.new_sha) == 0) {
+                skipped += pass;        // already up to date
+                continue;
+            }
+
+            if (pass == 0) {
+                buf_t old = { 0 }, out;
+                patch_t p;
+                const char *err = NULL;
+
+                snprintf(path, sizeof(path), "%s/patches/%s.sdp", bundle, l.entry);
+                if (load_patch(path, &p) < 0) {
+                    err = "missing or invalid patch";
+                } else {
+                    if (strcmp(l.old_sha, "-") != 0 && read_file(target, &old) < 0)
+                        err = "not installed";
+                    if (!err)
+                        err = apply_patch(&old, &p, &out);
+                    if (!err) {
+                        make_parents(target);
+                        if (write_tmp(target, &out, l.mode, tmp, sizeof(tmp)) < 0)
+                            err = strerror(errno);
+                        free(out.data);
+                    }
+                    free_patch(&p);
+                }
+                free(old.data);
+                if (err) {
+                    fprintf(stderr, "delta: %s: %s\n", l.entry, err);
+                    failed++;
+                }
+            } else {
+                snprintf(tmp, sizeof(tmp), "%s%s", target, TMP_SUFFIX);
+                if (rename(tmp, target) < 0) {
+                    fprintf(stderr, "delta: %s: %s\n", l.entry, strerror(errno));
+                    failed++;
+                } else {
+                    applied++;
+                }
+            }
+        }
+        fclose(idx);
+    }
+
+    if (failed) {
+        // Drop whatever pass 0 staged
+        FILE *idx;
+        snprintf(path, sizeof(path), "%s/%s", bundle, INDEX_NAME);
+        if ((idx = fopen(path, "r"))) {
+            while (fgets(line, sizeof(line), idx)) {
+                index_line_t l;
+                if (parse_index_line(line, &l) == 0) {
+                    snprintf(tmp, sizeof(tmp), "%s/%s%s", install, l.entry, TMP_SUFFIX);
+                    unlink(tmp);
+                }
+            }
+            fclose(idx);
+        }
+        fprintf(stderr, "delta: %d entries failed, nothing was changed\n", failed);
+        return 1;
+    }
+    printf("%d updated, %d already current, %d removed\n", applied, skipped, removed);
+    return 0;
+}
+
+// ---------------------------------------------------------------- diff
+
+#ifdef DELTA_WITH_DIFF
+#define MATCH_HASH_BITS 20
+#define MATCH_MIN       8
+#define MATCH_DEPTH     64
+
+typedef struct {
+    const uint8_t *old;
+    size_t old_len;
+    int32_t *head;
+    int32_t *prev;
+} match_index_t;
+
+static uint32_t match_hash(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return (uint32_t)((v * 0x9e3779b97f4a7c15ull) >> (64 - MATCH_HASH_BITS));
+}
+
+static void index_old(match_index_t *ix, const uint8_t *old, size_t len) {
+    size_t i;
+
+    ix->old = old;
+    ix->old_len = len;
+    ix->head = xmalloc(sizeof(int32_t) << MATCH_HASH_BITS);
+    ix->prev = xmalloc(sizeof(int32_t) * (len ? len : 1));
+    memset(ix->head, 0xff, sizeof(int32_t) << MATCH_HASH_BITS);
+    for (i = 0; i + MATCH_MIN <= len; i++) {
+        uint32_t h = match_hash(old + i);
+        ix->prev[i] = ix->head[h];
+        ix->head[h] = (int32_t)i;
+    }
+}
+
+// Longest exact match of new[pos..] in old; 0 if shorter than MATCH_MIN
+static size_t longest_match(const match_index_t *ix, const uint8_t *new, size_t new_len,
+                            size_t pos, size_t *old_pos) {
+    size_t best = 0;
+    int32_t cand;
+    int depth = MATCH_DEPTH;
+
+    if (pos + MATCH_MIN > new_len)
+        return 0;
+    for (cand = ix->head[match_hash(new + pos)]; cand >= 0 && depth--; cand = ix->prev[cand]) {
+        size_t n = 0;
+        while (pos + n < new_len && cand + n < ix->old_len && ix->old[cand + n] == new[pos + n])
+            n++;
+        if (n > best) {
+            best = n;
+            *old_pos = cand;
+        }
+    }
+    return best >= MATCH_MIN ? best : 0;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+// The bsdiff scan: walk the new file looking for exact matches that beat
+// simply continuing at the previous offset, then grow each match forwards
+// and backwards while at least half the bytes still agree. Those fuzzy
+// regions become "add" runs whose differences are nearly all zero.
+static void make_diff(const buf_t *old, const buf_t *new, buf_t *ctrl, buf_t *diff, buf_t *extra) {
+    const uint8_t *o = old->data, *n = new->data;
+    size_t olen = old->len, nlen = new->len;
+    size_t scan = 0, len = 0, pos = 0, lastscan = 0, lastpos = 0;
+    int64_t lastoffset = 0;
+    match_index_t ix;
+
+    index_old(&ix, o, olen);
+
+    while (scan < nlen) {
+        int64_t oldscore = 0;
+        size_t scsc;
+
+        for (scsc = scan += len; scan < nlen; scan++) {
+            len = longest_match(&ix, n, nlen, scan, &pos);
+            for (; scsc < scan + len; scsc++)
+                if ((int64_t)scsc + lastoffset >= 0 && scsc + lastoffset < olen &&
+                    o[scsc + lastoffset] == n[scsc])
+                    oldscore++;
+            if (((int64_t)len == oldscore && len != 0) || (int64_t)len > oldscore + 8)
+                break;
+            if ((int64_t)scan + lastoffset >= 0 && scan + lastoffset < olen &&
+                o[scan + lastoffset] == n[scan])
+                oldscore--;
+        }
+
+        if ((int64_t)len != oldscore || scan == nlen) {
+            size_t i, lenf = 0, lenb = 0;
+            int64_t s, best;
+
+            for (i = 0, s = 0, best = 0; lastscan + i < scan && lastpos + i < olen;) {
+                if (o[lastpos + i] == n[lastscan + i])
+                    s++;
+                i++;
+                if (s * 2 - (int64_t)i > best * 2 - (int64_t)lenf) {
+                    best = s;
+                    lenf = i;
+                }
+            }
+
+            if (scan < nlen) {
+                for (i = 1, s = 0, best = 0; scan >= lastscan + i && pos >= i; i++) {
+                    if (o[pos - i] == n[scan - i])
+                        s++;
+                    if (s * 2 - (int64_t)i > best * 2 - (int64_t)lenb) {
+                        best = s;
+                        lenb = i;
+                    }
+                }
+            }
+
+            if (lastscan + lenf > scan - lenb) {
+                size_t overlap = (lastscan + lenf) - (scan - lenb), lens = 0;
+                for (i = 0, s = 0, best = 0; i < overlap; i++) {
+                    if (n[lastscan + lenf - overlap + i] == o[lastpos + lenf - overlap + i])
+                        s++;
+                    if (n[scan - lenb + i] == o[pos - lenb + i])
+                        s--;
+                    if (s > best) {
+                        best = s;
+                        lens = i + 1;
+                    }
+                }
+                lenf += lens - overlap;
+                lenb -= lens;
+            }
+
+            for (i = 0; i < lenf; i++)
+                buf_byte(diff, (uint8_t)(n[lastscan + i] - o[lastpos + i]));
+            buf_put(extra, n + lastscan + lenf, (scan - lenb) - (lastscan + lenf));
+
+            buf_varint(ctrl, lenf);
+            buf_varint(ctrl, (scan - lenb) - (lastscan + lenf));
+            buf_varint(ctrl, zigzag((int64_t)(pos - lenb) - (int64_t)(lastpos + lenf)));
+
+            lastscan = scan - lenb;
+            lastpos = pos - lenb;
+            lastoffset = (int64_t)pos - (int64_t)scan;
+        }
+    }
+    free(ix.head);
+    free(ix.prev);
+}
+
+static int cmd_diff(const char *old_path, const char *new_path, const char *patch_path) {
+    buf_t old, new, streams[3] = { { 0 } }, out = { 0 };
+    uint8_t digest[32];
+    FILE *f;
+    int i;
+
+    if (read_file(old_path, &old) < 0)
+        die("cannot read %s", old_path);
+    if (read_file(new_path, &new) < 0)
+        die("cannot read %s", new_path);
+    if (old.len > INT32_MAX || new.len > INT32_MAX)
+        die("%s", "files over 2 GB are not supported");
+
+    make_diff(&old, &new, &streams[CTRL], &streams[DIFF], &streams[EXTRA]);
+
+    buf_put(&out, PATCH_MAGIC, 4);
+    buf_varint(&out, old.len);
+    buf_varint(&out, new.len);
+    sha256(old.data, old.len, digest);
+    buf_put(&out, digest, 32);
+    sha256(new.data, new.len, digest);
+    buf_put(&out, digest, 32);
+    for (i = 0; i < 3; i++) {
+        buf_t packed = { 0 };
+        lz_compress(streams[i].data, streams[i].len, &packed);
+        buf_varint(&out, streams[i].len);
+        buf_varint(&out, packed.len);
+        buf_put(&out, packed.data, packed.len);
+        free(packed.data);
+        free(streams[i].data);
+    }
+
+    f = fopen(patch_path, "wb");
+    if (!f || fwrite(out.data, 1, out.len, f) != out.len || fclose(f) != 0)
+        die("cannot write %s", patch_path);
+    printf("%s: %zu -> %zu bytes, patch %zu bytes\n", new_path, old.len, new.len, out.len);
+    free(old.data);
+    free(new.data);
+    free(out.data);
+    return 0;
+}
+#endif
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s apply <old> <patch> <new>\n", prog);
+    fprintf(stderr, "       %s apply-bundle <bundle-dir> <install-dir>\n", prog);
+    fprintf(stderr, "       %s info <patch>\n", prog);
+#ifdef DELTA_WITH_DIFF
+    fprintf(stderr, "       %s diff <old> <new> <patch>\n", prog);
+#endif
+    fprintf(stderr, "\nUse /dev/null as <old> for a patch made against an empty file.\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 5 && strcmp(argv[1], "apply") == 0)
+        return cmd_apply(argv[2], argv[3], argv[4]);
+    if (argc == 4 && strcmp(argv[1], "apply-bundle") == 0)
+        return cmd_apply_bundle(argv[2], argv[3]);
+    if (argc == 3 && strcmp(argv[1], "info") == 0)
+        return cmd_info(argv[2]);
+#ifdef DELTA_WITH_DIFF
+    if (argc == 5 && strcmp(argv[1], "diff") == 0)
+        return cmd_diff(argv[2], argv[3], argv[4]);
+#endif
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,293 @@
+#include "cpu-features.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// x86 asks cpuid directly; hwcaps there only mirror part of it
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#elif defined(__linux__)
+    #include <sys/auxv.h>
+    #define HAVE_GETAUXVAL
+#endif
+
+#ifndef AT_HWCAP
+    #define AT_HWCAP 16
+#endif
+#ifndef AT_HWCAP2
+    #define AT_HWCAP2 26
+#endif
+
+// Kernel hwcap bits (arch/*/include/uapi/asm/hwcap.h), spelled out so old
+// kernel headers in a toolchain don't matter
+#define ARM_HWCAP_VFP         (1ul << 6)
+#define ARM_HWCAP_NEON        (1ul << 12)
+#define ARM_HWCAP2_AES        (1ul << 0)
+#define ARM_HWCAP2_PMULL      (1ul << 1)
+#define ARM_HWCAP2_SHA1       (1ul << 2)
+#define ARM_HWCAP2_SHA2       (1ul << 3)
+#define ARM_HWCAP2_CRC32      (1ul << 4)
+
+#define ARM64_HWCAP_FP        (1ul << 0)
+#define ARM64_HWCAP_ASIMD     (1ul << 1)
+#define ARM64_HWCAP_AES       (1ul << 3)
+#define ARM64_HWCAP_PMULL     (1ul << 4)
+#define ARM64_HWCAP_SHA1      (1ul << 5)
+#define ARM64_HWCAP_SHA2      (1ul << 6)
+#define ARM64_HWCAP_CRC32     (1ul << 7)
+
+#define PPC_HWCAP_FPU         0x08000000ul
+#define PPC_HWCAP_ALTIVEC     0x10000000ul
+#define PPC_HWCAP2_VEC_CRYPTO 0x02000000ul
+
+#define MIPS_HWCAP_MSA        (1ul << 1)
+
+#define RISCV_HWCAP_ISA(c)    (1ul << ((c) - 'A'))
+
+// Same order as the CPU_FEAT_* bits
+static const char *const feature_names[] = {
+    "fp", "neon", "aes", "pmull", "sha1", "sha2", "crc32",
+    "sse2", "sse4.2", "avx2", "altivec", "msa", "rvv",
+};
+
+static unsigned detected;
+static const char *detected_source;
+
+// What the compiler was allowed to assume; always present at run time
+static unsigned compile_time_features(void) {
+    unsigned f = 0;
+
+    #if defined(__ARM_FP) || defined(__riscv_flen) || defined(__mips_hard_float) || \
+        defined(__x86_64__) || defined(__SSE2__)
+        f |= CPU_FEAT_FP;
+    #endif
+    #if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        f |= CPU_FEAT_NEON;
+    #endif
+    #if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+        f |= CPU_FEAT_AES | CPU_FEAT_PMULL;
+    #endif
+    #if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+        f |= CPU_FEAT_SHA1 | CPU_FEAT_SHA2;
+    #endif
+    #if defined(__ARM_FEATURE_CRC32)
+        f |= CPU_FEAT_CRC32;
+    #endif
+    #if defined(__SSE2__)
+        f |= CPU_FEAT_SSE2;
+    #endif
+    #if defined(__SSE4_2__)
+        f |= CPU_FEAT_SSE42 | CPU_FEAT_CRC32;
+    #endif
+    #if defined(__AES__)
+        f |= CPU_FEAT_AES;
+    #endif
+    #if defined(__PCLMUL__)
+        f |= CPU_FEAT_PMULL;
+    #endif
+    #if defined(__AVX2__)
+        f |= CPU_FEAT_AVX2;
+    #endif
+    #if defined(__ALTIVEC__)
+        f |= CPU_FEAT_ALTIVEC;
+    #endif
+    #if defined(__mips_msa)
+        f |= CPU_FEAT_MSA;
+    #endif
+    #if defined(__riscv_vector)
+        f |= CPU_FEAT_RVV;
+    #endif
+    return f;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static unsigned cpuid_features(void) {
+    unsigned eax, ebx, ecx, edx, f = 0;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if (edx & (1u << 0))  f |= CPU_FEAT_FP;
+        if (edx & (1u << 26)) f |= CPU_FEAT_SSE2;
+        if (ecx & (1u << 1))  f |= CPU_FEAT_PMULL;
+        if (ecx & (1u << 20)) f |= CPU_FEAT_SSE42 | CPU_FEAT_CRC32;
+        if (ecx & (1u << 25)) f |= CPU_FEAT_AES;
+    }
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        if (ebx & (1u << 5))  f |= CPU_FEAT_AVX2;
+        if (ebx & (1u << 29)) f |= CPU_FEAT_SHA1 | CPU_FEAT_SHA2;
+    }
+    return f;
+}
+#endif
+
+#ifdef HAVE_GETAUXVAL
+static unsigned hwcap_features(unsigned long hwcap, unsigned long hwcap2) {
+    unsigned f = 0;
+
+    #if defined(__aarch64__)
+        (void)hwcap2;
+        if (hwcap & ARM64_HWCAP_FP)    f |= CPU_FEAT_FP;
+        if (hwcap & ARM64_HWCAP_ASIMD) f |= CPU_FEAT_NEON;
+        if (hwcap & ARM64_HWCAP_AES)   f |= CPU_FEAT_AES;
+        if (hwcap & ARM64_HWCAP_PMULL) f |= CPU_FEAT_PMULL;
+        if (hwcap & ARM64_HWCAP_SHA1)  f |= CPU_FEAT_SHA1;
+        if (hwcap & ARM64_HWCAP_SHA2)  f |= CPU_FEAT_SHA2;
+        if (hwcap & ARM64_HWCAP_CRC32) f |= CPU_FEAT_CRC32;
+    #elif defined(__arm__)
+        if (hwcap & ARM_HWCAP_VFP)     f |= CPU_FEAT_FP;
+        if (hwcap & ARM_HWCAP_NEON)    f |= CPU_FEAT_NEON;
+        if (hwcap2 & ARM_HWCAP2_AES)   f |= CPU_FEAT_AES;
+        if (hwcap2 & ARM_HWCAP2_PMULL) f |= CPU_FEAT_PMULL;
+        if (hwcap2 & ARM_HWCAP2_SHA1)  f |= CPU_FEAT_SHA1;
+        if (hwcap2 & ARM_HWCAP2_SHA2)  f |= CPU_FEAT_SHA2;
+        if (hwcap2 & ARM_HWCAP2_CRC32) f |= CPU_FEAT_CRC32;
+    #elif defined(__powerpc__) || defined(__PPC__)
+        if (hwcap & PPC_HWCAP_FPU)     f |= CPU_FEAT_FP;
+        if (hwcap & PPC_HWCAP_ALTIVEC) f |= CPU_FEAT_ALTIVEC;
+        if (hwcap2 & PPC_HWCAP2_VEC_CRYPTO)
+            f |= CPU_FEAT_AES | CPU_FEAT_PMULL | CPU_FEAT_SHA2;
+    #elif defined(__mips__)
+        (void)hwcap2;
+        if (hwcap & MIPS_HWCAP_MSA)    f |= CPU_FEAT_MSA;
+    #elif defined(__riscv)
+        (void)hwcap2;
+        if (hwcap & (RISCV_HWCAP_ISA('F') | RISCV_HWCAP_ISA('D'))) f |= CPU_FEAT_FP;
+        if (hwcap & RISCV_HWCAP_ISA('V')) f |= CPU_FEAT_RVV;
+    #else
+        (void)hwcap;
+        (void)hwcap2;
+    #endif
+    return f;
+}
+
+static const struct {
+    const char *name;
+    unsigned feat;
+} cpuinfo_names[] = {
+    { "vfp", CPU_FEAT_FP },        { "vfpv3", CPU_FEAT_FP },
+    { "vfpv4", CPU_FEAT_FP },      { "fp", CPU_FEAT_FP },
+    { "fpu", CPU_FEAT_FP },        { "neon", CPU_FEAT_NEON },
+    { "asimd", CPU_FEAT_NEON },    { "aes", CPU_FEAT_AES },
+    { "pmull", CPU_FEAT_PMULL },   { "pclmulqdq", CPU_FEAT_PMULL },
+    { "sha1", CPU_FEAT_SHA1 },     { "sha2", CPU_FEAT_SHA2 },
+    { "sha_ni", CPU_FEAT_SHA1 | CPU_FEAT_SHA2 },
+    { "crc32", CPU_FEAT_CRC32 },   { "sse2", CPU_FEAT_SSE2 },
+    { "sse4_2", CPU_FEAT_SSE42 | CPU_FEAT_CRC32 },
+    { "avx2", CPU_FEAT_AVX2 },     { "altivec", CPU_FEAT_ALTIVEC },
+    { "msa", CPU_FEAT_MSA },
+};
+
+// RISC-V "isa : rv64imafdcv_zicsr..." - single-letter extensions only
+static unsigned riscv_isa_features(const char *isa) {
+    unsigned f = 0;
+
+    if (strncmp(isa, "rv32", 4) != 0 && strncmp(isa, "rv64", 4) != 0)
+        return 0;
+    for (isa += 4; *isa && *isa != '_' && *isa != '\n'; isa++) {
+        if (*isa == 'f' || *isa == 'd') f |= CPU_FEAT_FP;
+        if (*isa == 'v') f |= CPU_FEAT_RVV;
+    }
+    return f;
+}
+
+// Feature lines of the first CPU listed: "Features" (ARM), "flags" (x86),
+// "ASEs implemented" (MIPS), "cpu" (PowerPC), "isa" (RISC-V)
+static unsigned cpuinfo_features(void) {
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    char line[4096];
+    unsigned f = 0;
+    int seen = 0;
+
+    if (!fp)
+        return 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        char *colon = strchr(line, ':');
+        char *tok, *save;
+        size_t key_len;
+
+        if (line[0] == '\n' && seen)
+            break;
+        if (!colon)
+            continue;
+        key_len = strcspn(line, "\t:");
+        if (key_len == 3 && strncmp(line, "isa", 3) == 0) {
+            f |= riscv_isa_features(colon + 2);
+            seen = 1;
+            continue;
+        }
+        if (!(key_len == 8 && strncmp(line, "Features", 8) == 0) &&
+            !(key_len == 5 && strncmp(line, "flags", 5) == 0) &&
+            !(key_len == 16 && strncmp(line, "ASEs implemented", 16) == 0) &&
+            !(key_len == 3 && strncmp(line, "cpu", 3) == 0))
+            continue;
+
+        seen = 1;
+        for (tok = strtok_r(colon + 1, " ,\t\n", &save); tok; tok = strtok_r(NULL, " ,\t\n", &save)) {
+            size_t i;
+            for (i = 0; i < sizeof(cpuinfo_names) / sizeof(cpuinfo_names[0]); i++) {
+                if (strcmp(tok, cpuinfo_names[i].name) == 0)
+                    f |= cpuinfo_names[i].feat;
+            }
+        }
+    }
+    fclose(fp);
+    return f;
+}
+#endif
+
+unsigned cpu_features(void) {
+    if (detected_source)
+        return detected;
+
+    detected = compile_time_features();
+    detected_source = "compile-time";
+
+    #if defined(__x86_64__) || defined(__i386__)
+        detected |= cpuid_features();
+        detected_source = "cpuid";
+    #elif defined(HAVE_GETAUXVAL)
+    {
+        unsigned long hwcap = getauxval(AT_HWCAP);
+        unsigned long hwcap2 = getauxval(AT_HWCAP2);
+        unsigned f;
+
+        if (hwcap || hwcap2) {
+            detected |= hwcap_features(hwcap, hwcap2);
+            detected_source = "hwcap";
+        } else if ((f = cpuinfo_features()) != 0) {
+            detected |= f;
+            detected_source = "cpuinfo";
+        }
+    }
+    #endif
+    return detected;
+}
+
+int cpu_has(unsigned mask) {
+    return (cpu_features() & mask) == mask;
+}
+
+const char *cpu_features_source(void) {
+    cpu_features();
+    return detected_source;
+}
+
+void cpu_features_format(char *buf, size_t len) {
+    unsigned f = cpu_features();
+    size_t used = 0, i;
+
+    if (len == 0)
+        return;
+    buf[0] = '\0';
+    for (i = 0; i < sizeof(feature_names) / sizeof(feature_names[0]); i++) {
+        if (!(f & (1u << i)))
+            continue;
+        int n = snprintf(buf + used, len - used, "%s%s", used ? " " : "", feature_names[i]);
+        if (n < 0 || (size_t)n >= len - used)
+            break;
+        used += n;
+    }
+    if (used == 0)
+        snprintf(buf, len, "none");
+}
@@ -0,0 +1,41 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stddef.h>
+
+// Runtime CPU feature detection, so one binary per arch can pick fast code
+// paths on the CPU it actually runs on instead of baking them in at compile
+// time. Linux reads the kernel's hwcaps (getauxval AT_HWCAP/AT_HWCAP2) and
+// falls back to /proc/cpuinfo; x86 asks cpuid; everything else only reports
+// what the compiler was told to assume.
+
+#define CPU_FEAT_FP       (1u << 0)   // hardware floating point (VFP on ARM32)
+#define CPU_FEAT_NEON     (1u << 1)   // ARM Advanced SIMD (ASIMD on AArch64)
+#define CPU_FEAT_AES      (1u << 2)   // AES instructions (ARMv8 CE, AES-NI)
+#define CPU_FEAT_PMULL    (1u << 3)   // carry-less multiply (PMULL, PCLMULQDQ)
+#define CPU_FEAT_SHA1     (1u << 4)
+#define CPU_FEAT_SHA2     (1u << 5)
+#define CPU_FEAT_CRC32    (1u << 6)   // CRC32 instructions (CRC32C only on x86)
+#define CPU_FEAT_SSE2     (1u << 7)
+#define CPU_FEAT_SSE42    (1u << 8)
+#define CPU_FEAT_AVX2     (1u << 9)
+#define CPU_FEAT_ALTIVEC  (1u << 10)
+#define CPU_FEAT_MSA      (1u << 11)  // MIPS SIMD Architecture
+#define CPU_FEAT_RVV      (1u << 12)  // RISC-V vector extension
+
+#define CPU_FEAT_SIMD (CPU_FEAT_NEON | CPU_FEAT_SSE2 | CPU_FEAT_ALTIVEC | \
+                       CPU_FEAT_MSA | CPU_FEAT_RVV)
+
+// Detected once, then cached
+unsigned cpu_features(void);
+
+// Non-zero if every feature in mask is present
+int cpu_has(unsigned mask);
+
+// Where the answer came from: "hwcap", "cpuinfo", "cpuid" or "compile-time"
+const char *cpu_features_source(void);
+
+// Space-separated feature names, e.g. "fp neon aes crc32"
+void cpu_features_format(char *buf, size_t len);
+
+#endif
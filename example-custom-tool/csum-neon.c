@@ -0,0 +1,53 @@
+// Built with NEON enabled for this file only (see Makefile), so the rest of
+// the binary still runs on cores without it. Only reached through csum()
+// after cpu_has(CPU_FEAT_NEON).
+#include "csum.h"
+
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+
+static uint16_t csum_neon_impl(const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    uint64x2_t acc64 = vdupq_n_u64(0);
+    uint64_t sum;
+    uint16_t tail;
+
+    while (len >= 32) {
+        // Each pass adds at most 2 * 0xffff per 32-bit lane, so widen to 64
+        // bits before 32768 passes can overflow them
+        size_t blocks = len / 32 > 16384 ? 16384 : len / 32;
+        uint32x4_t acc32 = vdupq_n_u32(0);
+
+        len -= blocks * 32;
+        while (blocks--) {
+            acc32 = vpadalq_u16(acc32, vreinterpretq_u16_u8(vld1q_u8(p)));
+            acc32 = vpadalq_u16(acc32, vreinterpretq_u16_u8(vld1q_u8(p + 16)));
+            p += 32;
+        }
+        acc64 = vpadalq_u32(acc64, acc32);
+    }
+
+    sum = vgetq_lane_u64(acc64, 0) + vgetq_lane_u64(acc64, 1);
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+
+    // The u8 -> u16 reinterpret pairs bytes little-endian; on big-endian
+    // cores that yields the byte-swapped sum (RFC 1071 byte order
+    // independence), so swap it back to match csum_scalar()
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        sum = ((sum & 0xff) << 8) | (sum >> 8);
+    #endif
+
+    tail = csum_scalar(p, len);
+    sum += tail;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)sum;
+}
+
+uint16_t (*const csum_neon)(const void *, size_t) = csum_neon_impl;
+#else
+uint16_t (*const csum_neon)(const void *, size_t) = NULL;
+#endif
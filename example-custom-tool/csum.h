@@ -0,0 +1,23 @@
+#ifndef CSUM_H
+#define CSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Internet checksum (RFC 1071) over native-endian 16-bit words: the
+// ones'-complement sum folded to 16 bits, not yet inverted. Used as the
+// runtime-dispatch example: csum() picks the NEON kernel when the CPU has
+// NEON and the toolchain could build it, scalar otherwise.
+
+uint16_t csum_scalar(const void *buf, size_t len);
+
+// NULL when this build has no NEON kernel (non-ARM, soft-float ABI)
+extern uint16_t (*const csum_neon)(const void *buf, size_t len);
+
+uint16_t csum(const void *buf, size_t len);
+
+// Checksum a buffer with each available kernel, check they agree and print
+// throughput and the speedup; returns non-zero on mismatch
+int csum_demo(size_t megabytes);
+
+#endif
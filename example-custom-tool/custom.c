@@ -1,15 +1,27 @@
 #include "custom-shared.h"
+#include "cpu-features.h"
+#include "csum.h"
 
 void print_build_info() {
     print_build_info_common("Build Information", "Static Binary");
 }
 
+void print_cpu_features() {
+    char features[256];
+
+    cpu_features_format(features, sizeof(features));
+    printf("CPU features (%s): %s\n", cpu_features_source(),
+           features[0] ? features : "none detected");
+}
+
 void print_usage(const char *prog_name) {
     printf("\nUsage: %s [options]\n", prog_name);
     printf("\nOptions:\n");
     printf("  -h, --help     Show this help message\n");
     printf("  -a, --ascii    Show ASCII art\n");
     printf("  -i, --info     Show build information\n");
+    printf("  -c, --cpu      Show CPU features detected at runtime\n");
+    printf("  -k, --checksum Benchmark the scalar and NEON checksum kernels\n");
     printf("\nThis is a demonstration tool showing how to integrate\n");
     printf("custom C programs into the Sthenos Embedded Toolkit.\n");
     printf("\n");
@@ -18,6 +30,8 @@ void print_usage(const char *prog_name) {
 int main(int argc, char *argv[]) {    
     int show_ascii = 0;
     int show_info = 0;
+    int show_cpu = 0;
+    int run_checksum = 0;
     
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
@@ -28,6 +42,10 @@ int main(int argc, char *argv[]) {
                 show_ascii = 1;
             } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--info") == 0) {
                 show_info = 1;
+            } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cpu") == 0) {
+                show_cpu = 1;
+            } else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--checksum") == 0) {
+                run_checksum = 1;
             } else {
                 fprintf(stderr, "Unknown option: %s\n", argv[i]);
                 print_usage(argv[0]);
@@ -48,6 +66,17 @@ int main(int argc, char *argv[]) {
         printf("\n");
     }
     
+    if (show_cpu) {
+        print_cpu_features();
+        printf("\n");
+    }
+    
+    if (run_checksum) {
+        if (csum_demo(64) != 0)
+            return 1;
+        printf("\n");
+    }
+    
     if (show_ascii || show_info) {
         printf("Hello from the Sthenos Custom Tool!\n");
         printf("This binary was statically compiled for embedded systems.\n");
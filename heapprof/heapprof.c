@@ -0,0 +1,990 @@
+/*
+ * libheapprof - LD_PRELOAD heap profiler for processes whose RSS keeps
+ * growing on devices where valgrind or heaptrack can't run.
+ *
+ * Interposes malloc, calloc, realloc, free, the memalign family, mmap and
+ * munmap, and keeps:
+ *   - call counts and bytes per operation, and a power-of-two size
+ *     histogram, in per-thread slots (one writer each, no locks or atomics
+ *     on the fast path);
+ *   - sampled call sites: roughly one allocation per HEAPPROF_SAMPLE bytes
+ *     records its caller in a fixed site table, and the sampled pointer in
+ *     a fixed live table so its free is attributed too. Both tables are
+ *     lock-free (CAS on insert) and never grow.
+ *
+ * Memory use is fixed at load time (all tables are in .bss). A summary is
+ * written at exit and whenever HEAPPROF_SIGNAL arrives; the dump only uses
+ * async-signal-safe calls. Sizes are malloc_usable_size() so allocated and
+ * freed bytes balance.
+ *
+ * Environment:
+ *   HEAPPROF_OUT      output file, "%p" is replaced by the PID (stderr)
+ *   HEAPPROF_SIGNAL   signal number that triggers a dump, 0 for none
+ *                     (SIGUSR2; only installed if the process has no handler)
+ *   HEAPPROF_SAMPLE   average bytes between sampled allocations, 0 turns
+ *                     call-site sampling off (524288)
+ *   HEAPPROF_TOP      call sites listed per dump (20)
+ *   HEAPPROF_AT_EXIT  0 skips the dump at exit (1)
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HP_EXPORT __attribute__((visibility("default")))
+#define HP_TLS __thread __attribute__((tls_model("initial-exec")))
+
+#define HP_CACHE_LINE 64
+#define HP_MAX_THREADS 64
+#define HP_BUCKETS 32
+#define HP_MAX_SITES 1024
+#define HP_LIVE_SLOTS 8192
+#define HP_FILTER_SLOTS 16384
+#define HP_PROBE 16
+#define HP_MAX_TOP 64
+#define HP_TOMBSTONE ((uintptr_t)1)
+
+enum {
+    OP_MALLOC,
+    OP_CALLOC,
+    OP_REALLOC,
+    OP_MEMALIGN,
+    OP_FREE,
+    OP_MMAP,
+    OP_MUNMAP,
+    OP_COUNT
+};
+
+static const char *const op_names[OP_COUNT] = {
+    "malloc", "calloc", "realloc", "memalign", "free", "mmap", "munmap"
+};
+
+/* Per-thread counters. Owned slots have a single writer; the shared
+ * overflow slot (threads beyond HP_MAX_THREADS, exiting threads) is
+ * updated under a spinlock. Slots are cache-line aligned so neighbouring
+ * threads don't write to the same line. */
+struct __attribute__((aligned(HP_CACHE_LINE))) hp_thread {
+    int in_use;
+    uint64_t calls[OP_COUNT];
+    uint64_t alloc_bytes;
+    uint64_t freed_bytes;
+    uint64_t mmap_bytes;
+    uint64_t munmap_bytes;
+    uint64_t hist[HP_BUCKETS];
+};
+
+/* Counters below are word-sized so 32-bit targets update them without
+ * libatomic */
+struct hp_site {
+    uintptr_t addr;
+    unsigned long samples;
+    unsigned long bytes;
+    unsigned long live_samples;
+    unsigned long live_bytes;
+    unsigned long live_weight;
+};
+
+struct hp_live {
+    uintptr_t ptr;
+    unsigned long size;
+    unsigned long weight;
+    unsigned int site;
+};
+
+static struct hp_thread threads[HP_MAX_THREADS];
+static struct hp_thread overflow;
+static int overflow_lock;
+static struct hp_site sites[HP_MAX_SITES];
+static struct hp_live live[HP_LIVE_SLOTS];
+/* Live samples per hash of their pointer, so most frees skip the live
+ * table after one load instead of probing past its tombstones */
+static unsigned int live_filter[HP_FILTER_SLOTS];
+
+static unsigned long live_count;
+static unsigned long sites_dropped;
+static unsigned long live_dropped;
+static unsigned long threads_seen;
+static int dumping;
+
+static HP_TLS struct hp_thread *my_slot;
+static HP_TLS int in_hook;
+static HP_TLS long sample_countdown;
+
+static pthread_key_t slot_key;
+static int slot_key_ok;
+
+static struct {
+    char out[256];
+    int signal;
+    long sample;
+    int top;
+    int at_exit;
+    struct timespec start;
+} cfg = { "", SIGUSR2, 524288, 20, 1, { 0, 0 } };
+
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+static int (*real_posix_memalign)(void **, size_t, size_t);
+static void *(*real_aligned_alloc)(size_t, size_t);
+static void *(*real_memalign)(size_t, size_t);
+static size_t (*real_usable_size)(void *);
+static void *(*real_mmap)(void *, size_t, int, int, int, off_t);
+static int (*real_munmap)(void *, size_t);
+
+/* dlsym may allocate (glibc's dlerror state) before the real allocator is
+ * known; those requests come from this arena and are never freed */
+static char boot_arena[8192] __attribute__((aligned(16)));
+static size_t boot_used;
+static int resolving;
+
+static void *boot_alloc(size_t size)
+{
+    size_t need = (size + 15) & ~(size_t)15;
+    size_t off = __atomic_fetch_add(&boot_used, need, __ATOMIC_RELAXED);
+
+    if (off + need > sizeof(boot_arena))
+        return NULL;
+    return boot_arena + off;
+}
+
+static int is_boot_ptr(const void *p)
+{
+    return (const char *)p >= boot_arena && (const char *)p < boot_arena + sizeof(boot_arena);
+}
+
+static void resolve_real(void)
+{
+    if (real_malloc)
+        return;
+
+    resolving = 1;
+    real_calloc = dlsym(RTLD_NEXT, "calloc");
+    real_realloc = dlsym(RTLD_NEXT, "realloc");
+    real_free = dlsym(RTLD_NEXT, "free");
+    real_posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
+    real_aligned_alloc = dlsym(RTLD_NEXT, "aligned_alloc");
+    real_memalign = dlsym(RTLD_NEXT, "memalign");
+    real_usable_size = dlsym(RTLD_NEXT, "malloc_usable_size");
+    real_mmap = dlsym(RTLD_NEXT, "mmap");
+    real_munmap = dlsym(RTLD_NEXT, "munmap");
+    __atomic_store_n(&real_malloc, (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc"), __ATOMIC_RELEASE);
+    resolving = 0;
+}
+
+/* ---- per-thread slots ---- */
+
+static void slot_release(void *slot)
+{
+    __atomic_store_n(&((struct hp_thread *)slot)->in_use, 0, __ATOMIC_RELEASE);
+    my_slot = &overflow;
+}
+
+static struct hp_thread *slot_get(void)
+{
+    struct hp_thread *slot = my_slot;
+    int i;
+
+    if (slot)
+        return slot;
+
+    slot = &overflow;
+    for (i = 0; i < HP_MAX_THREADS; i++) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&threads[i].in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            slot = &threads[i];
+            break;
+        }
+    }
+    my_slot = slot;
+    __atomic_fetch_add(&threads_seen, 1, __ATOMIC_RELAXED);
+
+    /* Give the slot back when the thread exits (may allocate; in_hook is
+     * set, so that goes straight to the real allocator) */
+    if (slot != &overflow && slot_key_ok)
+        pthread_setspecific(slot_key, slot);
+    return slot;
+}
+
+/* Smallest b with size <= 2^b, capped at the last bucket */
+static unsigned int size_bucket(size_t size)
+{
+    unsigned int b;
+
+    if (size <= 1)
+        return 0;
+    b = (unsigned int)(sizeof(unsigned long) * 8) - (unsigned int)__builtin_clzl((unsigned long)(size - 1));
+    return b < HP_BUCKETS ? b : HP_BUCKETS - 1;
+}
+
+static void record(struct hp_thread *slot, int op, size_t alloc, size_t freed, size_t requested)
+{
+    int shared = slot == &overflow;
+
+    if (shared)
+        while (__sync_lock_test_and_set(&overflow_lock, 1))
+            ;
+    slot->calls[op]++;
+    slot->alloc_bytes += alloc;
+    slot->freed_bytes += freed;
+    if (alloc)
+        slot->hist[size_bucket(requested)]++;
+    if (shared)
+        __sync_lock_release(&overflow_lock);
+}
+
+static void record_map(struct hp_thread *slot, int op, size_t len)
+{
+    int shared = slot == &overflow;
+
+    if (shared)
+        while (__sync_lock_test_and_set(&overflow_lock, 1))
+            ;
+    slot->calls[op]++;
+    if (op == OP_MMAP)
+        slot->mmap_bytes += len;
+    else
+        slot->munmap_bytes += len;
+    if (shared)
+        __sync_lock_release(&overflow_lock);
+}
+
+/* ---- sampled call sites ---- */
+
+static size_t hash_ptr(uintptr_t p)
+{
+    p ^= p >> 17;
+    p *= (uintptr_t)0x9E3779B1u;
+    p ^= p >> 13;
+    return (size_t)p;
+}
+
+static int site_index(uintptr_t addr)
+{
+    size_t h = hash_ptr(addr) & (HP_MAX_SITES - 1);
+    int i;
+
+    for (i = 0; i < HP_PROBE; i++) {
+        struct hp_site *s = &sites[(h + i) & (HP_MAX_SITES - 1)];
+        uintptr_t cur = __atomic_load_n(&s->addr, __ATOMIC_ACQUIRE);
+        if (cur == addr)
+            return (int)((h + i) & (HP_MAX_SITES - 1));
+        if (cur == 0) {
+            uintptr_t expected = 0;
+            if (__atomic_compare_exchange_n(&s->addr, &expected, addr, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+                || expected == addr)
+                return (int)((h + i) & (HP_MAX_SITES - 1));
+        }
+    }
+    __atomic_fetch_add(&sites_dropped, 1, __ATOMIC_RELAXED);
+    return -1;
+}
+
+/* Byte-based sampling: a thread samples once its countdown runs out, so
+ * big allocations are sampled more often and each sample stands for about
+ * cfg.sample bytes */
+static void maybe_sample(void *ptr, size_t size, uintptr_t caller)
+{
+    unsigned long weight;
+    struct hp_site *s;
+    size_t h;
+    int idx, i;
+
+    if (cfg.sample <= 0 || !ptr)
+        return;
+    sample_countdown -= (long)size;
+    if (sample_countdown > 0)
+        return;
+    sample_countdown += cfg.sample;
+    if (sample_countdown <= 0)
+        sample_countdown = cfg.sample;
+
+    idx = site_index(caller);
+    if (idx < 0)
+        return;
+    s = &sites[idx];
+    weight = size > (size_t)cfg.sample ? size : (unsigned long)cfg.sample;
+    __atomic_fetch_add(&s->samples, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->bytes, size, __ATOMIC_RELAXED);
+
+    h = hash_ptr((uintptr_t)ptr) & (HP_LIVE_SLOTS - 1);
+    for (i = 0; i < HP_PROBE; i++) {
+        struct hp_live *l = &live[(h + i) & (HP_LIVE_SLOTS - 1)];
+        uintptr_t cur = __atomic_load_n(&l->ptr, __ATOMIC_RELAXED);
+        if ((cur == 0 || cur == HP_TOMBSTONE)
+            && __atomic_compare_exchange_n(&l->ptr, &cur, HP_TOMBSTONE, 0,
+                                           __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            l->size = size;
+            l->weight = weight;
+            l->site = (unsigned int)idx;
+            __atomic_fetch_add(&live_filter[hash_ptr((uintptr_t)ptr) & (HP_FILTER_SLOTS - 1)], 1,
+                               __ATOMIC_RELAXED);
+            __atomic_store_n(&l->ptr, (uintptr_t)ptr, __ATOMIC_RELEASE);
+            __atomic_fetch_add(&live_count, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&s->live_samples, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&s->live_bytes, size, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&s->live_weight, weight, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    __atomic_fetch_add(&live_dropped, 1, __ATOMIC_RELAXED);
+}
+
+/* Called before the real free, so the address can't be handed out again
+ * while its entry is still in the table */
+static void forget_sample(void *ptr)
+{
+    size_t h = hash_ptr((uintptr_t)ptr);
+    int i;
+
+    if (!ptr || __atomic_load_n(&live_filter[h & (HP_FILTER_SLOTS - 1)], __ATOMIC_RELAXED) == 0)
+        return;
+
+    h &= HP_LIVE_SLOTS - 1;
+    for (i = 0; i < HP_PROBE; i++) {
+        struct hp_live *l = &live[(h + i) & (HP_LIVE_SLOTS - 1)];
+        uintptr_t cur = __atomic_load_n(&l->ptr, __ATOMIC_ACQUIRE);
+        if (cur == 0)
+            return;
+        if (cur == (uintptr_t)ptr) {
+            struct hp_site *s = &sites[l->site];
+            __atomic_fetch_sub(&s->live_samples, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_sub(&s->live_bytes, l->size, __ATOMIC_RELAXED);
+            __atomic_fetch_sub(&s->live_weight, l->weight, __ATOMIC_RELAXED);
+            __atomic_fetch_sub(&live_count, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&l->ptr, HP_TOMBSTONE, __ATOMIC_RELEASE);
+            __atomic_fetch_sub(&live_filter[hash_ptr((uintptr_t)ptr) & (HP_FILTER_SLOTS - 1)], 1,
+                               __ATOMIC_RELAXED);
+            return;
+        }
+    }
+}
+
+static size_t usable(void *ptr)
+{
+    return ptr && real_usable_size ? real_usable_size(ptr) : 0;
+}
+
+/* ---- interposed functions ---- */
+
+#define CALLER ((uintptr_t)__builtin_return_address(0))
+
+/* Callers set in_hook around the real call as well: musl's calloc and
+ * memalign go through the interposed malloc and aligned_alloc */
+static void after_alloc(int op, void *ptr, size_t requested, uintptr_t caller)
+{
+    if (!ptr)
+        return;
+    record(slot_get(), op, usable(ptr), 0, requested);
+    maybe_sample(ptr, requested, caller);
+}
+
+HP_EXPORT void *malloc(size_t size)
+{
+    void *ptr;
+
+    if (!real_malloc) {
+        if (resolving)
+            return boot_alloc(size);
+        resolve_real();
+    }
+    if (in_hook)
+        return real_malloc(size);
+
+    in_hook = 1;
+    ptr = real_malloc(size);
+    after_alloc(OP_MALLOC, ptr, size, CALLER);
+    in_hook = 0;
+    return ptr;
+}
+
+HP_EXPORT void *calloc(size_t n, size_t size)
+{
+    void *ptr;
+
+    if (!real_malloc) {
+        if (resolving) {
+            /* The arena is zeroed .bss and never reused */
+            if (size && n > (size_t)-1 / size)
+                return NULL;
+            return boot_alloc(n * size);
+        }
+        resolve_real();
+    }
+    if (in_hook)
+        return real_calloc(n, size);
+
+    in_hook = 1;
+    ptr = real_calloc(n, size);
+    after_alloc(OP_CALLOC, ptr, n * size, CALLER);
+    in_hook = 0;
+    return ptr;
+}
+
+HP_EXPORT void *realloc(void *old, size_t size)
+{
+    struct hp_thread *slot;
+    size_t old_size;
+    void *ptr;
+
+    if (!real_malloc) {
+        if (resolving)
+            return boot_alloc(size);
+        resolve_real();
+    }
+    if (is_boot_ptr(old)) {
+        size_t avail = (size_t)(boot_arena + sizeof(boot_arena) - (char *)old);
+        ptr = malloc(size);
+        if (ptr)
+            memcpy(ptr, old, size < avail ? size : avail);
+        return ptr;
+    }
+    if (in_hook)
+        return real_realloc(old, size);
+
+    in_hook = 1;
+    old_size = usable(old);
+    forget_sample(old);
+    ptr = real_realloc(old, size);
+    if (ptr || size == 0) {
+        slot = slot_get();
+        record(slot, OP_REALLOC, usable(ptr), old_size, size);
+        if (ptr)
+            maybe_sample(ptr, size, CALLER);
+    }
+    in_hook = 0;
+    return ptr;
+}
+
+HP_EXPORT void free(void *ptr)
+{
+    if (!ptr || is_boot_ptr(ptr))
+        return;
+    if (!real_free)
+        resolve_real();
+    if (in_hook) {
+        real_free(ptr);
+        return;
+    }
+
+    in_hook = 1;
+    record(slot_get(), OP_FREE, 0, usable(ptr), 0);
+    forget_sample(ptr);
+    real_free(ptr);
+    in_hook = 0;
+}
+
+HP_EXPORT int posix_memalign(void **out, size_t align, size_t size)
+{
+    int rc;
+
+    if (!real_malloc)
+        resolve_real();
+    if (in_hook)
+        return real_posix_memalign(out, align, size);
+
+    in_hook = 1;
+    rc = real_posix_memalign(out, align, size);
+    if (rc == 0)
+        after_alloc(OP_MEMALIGN, *out, size, CALLER);
+    in_hook = 0;
+    return rc;
+}
+
+HP_EXPORT void *aligned_alloc(size_t align, size_t size)
+{
+    void *ptr;
+
+    if (!real_malloc)
+        resolve_real();
+    if (in_hook || !real_aligned_alloc)
+        return real_aligned_alloc ? real_aligned_alloc(align, size) : NULL;
+
+    in_hook = 1;
+    ptr = real_aligned_alloc(align, size);
+    after_alloc(OP_MEMALIGN, ptr, size, CALLER);
+    in_hook = 0;
+    return ptr;
+}
+
+HP_EXPORT void *memalign(size_t align, size_t size)
+{
+    void *ptr;
+
+    if (!real_malloc)
+        resolve_real();
+    if (in_hook || !real_memalign)
+        return real_memalign ? real_memalign(align, size) : NULL;
+
+    in_hook = 1;
+    ptr = real_memalign(align, size);
+    after_alloc(OP_MEMALIGN, ptr, size, CALLER);
+    in_hook = 0;
+    return ptr;
+}
+
+HP_EXPORT void *mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off)
+{
+    void *ptr;
+
+    if (!real_mmap)
+        resolve_real();
+    ptr = real_mmap(addr, len, prot, flags, fd, off);
+    if (ptr != MAP_FAILED && !in_hook) {
+        in_hook = 1;
+        record_map(slot_get(), OP_MMAP, len);
+        in_hook = 0;
+    }
+    return ptr;
+}
+
+#if defined(__GLIBC__) && !defined(__LP64__)
+/* 32-bit glibc programs built with _FILE_OFFSET_BITS=64 call mmap64 */
+HP_EXPORT void *mmap64(void *addr, size_t len, int prot, int flags, int fd, off64_t off)
+{
+    static void *(*real_mmap64)(void *, size_t, int, int, int, off64_t);
+    void *ptr;
+
+    if (!real_mmap64)
+        real_mmap64 = dlsym(RTLD_NEXT, "mmap64");
+    ptr = real_mmap64(addr, len, prot, flags, fd, off);
+    if (ptr != MAP_FAILED && !in_hook) {
+        in_hook = 1;
+        record_map(slot_get(), OP_MMAP, len);
+        in_hook = 0;
+    }
+    return ptr;
+}
+#endif
+
+HP_EXPORT int munmap(void *addr, size_t len)
+{
+    int rc;
+
+    if (!real_munmap)
+        resolve_real();
+    rc = real_munmap(addr, len);
+    if (rc == 0 && !in_hook) {
+        in_hook = 1;
+        record_map(slot_get(), OP_MUNMAP, len);
+        in_hook = 0;
+    }
+    return rc;
+}
+
+/* ---- summary (async-signal-safe: no stdio, no allocation) ---- */
+
+struct out {
+    int fd;
+    size_t len;
+    char buf[1024];
+};
+
+static void out_flush(struct out *o)
+{
+    size_t done = 0;
+
+    while (done < o->len) {
+        ssize_t n = write(o->fd, o->buf + done, o->len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += (size_t)n;
+    }
+    o->len = 0;
+}
+
+static void out_str(struct out *o, const char *s)
+{
+    while (*s) {
+        if (o->len == sizeof(o->buf))
+            out_flush(o);
+        o->buf[o->len++] = *s++;
+    }
+}
+
+static void out_u64(struct out *o, uint64_t v)
+{
+    char tmp[24];
+    int i = sizeof(tmp) - 1;
+
+    tmp[i] = '\0';
+    do {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out_str(o, tmp + i);
+}
+
+static void out_i64(struct out *o, int64_t v)
+{
+    if (v < 0) {
+        out_str(o, "-");
+        out_u64(o, (uint64_t)(-(v + 1)) + 1);
+    } else {
+        out_u64(o, (uint64_t)v);
+    }
+}
+
+static void out_hex(struct out *o, uintptr_t v)
+{
+    char tmp[2 + 2 * sizeof(uintptr_t) + 1];
+    int i = sizeof(tmp) - 1;
+
+    tmp[i] = '\0';
+    do {
+        tmp[--i] = "0123456789abcdef"[v & 15];
+        v >>= 4;
+    } while (v);
+    tmp[--i] = 'x';
+    tmp[--i] = '0';
+    out_str(o, tmp + i);
+}
+
+static void out_kv(struct out *o, const char *key, uint64_t v)
+{
+    out_str(o, " ");
+    out_str(o, key);
+    out_str(o, "=");
+    out_u64(o, v);
+}
+
+static uint64_t read_rss_kb(void)
+{
+    char buf[128];
+    uint64_t pages = 0;
+    ssize_t n;
+    int fd, i = 0;
+
+    fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+    n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0)
+        return 0;
+    buf[n] = '\0';
+
+    while (buf[i] && buf[i] != ' ')
+        i++;
+    for (i++; buf[i] >= '0' && buf[i] <= '9'; i++)
+        pages = pages * 10 + (uint64_t)(buf[i] - '0');
+    return pages * (uint64_t)sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/* Print a code address as <module>+0x<offset> from /proc/self/maps, so it
+ * can be resolved on the build host with addr2line */
+struct site_loc {
+    uintptr_t addr;
+    uintptr_t offset;
+    char module[128];
+};
+
+static void parse_hex(const char **p, uintptr_t *v)
+{
+    *v = 0;
+    for (;; (*p)++) {
+        char c = **p;
+        if (c >= '0' && c <= '9')
+            *v = (*v << 4) | (uintptr_t)(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            *v = (*v << 4) | (uintptr_t)(c - 'a' + 10);
+        else
+            break;
+    }
+}
+
+static void locate_line(const char *line, struct site_loc *locs, int n)
+{
+    uintptr_t start, end, off;
+    const char *p = line, *path;
+    int i, field;
+
+    parse_hex(&p, &start);
+    if (*p++ != '-')
+        return;
+    parse_hex(&p, &end);
+    if (*p++ != ' ' || p[2] != 'x')
+        return;
+    p += 5;
+    parse_hex(&p, &off);
+
+    path = p;
+    for (field = 0; field < 2 && *path; field++) {
+        while (*path == ' ')
+            path++;
+        while (*path && *path != ' ')
+            path++;
+    }
+    while (*path == ' ')
+        path++;
+
+    for (i = 0; i < n; i++) {
+        if (locs[i].module[0] || locs[i].addr < start || locs[i].addr >= end)
+            continue;
+        locs[i].offset = locs[i].addr - start + off;
+        if (*path) {
+            size_t len = strlen(path);
+            if (len >= sizeof(locs[i].module))
+                path += len - (sizeof(locs[i].module) - 1);
+            memcpy(locs[i].module, path, strlen(path) + 1);
+        } else {
+            memcpy(locs[i].module, "[anon]", 7);
+        }
+    }
+}
+
+static void locate_sites(struct site_loc *locs, int n)
+{
+    char chunk[512], line[512];
+    size_t line_len = 0;
+    ssize_t got;
+    int fd;
+
+    fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0) {
+        ssize_t i;
+        for (i = 0; i < got; i++) {
+            if (chunk[i] == '\n') {
+                line[line_len] = '\0';
+                locate_line(line, locs, n);
+                line_len = 0;
+            } else if (line_len < sizeof(line) - 1) {
+                line[line_len++] = chunk[i];
+            }
+        }
+    }
+    close(fd);
+}
+
+static int open_output(void)
+{
+    char path[sizeof(cfg.out) + 16];
+    size_t i, j = 0;
+
+    if (!cfg.out[0])
+        return STDERR_FILENO;
+
+    for (i = 0; cfg.out[i] && j < sizeof(path) - 24; i++) {
+        if (cfg.out[i] == '%' && cfg.out[i + 1] == 'p') {
+            char tmp[16];
+            int k = sizeof(tmp);
+            unsigned long pid = (unsigned long)getpid();
+            do {
+                tmp[--k] = (char)('0' + pid % 10);
+                pid /= 10;
+            } while (pid);
+            while (k < (int)sizeof(tmp))
+                path[j++] = tmp[k++];
+            i++;
+        } else {
+            path[j++] = cfg.out[i];
+        }
+    }
+    path[j] = '\0';
+
+    return open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+/* Order for the site listing: estimated live bytes, then sampled bytes */
+static int site_before(const struct hp_site *a, const struct hp_site *b)
+{
+    if (a->live_weight != b->live_weight)
+        return a->live_weight > b->live_weight;
+    return a->bytes > b->bytes;
+}
+
+static void dump(const char *reason)
+{
+    struct hp_thread total;
+    struct site_loc locs[HP_MAX_TOP];
+    int idx[HP_MAX_TOP];
+    struct timespec now;
+    struct out o;
+    int i, b, n_top = 0, saved_errno = errno;
+
+    if (__atomic_exchange_n(&dumping, 1, __ATOMIC_ACQUIRE))
+        return;
+    in_hook++;
+
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i <= HP_MAX_THREADS; i++) {
+        const struct hp_thread *t = i < HP_MAX_THREADS ? &threads[i] : &overflow;
+        int op;
+        for (op = 0; op < OP_COUNT; op++)
+            total.calls[op] += t->calls[op];
+        total.alloc_bytes += t->alloc_bytes;
+        total.freed_bytes += t->freed_bytes;
+        total.mmap_bytes += t->mmap_bytes;
+        total.munmap_bytes += t->munmap_bytes;
+        for (b = 0; b < HP_BUCKETS; b++)
+            total.hist[b] += t->hist[b];
+    }
+
+    for (i = 0; i < HP_MAX_SITES && cfg.top > 0; i++) {
+        int pos;
+        if (!sites[i].addr || !sites[i].samples)
+            continue;
+        for (pos = n_top; pos > 0 && site_before(&sites[i], &sites[idx[pos - 1]]); pos--)
+            ;
+        if (pos >= cfg.top)
+            continue;
+        if (n_top < cfg.top)
+            n_top++;
+        memmove(&idx[pos + 1], &idx[pos], (size_t)(n_top - 1 - pos) * sizeof(idx[0]));
+        idx[pos] = i;
+    }
+    for (i = 0; i < n_top; i++) {
+        locs[i].addr = sites[idx[i]].addr;
+        locs[i].module[0] = '\0';
+    }
+    locate_sites(locs, n_top);
+
+    o.fd = open_output();
+    o.len = 0;
+    if (o.fd < 0)
+        goto out;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    out_str(&o, "# heapprof");
+    out_kv(&o, "pid", (uint64_t)getpid());
+    out_str(&o, " reason=");
+    out_str(&o, reason);
+    out_kv(&o, "uptime_s", (uint64_t)(now.tv_sec - cfg.start.tv_sec));
+    out_kv(&o, "rss_kb", read_rss_kb());
+
+    out_str(&o, "\ncalls");
+    for (i = 0; i < OP_COUNT; i++)
+        out_kv(&o, op_names[i], total.calls[i]);
+
+    out_kv(&o, "\nbytes allocated", total.alloc_bytes);
+    out_kv(&o, "freed", total.freed_bytes);
+    out_str(&o, " live=");
+    out_i64(&o, (int64_t)(total.alloc_bytes - total.freed_bytes));
+    out_kv(&o, "mmap", total.mmap_bytes);
+    out_kv(&o, "munmap", total.munmap_bytes);
+
+    out_str(&o, "\nhist");
+    for (b = 0; b < HP_BUCKETS; b++) {
+        if (!total.hist[b])
+            continue;
+        out_str(&o, " ");
+        out_u64(&o, (uint64_t)1 << b);
+        out_str(&o, ":");
+        out_u64(&o, total.hist[b]);
+    }
+    out_str(&o, "\n");
+
+    for (i = 0; i < n_top; i++) {
+        const struct hp_site *s = &sites[idx[i]];
+        out_kv(&o, "site live_est", s->live_weight);
+        out_kv(&o, "live_samples", s->live_samples);
+        out_kv(&o, "live_bytes", s->live_bytes);
+        out_kv(&o, "samples", s->samples);
+        out_kv(&o, "bytes", s->bytes);
+        out_str(&o, " at=");
+        if (locs[i].module[0]) {
+            out_str(&o, locs[i].module);
+            out_str(&o, "+");
+            out_hex(&o, locs[i].offset);
+        } else {
+            out_hex(&o, locs[i].addr);
+        }
+        out_str(&o, "\n");
+    }
+
+    out_str(&o, "meta");
+    out_kv(&o, "threads", threads_seen);
+    out_kv(&o, "overflow_calls", overflow.calls[OP_MALLOC] + overflow.calls[OP_FREE]);
+    out_kv(&o, "sample_bytes", (uint64_t)(cfg.sample > 0 ? cfg.sample : 0));
+    out_kv(&o, "live_samples", live_count);
+    out_kv(&o, "sites_dropped", sites_dropped);
+    out_kv(&o, "live_dropped", live_dropped);
+    out_str(&o, "\n");
+    out_flush(&o);
+    if (o.fd != STDERR_FILENO)
+        close(o.fd);
+
+out:
+    in_hook--;
+    __atomic_store_n(&dumping, 0, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    dump("signal");
+}
+
+static long env_long(const char *name, long def)
+{
+    const char *v = getenv(name);
+    char *end;
+    long n;
+
+    if (!v || !*v)
+        return def;
+    n = strtol(v, &end, 10);
+    return *end ? def : n;
+}
+
+__attribute__((constructor))
+static void heapprof_init(void)
+{
+    const char *out = getenv("HEAPPROF_OUT");
+
+    resolve_real();
+    clock_gettime(CLOCK_MONOTONIC, &cfg.start);
+
+    if (out) {
+        strncpy(cfg.out, out, sizeof(cfg.out) - 1);
+        cfg.out[sizeof(cfg.out) - 1] = '\0';
+    }
+    cfg.signal = (int)env_long("HEAPPROF_SIGNAL", SIGUSR2);
+    cfg.sample = env_long("HEAPPROF_SAMPLE", 524288);
+    cfg.top = (int)env_long("HEAPPROF_TOP", 20);
+    if (cfg.top > HP_MAX_TOP)
+        cfg.top = HP_MAX_TOP;
+    cfg.at_exit = (int)env_long("HEAPPROF_AT_EXIT", 1);
+    sample_countdown = cfg.sample;
+
+    if (pthread_key_create(&slot_key, slot_release) == 0)
+        slot_key_ok = 1;
+
+    if (cfg.signal > 0) {
+        struct sigaction old, sa;
+        if (sigaction(cfg.signal, NULL, &old) == 0 && old.sa_handler == SIG_DFL) {
+            memset(&sa, 0, sizeof(sa));
+            sa.sa_handler = on_signal;
+            sa.sa_flags = SA_RESTART;
+            sigemptyset(&sa.sa_mask);
+            sigaction(cfg.signal, &sa, NULL);
+        }
+    }
+}
+
+__attribute__((destructor))
+static void heapprof_fini(void)
+{
+    if (cfg.at_exit)
+        dump("exit");
+}
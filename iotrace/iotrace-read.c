@@ -0,0 +1,490 @@
+/*
+ * iotrace-read - drain the ring libiotrace writes (iotrace.h) and print
+ * per-fd latency summaries and histograms while the process runs
+ *
+ *   iotrace-read [-i sec] [-n reports] [-t rows] [-a] [-c] [-H] [-r] [-u] <pid|ring>
+ *
+ * The ring is mapped read-only, so the traced process never waits on the
+ * reader. Records overwritten before they were read are counted as lost;
+ * a larger IOTRACE_SLOTS, a shorter -i or IOTRACE_SAMPLE fix that. Exits
+ * after the report that follows the traced process's exit, and with -u
+ * removes the ring file then.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iotrace.h"
+
+#define MAX_ROWS        512
+#define BUCKETS         42      /* bucket b: [2^b, 2^(b+1)) ns, up to ~73 min */
+#define POLL_NS         10000000ull
+#define STALL_POLLS     50      /* in-flight slot given up after ~0.5 s */
+
+struct row {
+    int used;
+    int fd;                     /* -2: rows beyond MAX_ROWS */
+    int op;
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t hist[BUCKETS];
+};
+
+static struct row rows[MAX_ROWS];
+static struct row other = { 1, -2, 0, 0, 0, 0, 0, 0, { 0 } };
+
+static const struct iotrace_hdr *hdr;
+static const struct iotrace_rec *recs;
+static uint32_t tail;
+static uint64_t records, lost;
+static uint64_t latest_ns;      /* end of the newest record, process time */
+static unsigned int stall;
+
+static double interval = 1.0;
+static long max_reports;
+static int top_rows = 20;
+static int from_oldest, cumulative, no_hist, raw, unlink_ring;
+static volatile sig_atomic_t stop;
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "Usage: iotrace-read [options] <pid|ring>\n"
+        "  -i SEC   report interval (1; 0 drains once and reports)\n"
+        "  -n N     stop after N reports (0: until the process exits)\n"
+        "  -t N     rows per report, most total time first (20)\n"
+        "  -a       start at the oldest record in the ring instead of now\n"
+        "  -c       cumulative, don't reset between reports\n"
+        "  -H       no histograms\n"
+        "  -r       print every record instead of summaries\n"
+        "  -u       remove the ring file once the process has exited\n"
+        "A pid reads /dev/shm/iotrace.<pid> (or /tmp/iotrace.<pid>).\n"
+        "Post-mortem summary of a ring: iotrace-read -a -i 0 <ring>\n");
+    exit(2);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull) };
+
+    nanosleep(&ts, NULL);
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+/* ---- formatting ---- */
+
+static const char *fmt_ns(char *buf, size_t size, uint64_t ns)
+{
+    if (ns < 1000)
+        snprintf(buf, size, "%lluns", (unsigned long long)ns);
+    else if (ns < 1000000)
+        snprintf(buf, size, ns < 100000 ? "%.1fus" : "%.0fus", ns / 1e3);
+    else if (ns < 1000000000)
+        snprintf(buf, size, ns < 100000000 ? "%.1fms" : "%.0fms", ns / 1e6);
+    else
+        snprintf(buf, size, "%.2fs", ns / 1e9);
+    return buf;
+}
+
+static const char *fmt_bytes(char *buf, size_t size, uint64_t b)
+{
+    if (b < 10000)
+        snprintf(buf, size, "%llu", (unsigned long long)b);
+    else if (b < 10000ull << 10)
+        snprintf(buf, size, "%.1fK", b / 1024.0);
+    else if (b < 10000ull << 20)
+        snprintf(buf, size, "%.1fM", b / 1048576.0);
+    else
+        snprintf(buf, size, "%.1fG", b / 1073741824.0);
+    return buf;
+}
+
+/* ---- accounting ---- */
+
+static unsigned int bucket(uint64_t ns)
+{
+    unsigned int b = 0;
+
+    while (ns > 1 && b < BUCKETS - 1) {
+        ns >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static struct row *row_for(int fd, int op)
+{
+    unsigned int h = ((unsigned int)fd * 31u + (unsigned int)op) % MAX_ROWS;
+    unsigned int i;
+
+    for (i = 0; i < MAX_ROWS; i++) {
+        struct row *r = &rows[(h + i) % MAX_ROWS];
+        if (!r->used) {
+            r->used = 1;
+            r->fd = fd;
+            r->op = op;
+            return r;
+        }
+        if (r->fd == fd && r->op == op)
+            return r;
+    }
+    return &other;
+}
+
+static void account(const struct iotrace_rec *rec)
+{
+    uint64_t ns = iotrace_decode_dur(rec->dur);
+    struct row *r;
+
+    records++;
+    if (rec->start_ns + ns > latest_ns)
+        latest_ns = rec->start_ns + ns;
+    if (raw) {
+        char d[16];
+        printf("%12.6f tid=%u fd=%d %s %s bytes=%u err=%u\n",
+               rec->start_ns / 1e9, rec->tid, rec->fd,
+               rec->op < IOT_OP_COUNT ? iotrace_op_names[rec->op] : "?",
+               fmt_ns(d, sizeof(d), ns), rec->bytes, rec->err);
+        return;
+    }
+
+    r = row_for(rec->fd, rec->op < IOT_OP_COUNT ? rec->op : 0);
+    r->calls++;
+    r->bytes += rec->bytes;
+    r->errors += rec->err != 0;
+    r->total_ns += ns;
+    if (ns > r->max_ns)
+        r->max_ns = ns;
+    r->hist[bucket(ns)]++;
+}
+
+/* Read every committed record up to head. Returns 0 when a slot is still
+ * being written and the reader should come back later. */
+static int drain(void)
+{
+    uint32_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    uint32_t slots = hdr->slots;
+
+    if (head - tail > slots) {
+        lost += head - tail - slots;
+        tail = head - slots;
+    }
+
+    while (tail != head) {
+        const struct iotrace_rec *slot = &recs[tail & (slots - 1)];
+        uint32_t want = iotrace_seq(tail);
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        struct iotrace_rec copy;
+
+        if (seq != want) {
+            if (seq != 0 && (int32_t)(seq - want) > 0) {
+                /* Overwritten by a writer a lap ahead */
+                lost++;
+                tail++;
+                continue;
+            }
+            if (++stall < STALL_POLLS)
+                return 0;
+            /* The writer died mid-record */
+            lost++;
+            tail++;
+            stall = 0;
+            continue;
+        }
+        stall = 0;
+
+        memcpy(&copy, slot, sizeof(copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != want) {
+            lost++;
+            tail++;
+            continue;
+        }
+        account(&copy);
+        tail++;
+    }
+    return 1;
+}
+
+/* ---- reporting ---- */
+
+static void fd_target(int fd, char *buf, size_t size)
+{
+    char path[64];
+    ssize_t n;
+
+    buf[0] = '\0';
+    if (fd < 0)
+        return;
+    snprintf(path, sizeof(path), "/proc/%d/fd/%d", (int)hdr->pid, fd);
+    n = readlink(path, buf, size - 1);
+    buf[n > 0 ? n : 0] = '\0';
+}
+
+static uint64_t percentile(const struct row *r, double p)
+{
+    uint64_t want = (uint64_t)(r->calls * p + 0.999999);
+    uint64_t seen = 0;
+    unsigned int b;
+
+    for (b = 0; b < BUCKETS; b++) {
+        seen += r->hist[b];
+        if (seen >= want && seen > 0) {
+            uint64_t upper = 2ull << b;
+            return upper < r->max_ns ? upper : r->max_ns;
+        }
+    }
+    return r->max_ns;
+}
+
+static void print_hist(const struct row *r)
+{
+    char buf[16];
+    unsigned int b;
+    int col = 8;
+
+    printf("        ");
+    for (b = 0; b < BUCKETS; b++) {
+        if (!r->hist[b])
+            continue;
+        if (col > 100) {
+            printf("\n        ");
+            col = 8;
+        }
+        col += printf(" <%s:%llu", fmt_ns(buf, sizeof(buf), 2ull << b),
+                      (unsigned long long)r->hist[b]);
+    }
+    printf("\n");
+}
+
+static int busier(const struct row *a, const struct row *b)
+{
+    if (a->total_ns != b->total_ns)
+        return a->total_ns > b->total_ns;
+    return a->calls > b->calls;
+}
+
+/* period_ns is the reader's time covered by the report, 0 for one drain */
+static void report(uint64_t period_ns)
+{
+    static int order[MAX_ROWS + 1];
+    int n = 0, i, j;
+    char at[16], per[16], a[16], p50[16], p90[16], p99[16], mx[16], by[16];
+    char target[PATH_MAX];
+
+    for (i = 0; i < MAX_ROWS; i++) {
+        if (rows[i].used && rows[i].calls)
+            order[n++] = i;
+    }
+    if (other.calls)
+        order[n++] = MAX_ROWS;
+    /* Insertion sort; n is small and this runs once per interval */
+    for (i = 1; i < n; i++) {
+        int v = order[i];
+        const struct row *rv = v == MAX_ROWS ? &other : &rows[v];
+        for (j = i - 1; j >= 0; j--) {
+            const struct row *rj = order[j] == MAX_ROWS ? &other : &rows[order[j]];
+            if (!busier(rv, rj))
+                break;
+            order[j + 1] = order[j];
+        }
+        order[j + 1] = v;
+    }
+
+    printf("# iotrace pid=%d comm=%s t=%s%s%s records=%llu lost=%llu sample=%u min_us=%u fds=%s\n",
+           (int)hdr->pid, hdr->comm[0] ? hdr->comm : "?",
+           fmt_ns(at, sizeof(at), latest_ns), period_ns ? " period=" : "",
+           period_ns ? fmt_ns(per, sizeof(per), period_ns) : "",
+           (unsigned long long)records, (unsigned long long)lost,
+           hdr->sample, hdr->min_ns / 1000, hdr->filter[0] ? hdr->filter : "all");
+    if (n == 0) {
+        printf("  (no calls)\n");
+        fflush(stdout);
+        return;
+    }
+    printf("  %5s %-11s %9s %7s %5s %8s %8s %8s %8s %8s  %s\n",
+           "fd", "op", "calls", "bytes", "err", "avg", "p50", "p90", "p99", "max", "target");
+
+    for (i = 0; i < n && i < top_rows; i++) {
+        const struct row *r = order[i] == MAX_ROWS ? &other : &rows[order[i]];
+        char fd[12];
+
+        if (r->fd == -2)
+            snprintf(fd, sizeof(fd), "other");
+        else
+            snprintf(fd, sizeof(fd), "%d", r->fd);
+        fd_target(r->fd, target, sizeof(target));
+        printf("  %5s %-11s %9llu %7s %5llu %8s %8s %8s %8s %8s  %s\n",
+               fd, r->fd == -2 ? "*" : iotrace_op_names[r->op],
+               (unsigned long long)r->calls, fmt_bytes(by, sizeof(by), r->bytes),
+               (unsigned long long)r->errors,
+               fmt_ns(a, sizeof(a), r->total_ns / r->calls),
+               fmt_ns(p50, sizeof(p50), percentile(r, 0.50)),
+               fmt_ns(p90, sizeof(p90), percentile(r, 0.90)),
+               fmt_ns(p99, sizeof(p99), percentile(r, 0.99)),
+               fmt_ns(mx, sizeof(mx), r->max_ns), target);
+        if (!no_hist)
+            print_hist(r);
+    }
+    if (n > top_rows)
+        printf("  ... %d more\n", n - top_rows);
+    fflush(stdout);
+}
+
+static void reset(void)
+{
+    memset(rows, 0, sizeof(rows));
+    memset(&other, 0, sizeof(other));
+    other.used = 1;
+    other.fd = -2;
+    records = 0;
+    lost = 0;
+}
+
+/* ---- setup ---- */
+
+static int map_ring(const char *path)
+{
+    struct stat st;
+    size_t need;
+    void *p;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct iotrace_hdr)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    hdr = p;
+    need = (size_t)hdr->hdr_size + (size_t)hdr->slots * hdr->rec_size;
+    if (memcmp(hdr->magic, IOTRACE_MAGIC, sizeof(hdr->magic)) != 0
+        || hdr->version != IOTRACE_VERSION
+        || hdr->rec_size != sizeof(struct iotrace_rec)
+        || hdr->hdr_size != sizeof(struct iotrace_hdr)
+        || hdr->slots == 0 || (hdr->slots & (hdr->slots - 1)) != 0
+        || need > (size_t)st.st_size) {
+        fprintf(stderr, "iotrace-read: %s is not an iotrace ring (or from another version/arch)\n", path);
+        exit(1);
+    }
+    recs = (const struct iotrace_rec *)((const char *)p + hdr->hdr_size);
+    return 0;
+}
+
+static int writer_gone(void)
+{
+    if (__atomic_load_n(&hdr->state, __ATOMIC_ACQUIRE) == IOT_STATE_EXITED)
+        return 1;
+    return kill((pid_t)hdr->pid, 0) < 0 && errno == ESRCH;
+}
+
+int main(int argc, char **argv)
+{
+    const char *target;
+    char path[PATH_MAX];
+    uint64_t start, period, now;
+    long reports = 0;
+    int opt, gone = 0;
+
+    while ((opt = getopt(argc, argv, "i:n:t:acHruh")) != -1) {
+        switch (opt) {
+        case 'i': interval = atof(optarg); break;
+        case 'n': max_reports = atol(optarg); break;
+        case 't': top_rows = atoi(optarg); break;
+        case 'a': from_oldest = 1; break;
+        case 'c': cumulative = 1; break;
+        case 'H': no_hist = 1; break;
+        case 'r': raw = 1; break;
+        case 'u': unlink_ring = 1; break;
+        default: usage();
+        }
+    }
+    if (optind != argc - 1 || interval < 0)
+        usage();
+    target = argv[optind];
+
+    if (strspn(target, "0123456789") == strlen(target)) {
+        snprintf(path, sizeof(path), "/dev/shm/iotrace.%s", target);
+        if (access(path, R_OK) != 0)
+            snprintf(path, sizeof(path), "/tmp/iotrace.%s", target);
+    } else {
+        snprintf(path, sizeof(path), "%s", target);
+    }
+    if (map_ring(path) < 0) {
+        fprintf(stderr, "iotrace-read: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_DFL);
+
+    tail = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    if (from_oldest)
+        tail = tail > hdr->slots ? tail - hdr->slots : 0;
+
+    start = period = now_ns();
+    for (;;) {
+        uint64_t deadline = period + (uint64_t)(interval * 1e9);
+
+        for (;;) {
+            drain();
+            gone = writer_gone();
+            if (gone || stop || now_ns() >= deadline)
+                break;
+            sleep_ns(POLL_NS);
+        }
+        /* Whatever the process wrote before it exited */
+        if (gone)
+            while (!drain())
+                sleep_ns(POLL_NS);
+
+        now = now_ns();
+        if (!raw)
+            report(interval == 0 ? 0 : now - (cumulative ? start : period));
+        if (!cumulative)
+            reset();
+        period = now;
+        if (gone || stop || interval == 0 || (max_reports && ++reports >= max_reports))
+            break;
+    }
+    if (raw)
+        fflush(stdout);
+    if (gone && unlink_ring && unlink(path) < 0 && errno != ENOENT) {
+        fprintf(stderr, "iotrace-read: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,515 @@
+/*
+ * libiotrace - LD_PRELOAD I/O latency tracer for processes that can't be
+ * put under strace or ltrace in production and have no eBPF.
+ *
+ * Interposes read, write, readv, writev, send, recv, sendto, recvfrom,
+ * sendmsg, recvmsg, poll, epoll_wait, epoll_pwait, fsync and fdatasync.
+ * A traced call is timed with CLOCK_MONOTONIC and one 32-byte record is
+ * pushed into a memory-mapped ring (iotrace.h) that iotrace-read drains
+ * from another process. Pushing is one atomic increment plus the stores
+ * into the record: no locks, no system calls, no allocation. Memory use is
+ * the ring alone.
+ *
+ * Environment:
+ *   IOTRACE_RING    ring file, "%p" is replaced by the PID
+ *                   (/dev/shm/iotrace.%p, /tmp/iotrace.%p without /dev/shm)
+ *   IOTRACE_SLOTS   records in the ring, rounded up to a power of two
+ *                   (65536, 2 MB)
+ *   IOTRACE_SAMPLE  trace one call in N per thread (1)
+ *   IOTRACE_MIN_US  drop calls faster than this (0)
+ *   IOTRACE_FDS     fds to trace, e.g. "0-2,5,9-" (all)
+ *   IOTRACE_OPS     calls to trace, e.g. "read,write,fsync" (all)
+ *   IOTRACE_UNLINK  1: remove the ring file when the process exits (0)
+ *
+ * Each process gets its own ring: a forked child opens a new one when
+ * IOTRACE_RING contains %p, and an exec'd program loads the library again
+ * if LD_PRELOAD is still set. Ring files are left behind for post-mortem
+ * reading (iotrace-read -a) unless IOTRACE_UNLINK is set; a reader that
+ * already has the ring open still gets the final records. A process that
+ * is killed or leaves through _exit() never runs the destructor, so its
+ * ring stays either way; iotrace-read -u removes a ring once its process
+ * is gone.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iotrace.h"
+
+#define IOT_EXPORT __attribute__((visibility("default")))
+#define IOT_TLS __thread __attribute__((tls_model("initial-exec")))
+
+#define IOT_FD_BITS 4096
+#define IOT_MAX_SLOTS (1u << 24)
+
+static struct {
+    char ring[256];
+    uint32_t slots;
+    uint32_t sample;
+    uint32_t min_ns;
+    uint32_t ops;               /* bit per enum iotrace_op */
+    int fd_filter;              /* 0: every fd */
+    int fd_open_from;           /* with a filter, fds >= this pass; -1 for none */
+    char fds[64];
+    int unlink_at_exit;
+} cfg = { "", 65536, 1, 0, (1u << IOT_OP_COUNT) - 1, 0, -1, "", 0 };
+
+static unsigned char fd_bits[IOT_FD_BITS / 8];
+
+static struct iotrace_hdr *hdr;
+static struct iotrace_rec *recs;
+static uint32_t mask;
+static size_t map_size;
+static char ring_file[sizeof(cfg.ring) + 16];
+static uint64_t base_ns;
+
+static IOT_TLS int in_hook;
+static IOT_TLS uint32_t sample_countdown;
+static IOT_TLS uint32_t my_tid;
+
+static ssize_t (*real_read)(int, void *, size_t);
+static ssize_t (*real_write)(int, const void *, size_t);
+static ssize_t (*real_readv)(int, const struct iovec *, int);
+static ssize_t (*real_writev)(int, const struct iovec *, int);
+static ssize_t (*real_send)(int, const void *, size_t, int);
+static ssize_t (*real_recv)(int, void *, size_t, int);
+static ssize_t (*real_sendto)(int, const void *, size_t, int, const struct sockaddr *, socklen_t);
+static ssize_t (*real_recvfrom)(int, void *, size_t, int, struct sockaddr *, socklen_t *);
+static ssize_t (*real_sendmsg)(int, const struct msghdr *, int);
+static ssize_t (*real_recvmsg)(int, struct msghdr *, int);
+static int (*real_poll)(struct pollfd *, nfds_t, int);
+static int (*real_epoll_wait)(int, struct epoll_event *, int, int);
+static int (*real_epoll_pwait)(int, struct epoll_event *, int, int, const sigset_t *);
+static int (*real_fsync)(int);
+static int (*real_fdatasync)(int);
+
+static void resolve_real(void)
+{
+    real_write = dlsym(RTLD_NEXT, "write");
+    real_readv = dlsym(RTLD_NEXT, "readv");
+    real_writev = dlsym(RTLD_NEXT, "writev");
+    real_send = dlsym(RTLD_NEXT, "send");
+    real_recv = dlsym(RTLD_NEXT, "recv");
+    real_sendto = dlsym(RTLD_NEXT, "sendto");
+    real_recvfrom = dlsym(RTLD_NEXT, "recvfrom");
+    real_sendmsg = dlsym(RTLD_NEXT, "sendmsg");
+    real_recvmsg = dlsym(RTLD_NEXT, "recvmsg");
+    real_poll = dlsym(RTLD_NEXT, "poll");
+    real_epoll_wait = dlsym(RTLD_NEXT, "epoll_wait");
+    real_epoll_pwait = dlsym(RTLD_NEXT, "epoll_pwait");
+    real_fsync = dlsym(RTLD_NEXT, "fsync");
+    real_fdatasync = dlsym(RTLD_NEXT, "fdatasync");
+    __atomic_store_n(&real_read, (ssize_t (*)(int, void *, size_t))dlsym(RTLD_NEXT, "read"),
+                     __ATOMIC_RELEASE);
+}
+
+#define RESOLVE(fn) do { if (!real_##fn) resolve_real(); } while (0)
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- recording ---- */
+
+static int fd_wanted(int fd)
+{
+    if (!cfg.fd_filter)
+        return 1;
+    if (fd < 0)
+        return 0;
+    if (cfg.fd_open_from >= 0 && fd >= cfg.fd_open_from)
+        return 1;
+    return fd < IOT_FD_BITS && (fd_bits[fd >> 3] & (1u << (fd & 7)));
+}
+
+/* Whether this call is traced: the ring is up, the op and fd pass the
+ * filters and the thread's sampling countdown ran out */
+static int begin(int op, int fd)
+{
+    if (!hdr || in_hook || !(cfg.ops & (1u << op)) || !fd_wanted(fd))
+        return 0;
+    if (cfg.sample > 1) {
+        if (sample_countdown > 1) {
+            sample_countdown--;
+            return 0;
+        }
+        sample_countdown = cfg.sample;
+    }
+    in_hook = 1;
+    return 1;
+}
+
+static void end(int op, int fd, uint64_t start, long ret, int err)
+{
+    uint64_t stop = now_ns();
+    uint64_t dur = stop - start;
+    struct iotrace_rec *r;
+    uint32_t idx;
+
+    in_hook = 0;
+    if (dur < cfg.min_ns || !hdr)
+        return;
+    if (!my_tid)
+        my_tid = (uint32_t)syscall(SYS_gettid);
+
+    idx = __atomic_fetch_add(&hdr->head, 1, __ATOMIC_RELAXED);
+    r = &recs[idx & mask];
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    r->op = (uint8_t)op;
+    r->err = ret < 0 ? (uint8_t)(err < 255 ? err : 255) : 0;
+    r->reserved = 0;
+    r->fd = fd;
+    r->tid = my_tid;
+    r->start_ns = start - base_ns;
+    r->dur = iotrace_encode_dur(dur);
+    r->bytes = ret <= 0 ? 0 : (unsigned long)ret > 0xffffffffu ? 0xffffffffu : (uint32_t)ret;
+    __atomic_store_n(&r->seq, iotrace_seq(idx), __ATOMIC_RELEASE);
+}
+
+/* TRACE(op, fd, type, call) - return call, recording it when begin() says so;
+ * errno is kept as the real call left it */
+#define TRACE(op, fd, type, call)                       \
+    do {                                                \
+        type ret_;                                      \
+        uint64_t start_;                                \
+        int err_;                                       \
+        if (!begin(op, fd))                             \
+            return call;                                \
+        start_ = now_ns();                              \
+        ret_ = call;                                    \
+        err_ = errno;                                   \
+        end(op, fd, start_, (long)ret_, err_);          \
+        errno = err_;                                   \
+        return ret_;                                    \
+    } while (0)
+
+/* ---- interposed functions ---- */
+
+IOT_EXPORT ssize_t read(int fd, void *buf, size_t count)
+{
+    RESOLVE(read);
+    TRACE(IOT_READ, fd, ssize_t, real_read(fd, buf, count));
+}
+
+IOT_EXPORT ssize_t write(int fd, const void *buf, size_t count)
+{
+    RESOLVE(write);
+    TRACE(IOT_WRITE, fd, ssize_t, real_write(fd, buf, count));
+}
+
+IOT_EXPORT ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    RESOLVE(readv);
+    TRACE(IOT_READV, fd, ssize_t, real_readv(fd, iov, iovcnt));
+}
+
+IOT_EXPORT ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    RESOLVE(writev);
+    TRACE(IOT_WRITEV, fd, ssize_t, real_writev(fd, iov, iovcnt));
+}
+
+IOT_EXPORT ssize_t send(int fd, const void *buf, size_t len, int flags)
+{
+    RESOLVE(send);
+    TRACE(IOT_SEND, fd, ssize_t, real_send(fd, buf, len, flags));
+}
+
+IOT_EXPORT ssize_t recv(int fd, void *buf, size_t len, int flags)
+{
+    RESOLVE(recv);
+    TRACE(IOT_RECV, fd, ssize_t, real_recv(fd, buf, len, flags));
+}
+
+IOT_EXPORT ssize_t sendto(int fd, const void *buf, size_t len, int flags,
+                          const struct sockaddr *addr, socklen_t addrlen)
+{
+    RESOLVE(sendto);
+    TRACE(IOT_SENDTO, fd, ssize_t, real_sendto(fd, buf, len, flags, addr, addrlen));
+}
+
+IOT_EXPORT ssize_t recvfrom(int fd, void *buf, size_t len, int flags,
+                            struct sockaddr *addr, socklen_t *addrlen)
+{
+    RESOLVE(recvfrom);
+    TRACE(IOT_RECVFROM, fd, ssize_t, real_recvfrom(fd, buf, len, flags, addr, addrlen));
+}
+
+IOT_EXPORT ssize_t sendmsg(int fd, const struct msghdr *msg, int flags)
+{
+    RESOLVE(sendmsg);
+    TRACE(IOT_SENDMSG, fd, ssize_t, real_sendmsg(fd, msg, flags));
+}
+
+IOT_EXPORT ssize_t recvmsg(int fd, struct msghdr *msg, int flags)
+{
+    RESOLVE(recvmsg);
+    TRACE(IOT_RECVMSG, fd, ssize_t, real_recvmsg(fd, msg, flags));
+}
+
+/* A poll over one fd is attributed to it, a wider one to fd -1 */
+IOT_EXPORT int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    RESOLVE(poll);
+    TRACE(IOT_POLL, nfds == 1 ? fds[0].fd : -1, int, real_poll(fds, nfds, timeout));
+}
+
+IOT_EXPORT int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    RESOLVE(epoll_wait);
+    TRACE(IOT_EPOLL_WAIT, epfd, int, real_epoll_wait(epfd, events, maxevents, timeout));
+}
+
+IOT_EXPORT int epoll_pwait(int epfd, struct epoll_event *events, int maxevents, int timeout,
+                           const sigset_t *sigmask)
+{
+    RESOLVE(epoll_pwait);
+    TRACE(IOT_EPOLL_PWAIT, epfd, int, real_epoll_pwait(epfd, events, maxevents, timeout, sigmask));
+}
+
+IOT_EXPORT int fsync(int fd)
+{
+    RESOLVE(fsync);
+    TRACE(IOT_FSYNC, fd, int, real_fsync(fd));
+}
+
+IOT_EXPORT int fdatasync(int fd)
+{
+    RESOLVE(fdatasync);
+    TRACE(IOT_FDATASYNC, fd, int, real_fdatasync(fd));
+}
+
+/* ---- configuration and ring setup ---- */
+
+static long env_long(const char *name, long def)
+{
+    const char *v = getenv(name);
+    char *end;
+    long n;
+
+    if (!v || !*v)
+        return def;
+    n = strtol(v, &end, 0);
+    return *end ? def : n;
+}
+
+/* "0-2,5,9-": single fds, ranges and one open-ended range */
+static void parse_fds(const char *spec)
+{
+    const char *p = spec;
+
+    while (*p) {
+        char *end;
+        long lo = strtol(p, &end, 10), hi = lo, fd;
+
+        if (end == p || lo < 0)
+            break;
+        p = end;
+        if (*p == '-') {
+            p++;
+            if (*p == ',' || !*p) {
+                if (cfg.fd_open_from < 0 || lo < cfg.fd_open_from)
+                    cfg.fd_open_from = (int)lo;
+                hi = lo - 1;
+            } else {
+                hi = strtol(p, &end, 10);
+                p = end;
+            }
+        }
+        for (fd = lo; fd <= hi && fd < IOT_FD_BITS; fd++)
+            fd_bits[fd >> 3] |= (unsigned char)(1u << (fd & 7));
+        cfg.fd_filter = 1;
+        if (*p == ',')
+            p++;
+        else if (*p)
+            break;
+    }
+}
+
+static void parse_ops(const char *spec)
+{
+    const char *p = spec;
+    uint32_t ops = 0;
+
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        int i;
+
+        for (i = 0; i < IOT_OP_COUNT; i++) {
+            if (strlen(iotrace_op_names[i]) == len && !strncmp(p, iotrace_op_names[i], len))
+                ops |= 1u << i;
+        }
+        p += len;
+        if (*p)
+            p++;
+    }
+    if (ops)
+        cfg.ops = ops;
+}
+
+static void read_config(void)
+{
+    const char *ring = getenv("IOTRACE_RING");
+    const char *fds = getenv("IOTRACE_FDS");
+    const char *ops = getenv("IOTRACE_OPS");
+    long slots = env_long("IOTRACE_SLOTS", 65536);
+    long sample = env_long("IOTRACE_SAMPLE", 1);
+    long min_us = env_long("IOTRACE_MIN_US", 0);
+
+    if (ring && *ring)
+        strncpy(cfg.ring, ring, sizeof(cfg.ring) - 1);
+
+    cfg.slots = 64;
+    while (cfg.slots < (uint32_t)slots && cfg.slots < IOT_MAX_SLOTS)
+        cfg.slots <<= 1;
+    cfg.sample = sample > 1 ? (uint32_t)sample : 1;
+    cfg.min_ns = min_us > 0 && min_us < 4000000 ? (uint32_t)min_us * 1000 : 0;
+    cfg.unlink_at_exit = env_long("IOTRACE_UNLINK", 0) != 0;
+
+    if (fds && *fds) {
+        strncpy(cfg.fds, fds, sizeof(cfg.fds) - 1);
+        parse_fds(fds);
+    }
+    if (ops && *ops)
+        parse_ops(ops);
+}
+
+/* Expand %p in a ring path template */
+static void ring_path(const char *tmpl, char *path, size_t size)
+{
+    size_t i, j = 0;
+
+    for (i = 0; tmpl[i] && j < size - 12; i++) {
+        if (tmpl[i] == '%' && tmpl[i + 1] == 'p') {
+            char tmp[12];
+            int k = sizeof(tmp);
+            unsigned long pid = (unsigned long)getpid();
+            do {
+                tmp[--k] = (char)('0' + pid % 10);
+                pid /= 10;
+            } while (pid);
+            while (k < (int)sizeof(tmp))
+                path[j++] = tmp[k++];
+            i++;
+        } else {
+            path[j++] = tmpl[i];
+        }
+    }
+    path[j] = '\0';
+}
+
+static int ring_create(const char *tmpl)
+{
+    char path[sizeof(ring_file)];
+    size_t size = sizeof(struct iotrace_hdr) + (size_t)cfg.slots * sizeof(struct iotrace_rec);
+    struct iotrace_hdr *h;
+    int fd;
+
+    ring_path(tmpl, path, sizeof(path));
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return -1;
+    if (ftruncate(fd, (off_t)size) < 0) {
+        close(fd);
+        return -1;
+    }
+    h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (h == MAP_FAILED)
+        return -1;
+
+    base_ns = now_ns();
+    h->version = IOTRACE_VERSION;
+    h->hdr_size = sizeof(struct iotrace_hdr);
+    h->rec_size = sizeof(struct iotrace_rec);
+    h->slots = cfg.slots;
+    h->pid = (int32_t)getpid();
+    h->start_ns = base_ns;
+    h->sample = cfg.sample;
+    h->min_ns = cfg.min_ns;
+    memcpy(h->filter, cfg.fds, sizeof(h->filter));
+
+    fd = open("/proc/self/comm", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ssize_t n = real_read(fd, h->comm, sizeof(h->comm) - 1);
+        close(fd);
+        while (n > 0 && (h->comm[n - 1] == '\n' || h->comm[n - 1] == '\0'))
+            h->comm[--n] = '\0';
+    }
+
+    h->state = IOT_STATE_RUNNING;
+    /* The reader checks the magic last */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(h->magic, IOTRACE_MAGIC, sizeof(h->magic));
+
+    recs = (struct iotrace_rec *)((char *)h + sizeof(struct iotrace_hdr));
+    mask = cfg.slots - 1;
+    map_size = size;
+    memcpy(ring_file, path, sizeof(ring_file));
+    __atomic_store_n(&hdr, h, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void ring_open(void)
+{
+    if (cfg.ring[0]) {
+        ring_create(cfg.ring);
+    } else if (ring_create(IOTRACE_DEFAULT_RING) < 0) {
+        ring_create(IOTRACE_FALLBACK_RING);
+    }
+}
+
+/* The child shares the parent's mapping; give it a ring of its own when the
+ * path is per process, else stop tracing in it */
+static void after_fork_child(void)
+{
+    struct iotrace_hdr *old = hdr;
+
+    hdr = NULL;
+    my_tid = 0;
+    if (!old)
+        return;
+    munmap(old, map_size);
+    if (strstr(cfg.ring[0] ? cfg.ring : IOTRACE_DEFAULT_RING, "%p"))
+        ring_open();
+}
+
+__attribute__((constructor))
+static void iotrace_init(void)
+{
+    resolve_real();
+    read_config();
+    ring_open();
+    pthread_atfork(NULL, NULL, after_fork_child);
+}
+
+__attribute__((destructor))
+static void iotrace_fini(void)
+{
+    if (!hdr)
+        return;
+    __atomic_store_n(&hdr->state, IOT_STATE_EXITED, __ATOMIC_RELEASE);
+    if (cfg.unlink_at_exit)
+        unlink(ring_file);
+}
@@ -0,0 +1,112 @@
+/*
+ * Ring layout shared by libiotrace (the writer, LD_PRELOADed into the
+ * traced process) and iotrace-read (the reader).
+ *
+ * The ring is a file, by default /dev/shm/iotrace.<pid>, mapped shared by
+ * both sides: a header followed by a power-of-two array of fixed-size
+ * records. Writers claim a slot with an atomic increment of head and never
+ * wait; a full ring overwrites its oldest records. Each record carries the
+ * slot's sequence number (iotrace_seq()) once it is complete, so the
+ * reader can tell committed, in-flight and overwritten slots apart without
+ * locks. Only 32-bit atomics are used, so every target works without
+ * libatomic; head and seq wrap after 2^32 records and both sides compare
+ * them modulo 2^32.
+ */
+#ifndef IOTRACE_H
+#define IOTRACE_H
+
+#include <stdint.h>
+
+#define IOTRACE_MAGIC "IOTRACE1"
+#define IOTRACE_VERSION 1
+#define IOTRACE_DEFAULT_RING "/dev/shm/iotrace.%p"
+#define IOTRACE_FALLBACK_RING "/tmp/iotrace.%p"
+
+enum iotrace_op {
+    IOT_READ,
+    IOT_WRITE,
+    IOT_READV,
+    IOT_WRITEV,
+    IOT_SEND,
+    IOT_RECV,
+    IOT_SENDTO,
+    IOT_RECVFROM,
+    IOT_SENDMSG,
+    IOT_RECVMSG,
+    IOT_POLL,
+    IOT_EPOLL_WAIT,
+    IOT_EPOLL_PWAIT,
+    IOT_FSYNC,
+    IOT_FDATASYNC,
+    IOT_OP_COUNT
+};
+
+static const char *const iotrace_op_names[IOT_OP_COUNT] = {
+    "read", "write", "readv", "writev", "send", "recv", "sendto", "recvfrom",
+    "sendmsg", "recvmsg", "poll", "epoll_wait", "epoll_pwait", "fsync", "fdatasync"
+};
+
+enum iotrace_state {
+    IOT_STATE_RUNNING = 1,
+    IOT_STATE_EXITED = 2
+};
+
+/* Durations up to 2^31 ns are stored as is; longer ones set the top bit
+ * and count microseconds (up to ~35 minutes) */
+#define IOTRACE_DUR_US_FLAG 0x80000000u
+
+struct iotrace_hdr {
+    char magic[8];
+    uint32_t version;
+    uint32_t hdr_size;          /* offset of the first record */
+    uint32_t rec_size;
+    uint32_t slots;             /* power of two */
+    int32_t pid;
+    uint32_t state;             /* enum iotrace_state */
+    uint64_t start_ns;          /* CLOCK_MONOTONIC when the ring was made */
+    uint32_t sample;            /* 1 in N calls per thread */
+    uint32_t min_ns;            /* shorter calls are not recorded */
+    char comm[16];
+    char filter[64];            /* IOTRACE_FDS as given, "" for all */
+    uint32_t head;              /* next slot to claim; own cache line */
+    char pad1[60];
+};
+
+struct iotrace_rec {
+    uint32_t seq;               /* iotrace_seq(index) once written, 0 while in flight */
+    uint8_t op;                 /* enum iotrace_op */
+    uint8_t err;                /* errno of a failed call (capped at 255), else 0 */
+    uint16_t reserved;
+    int32_t fd;                 /* -1 for poll over several fds */
+    uint32_t tid;
+    uint64_t start_ns;          /* relative to iotrace_hdr.start_ns */
+    uint32_t dur;               /* see IOTRACE_DUR_US_FLAG */
+    uint32_t bytes;             /* bytes moved, or ready fds/events (capped) */
+};
+
+_Static_assert(sizeof(struct iotrace_hdr) == 192, "iotrace_hdr layout");
+_Static_assert(sizeof(struct iotrace_rec) == 32, "iotrace_rec layout");
+
+/* Sequence number of the record claimed at head index idx: idx + 1, except
+ * that the index before head wraps gets 1 instead of the in-flight 0 */
+static inline uint32_t iotrace_seq(uint32_t idx)
+{
+    return idx + 1 ? idx + 1 : 1;
+}
+
+static inline uint32_t iotrace_encode_dur(uint64_t ns)
+{
+    if (ns < IOTRACE_DUR_US_FLAG)
+        return (uint32_t)ns;
+    ns /= 1000;
+    return IOTRACE_DUR_US_FLAG | (uint32_t)(ns < IOTRACE_DUR_US_FLAG ? ns : IOTRACE_DUR_US_FLAG - 1);
+}
+
+static inline uint64_t iotrace_decode_dur(uint32_t dur)
+{
+    if (dur & IOTRACE_DUR_US_FLAG)
+        return (uint64_t)(dur & ~IOTRACE_DUR_US_FLAG) * 1000;
+    return dur;
+}
+
+#endif
@@ -0,0 +1,198 @@
+#!/bin/bash
+# Transfer time and client CPU of curl-full fetching the same artifact over
+# loopback as identity, gzip and zstd content-encoding (--compressed). The
+# payload is a slice of the host's binaries, close to what firmware and
+# artifact mirrors serve; the server sends pre-compressed copies (gzip -9,
+# zstd -19) the way such mirrors store them. Every download is compared
+# with the original, so a broken decoder fails the run.
+#
+# Runs natively on x86 and under qemu-user otherwise; qemu inflates CPU
+# time, so compare encodings within one arch.
+#
+# Usage: curl-encoding.sh <arch>
+# Results: $BENCH_DIR/curl-encoding.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="curl-encoding"
+ENCODING_MB="${ENCODING_MB:-32}"
+ENCODING_RUNS="${ENCODING_RUNS:-3}"
+ENCODINGS="${ENCODINGS:-identity gzip zstd}"
+
+# make_corpus <dir> - payload plus its gzip and zstd encodings, reused
+# between runs
+make_corpus() {
+    local dir=$1
+    local size=$((ENCODING_MB * 1048576))
+
+    mkdir -p "$dir"
+    if [ "$(stat -c %s "$dir/payload" 2>/dev/null)" != "$size" ]; then
+        find /usr/bin /usr/lib -type f -size +16k 2>/dev/null | sort \
+            | xargs cat 2>/dev/null | head -c "$size" > "$dir/payload"
+        rm -f "$dir/payload.gz" "$dir/payload.zst"
+    fi
+    [ -s "$dir/payload.gz" ] || gzip -9 -c "$dir/payload" > "$dir/payload.gz"
+    if [ ! -s "$dir/payload.zst" ] && command -v zstd >/dev/null; then
+        zstd -19 -T0 -q -c "$dir/payload" > "$dir/payload.zst"
+    fi
+}
+
+# start_encoding_server <dir> <port> - /identity, /gzip and /zstd each
+# serve the matching file with its Content-Encoding; prints the PID
+start_encoding_server() {
+    local dir=$1
+    local port=$2
+
+    python3 - "$dir" "$port" > /dev/null 2>&1 << 'SERVER_EOF' &
+import http.server, os, sys
+
+root, port = sys.argv[1], int(sys.argv[2])
+FILES = {"/identity": ("payload", None), "/gzip": ("payload.gz", "gzip"), "/zstd": ("payload.zst", "zstd")}
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        name, encoding = FILES.get(self.path, (None, None))
+        path = os.path.join(root, name) if name else None
+        if not path or not os.path.exists(path):
+            self.send_error(404)
+            return
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(os.path.getsize(path)))
+        if encoding:
+            self.send_header("Content-Encoding", encoding)
+        self.end_headers()
+        with open(path, "rb") as f:
+            while True:
+                chunk = f.read(1 << 20)
+                if not chunk:
+                    break
+                self.wfile.write(chunk)
+
+    def log_message(self, *args):
+        pass
+
+http.server.ThreadingHTTPServer(("127.0.0.1", port), Handler).serve_forever()
+SERVER_EOF
+    local pid=$!
+
+    if ! bench_wait_port "$port" 10; then
+        bench_stop "$pid"
+        return 1
+    fi
+    echo "$pid"
+}
+
+# timed_fetch <arch> <binary> <url> <out> - prints "<real s> <user s> <sys s>"
+timed_fetch() {
+    local TIMEFORMAT='%R %U %S'
+
+    { time run_target "$1" "$2" -s --fail --compressed -o "$4" "$3" > /dev/null 2>&1; } 2>&1
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    local binary=$(get_output_path "$arch" "curl-full")
+    if [ ! -s "$binary" ]; then
+        log_tool "$BENCH_NAME" "curl-full not built for $arch, building it first..."
+        build_tool curl-full "$arch" >/dev/null 2>&1 || {
+            log_error "Failed to build curl-full for $arch"
+            return 1
+        }
+    fi
+
+    local features=$(run_target "$arch" "$binary" -V 2>/dev/null | sed -n 's/^Features: //p')
+    log_tool "$BENCH_NAME" "curl-full features: $features"
+
+    # Without them the zstd row is missing and the build is the plain one
+    local feature missing_features=""
+    for feature in HTTP2 zstd; do
+        [[ " $features " == *" $feature "* ]] || missing_features="$missing_features $feature"
+    done
+    if [ -n "$missing_features" ]; then
+        log_tool_error "$BENCH_NAME" "curl-full for $arch lacks${missing_features} (NGHTTP2_SHA512/ZSTD_SHA512 pinned?)"
+    fi
+
+    local dir="$BENCH_WORK_DIR/$BENCH_NAME"
+    make_corpus "$dir"
+
+    local port=$(bench_free_port)
+    local server_pid
+    server_pid=$(start_encoding_server "$dir" "$port") || {
+        log_error "Encoding test server failed to start on port $port"
+        return 1
+    }
+
+    bench_init "$BENCH_NAME" arch libc encoding payload_bytes wire_bytes ms cpu_ms decoded_mb_s
+    local payload_bytes=$(stat -c %s "$dir/payload")
+
+    local encoding failed=0
+    for encoding in $ENCODINGS; do
+        local wire_file="$dir/payload"
+        case "$encoding" in
+            gzip) wire_file="$dir/payload.gz" ;;
+            zstd) wire_file="$dir/payload.zst" ;;
+        esac
+
+        if [ "$encoding" = "zstd" ] && [[ " $features " != *" zstd "* ]]; then
+            continue
+        fi
+        if [ ! -s "$wire_file" ]; then
+            log_tool_warn "$BENCH_NAME" "No $encoding copy of the payload (zstd missing on the host?), skipping"
+            continue
+        fi
+
+        local best_ms="" best_cpu="" run
+        for run in $(seq 1 "$ENCODING_RUNS"); do
+            local times
+            if ! times=$(timed_fetch "$arch" "$binary" "http://127.0.0.1:$port/$encoding" "$dir/fetched") \
+                || ! cmp -s "$dir/fetched" "$dir/payload"; then
+                best_ms=""
+                break
+            fi
+            local real user sys
+            read -r real user sys <<< "$times"
+            local ms=$(awk -v r="$real" 'BEGIN { printf "%.0f", r * 1000 }')
+            if [ -z "$best_ms" ] || [ "$ms" -lt "$best_ms" ]; then
+                best_ms=$ms
+                best_cpu=$(awk -v u="$user" -v s="$sys" 'BEGIN { printf "%.0f", (u + s) * 1000 }')
+            fi
+        done
+        rm -f "$dir/fetched"
+
+        if [ -z "$best_ms" ]; then
+            log_tool_error "$BENCH_NAME" "$encoding transfer failed or decoded wrongly on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$encoding" "$payload_bytes" \
+            "$(stat -c %s "$wire_file")" "$best_ms" "$best_cpu" \
+            "$(bench_throughput "$payload_bytes" "$best_ms")"
+    done
+
+    bench_stop "$server_pid"
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    [ -z "$missing_features" ] || failed=$((failed + 1))
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
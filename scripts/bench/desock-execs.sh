@@ -0,0 +1,225 @@
+#!/bin/bash
+# Desocketed executions per second of a small one-shot TCP server under
+# libdesock, per libc and per build variant (DESOCK_FD_TABLE_SIZE /
+# DESOCK_MAX_CONNS, see scripts/shared/tools/build-libdesock.sh), plus the
+# startup cost of loading the library: the server exits straight away with
+# and without the preload and the difference per exec is reported.
+#
+# Each exec goes through the target's dynamic loader (--library-path
+# --preload), natively on x86 and under qemu-user otherwise, the same way a
+# fuzzer forks the target. Absolute numbers include fork/exec and qemu
+# start-up; compare variants within one arch.
+#
+# Usage: desock-execs.sh <arch>
+# Results: $BENCH_DIR/desock-execs.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/shared_lib_helpers.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="desock-execs"
+DESOCK_EXECS="${DESOCK_EXECS:-200}"
+DESOCK_LIBCS="${DESOCK_LIBCS:-musl glibc}"
+# <fd_table>:<max_conns> per variant; the first is the default build
+DESOCK_VARIANTS="${DESOCK_VARIANTS:-128:128 32:4 1024:256}"
+
+write_server_source() {
+    local path=$1
+
+    cat > "$path" << 'SERVER_EOF'
+/* One-shot HTTP-ish server shaped like a typical fuzz target: accept one
+ * client, read a request, answer, exit. Under libdesock the client is
+ * stdin/stdout. "--noop" exits before touching the network. */
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(8080) };
+    static const char reply[] = "HTTP/1.0 200 OK\r\nContent-Length: 2\r\n\r\nok";
+    char req[4096];
+    size_t len = 0;
+    int one = 1, srv, cli;
+
+    if (argc > 1 && strcmp(argv[1], "--noop") == 0)
+        return 0;
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    srv = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv < 0)
+        return 1;
+    setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(srv, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv, 1) < 0)
+        return 1;
+    cli = accept(srv, NULL, NULL);
+    if (cli < 0)
+        return 1;
+
+    while (len < sizeof(req) - 1) {
+        ssize_t n = read(cli, req + len, sizeof(req) - 1 - len);
+        if (n <= 0)
+            break;
+        len += n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n"))
+            break;
+    }
+    if (len < 4 || memcmp(req, "GET ", 4) != 0)
+        return 2;
+
+    write(cli, reply, sizeof(reply) - 1);
+    close(cli);
+    close(srv);
+    return 0;
+}
+SERVER_EOF
+}
+
+# build_server <arch> <libc> <dir> - build the server dynamically against
+# the libc's shared toolchain; prints "<loader> <library dir>"
+build_server() {
+    local arch=$1
+    local libc=$2
+    local dir=$3
+
+    (
+        export LIBC_TYPE=$libc
+        setup_shared_toolchain "$arch" >/dev/null 2>&1 || exit 1
+
+        write_server_source "$dir/server.c"
+        $CC -O2 -o "$dir/server" "$dir/server.c" >&2 || exit 1
+
+        local libdir=$(dirname "$($CC -print-file-name=libc.so)")
+        local interp=$(readelf -l "$dir/server" 2>/dev/null \
+            | sed -n 's/.*program interpreter: \(.*\)]/\1/p')
+        [ -n "$interp" ] || exit 1
+
+        local loader="$libdir/${interp##*/}"
+        if [ ! -e "$loader" ]; then
+            local toolchain_root=$(dirname "$(dirname "$(command -v "$CC")")")
+            loader=$(find "$toolchain_root" -name "${interp##*/}" 2>/dev/null | head -1)
+        fi
+        [ -n "$loader" ] && [ -e "$loader" ] || exit 1
+        echo "$loader $libdir"
+    )
+}
+
+# build_variant <arch> <libc> <fd_table> <max_conns> <dir> - build libdesock
+# into its own output tree; prints the library path
+build_variant() {
+    local arch=$1
+    local libc=$2
+    local dir=$5
+    local out="$dir/lib-$3-$4"
+
+    (
+        export LIBC_TYPE=$libc STATIC_OUTPUT_DIR=$out SKIP_IF_EXISTS=false
+        export DESOCK_FD_TABLE_SIZE=$3 DESOCK_MAX_CONNS=$4
+        bash "${SHARED_LIB_SCRIPTS[libdesock]}" "$arch"
+    ) > "$out.log" 2>&1 || return 1
+
+    local lib="$out/$arch/shared/$libc/libdesock.so"
+    [ -s "$lib" ] || return 1
+    echo "$lib"
+}
+
+# exec_loop <count> <cmd...> - run a command count times with the request
+# on stdin
+exec_loop() {
+    local count=$1
+    shift
+    local i
+
+    for ((i = 0; i < count; i++)); do
+        "$@" < "$BENCH_WORK_DIR/$BENCH_NAME.request" > /dev/null 2>&1 || return 1
+    done
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc fd_table max_conns lib_bytes execs_per_s startup_us
+    printf 'GET / HTTP/1.0\r\nHost: bench\r\n\r\n' > "$BENCH_WORK_DIR/$BENCH_NAME.request"
+
+    local libc failed=0
+    for libc in $DESOCK_LIBCS; do
+        if ! LIBC_TYPE=$libc check_toolchain_availability "$arch"; then
+            log_tool_warn "$BENCH_NAME" "No $libc shared toolchain for $arch, skipping"
+            continue
+        fi
+
+        local dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch/$libc"
+        mkdir -p "$dir"
+
+        local runtime loader libdir
+        if ! runtime=$(build_server "$arch" "$libc" "$dir"); then
+            log_tool_error "$BENCH_NAME" "Could not build the sample server ($libc) for $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        read -r loader libdir <<< "$runtime"
+        local run=(run_target "$arch" "$loader" --library-path "$libdir")
+
+        local plain_ms
+        plain_ms=$(bench_time_ms exec_loop "$DESOCK_EXECS" "${run[@]}" "$dir/server" --noop) || {
+            log_tool_error "$BENCH_NAME" "Sample server ($libc) does not run on $arch"
+            failed=$((failed + 1))
+            continue
+        }
+
+        local variant
+        for variant in $DESOCK_VARIANTS; do
+            local fd_table=${variant%%:*}
+            local max_conns=${variant#*:}
+            log_tool "$BENCH_NAME" "$arch/$libc: libdesock FD_TABLE_SIZE=$fd_table MAX_CONNS=$max_conns..."
+
+            local lib
+            if ! lib=$(build_variant "$arch" "$libc" "$fd_table" "$max_conns" "$dir"); then
+                log_tool_error "$BENCH_NAME" "libdesock $variant ($libc) failed to build for $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+
+            local preload=("${run[@]}" --preload "$lib" "$dir/server")
+            if ! "${preload[@]}" < "$BENCH_WORK_DIR/$BENCH_NAME.request" 2>/dev/null | grep -q "200 OK"; then
+                log_tool_error "$BENCH_NAME" "Server did not answer through libdesock $variant ($libc) on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+
+            local exec_ms noop_ms
+            exec_ms=$(bench_time_ms exec_loop "$DESOCK_EXECS" "${preload[@]}") &&
+                noop_ms=$(bench_time_ms exec_loop "$DESOCK_EXECS" "${preload[@]}" --noop) || {
+                log_tool_error "$BENCH_NAME" "Exec loop failed for libdesock $variant ($libc) on $arch"
+                failed=$((failed + 1))
+                continue
+            }
+
+            local rate=$(awk -v n="$DESOCK_EXECS" -v ms="$exec_ms" \
+                'BEGIN { if (ms <= 0) ms = 1; printf "%.1f", n * 1000 / ms }')
+            local startup=$(awk -v n="$DESOCK_EXECS" -v a="$noop_ms" -v b="$plain_ms" \
+                'BEGIN { printf "%.0f", (a - b) * 1000 / n }')
+            bench_record "$BENCH_NAME" "$arch" "$libc" "$fd_table" "$max_conns" \
+                "$(stat -c %s "$lib")" "$rate" "$startup"
+        done
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
@@ -0,0 +1,225 @@
+#!/bin/bash
+# Cost per hit of gdb tracepoints on a hot function, with the built
+# gdbserver-ipa: a small program calls hit() GDBSERVER_HITS times and
+# times the loop itself, run
+#   untraced   directly, no debugger
+#   trace      under gdbserver with a regular tracepoint (trap per hit)
+#   ftrace     under gdbserver with a fast tracepoint, libinproctrace.so
+#              preloaded into the program (jump into the agent per hit)
+# Both tracepoints collect a global. The run fails if gdb downgrades the
+# fast tracepoint to a regular one or collects fewer frames than hits.
+#
+# Native only (gdbserver cannot ptrace under qemu-user); needs the host gdb.
+#
+# Usage: gdbserver-ftrace.sh <arch>
+# Results: $BENCH_DIR/gdbserver-ftrace.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/shared_lib_helpers.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="gdbserver-ftrace"
+GDBSERVER_HITS="${GDBSERVER_HITS:-20000}"
+
+write_target_source() {
+    cat > "$1" << 'TARGET_EOF'
+/* Hot loop for tracepoint timing: calls hit() n times, writes
+ * "<n> <loop ns>" to the result file, then returns through done(), where
+ * gdb stops to read the trace status. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+volatile unsigned long counter;
+
+__attribute__((noinline)) void hit(unsigned long i)
+{
+    counter += i;
+}
+
+__attribute__((noinline)) void done(void)
+{
+    __asm__ volatile("" ::: "memory");
+}
+
+int main(int argc, char **argv)
+{
+    struct timespec a, b;
+    unsigned long n, i;
+    FILE *f;
+
+    if (argc < 3)
+        return 1;
+    n = strtoul(argv[1], NULL, 10);
+
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (i = 0; i < n; i++)
+        hit(i);
+    clock_gettime(CLOCK_MONOTONIC, &b);
+
+    f = fopen(argv[2], "w");
+    if (!f)
+        return 1;
+    fprintf(f, "%lu %lld\n", n, (long long)(b.tv_sec - a.tv_sec) * 1000000000LL + (b.tv_nsec - a.tv_nsec));
+    fclose(f);
+    done();
+    return 0;
+}
+TARGET_EOF
+}
+
+# build_target <arch> <dir> - build the loop against the same libc as the
+# agent, with the toolchain's loader as interpreter so it runs in place
+build_target() {
+    local arch=$1
+    local dir=$2
+
+    (
+        setup_shared_toolchain "$arch" >/dev/null 2>&1 || exit 1
+
+        write_target_source "$dir/loop.c"
+        $CC -O0 -g -o "$dir/loop.probe" "$dir/loop.c" >&2 || exit 1
+
+        local libdir=$(dirname "$($CC -print-file-name=libc.so)")
+        local interp=$(readelf -l "$dir/loop.probe" 2>/dev/null \
+            | sed -n 's/.*program interpreter: \(.*\)]/\1/p')
+        local loader="$libdir/${interp##*/}"
+        if [ ! -e "$loader" ]; then
+            local toolchain_root=$(dirname "$(dirname "$(command -v "$CC")")")
+            loader=$(find "$toolchain_root" -name "${interp##*/}" 2>/dev/null | head -1)
+        fi
+        [ -n "$loader" ] && [ -e "$loader" ] || exit 1
+
+        $CC -O0 -g -Wl,--dynamic-linker="$loader" -Wl,-rpath,"$libdir" \
+            -o "$dir/loop" "$dir/loop.c" >&2
+    )
+}
+
+# traced_run <gdbserver-dir> <dir> <trace|ftrace> - one run under gdbserver;
+# prints "<loop ns> <frames>"
+traced_run() {
+    local ipa_dir=$1
+    local dir=$2
+    local kind=$3
+    local port=$(bench_free_port)
+
+    rm -f "$dir/result"
+    cat > "$dir/gdb.cmds" << EOF
+set pagination off
+set confirm off
+target remote 127.0.0.1:$port
+break main
+continue
+$kind hit
+actions
+collect counter
+end
+break done
+set trace-buffer-size 67108864
+tstart
+continue
+tstop
+tstatus
+info tracepoints
+kill
+EOF
+
+    LD_PRELOAD="$ipa_dir/libinproctrace.so" "$ipa_dir/gdbserver" --once --no-startup-with-shell \
+        "127.0.0.1:$port" "$dir/loop" "$GDBSERVER_HITS" "$dir/result" > "$dir/gdbserver.log" 2>&1 &
+    local server_pid=$!
+
+    if ! bench_wait_port "$port" 10; then
+        bench_stop "$server_pid"
+        return 1
+    fi
+
+    timeout 300 gdb -batch -nx -x "$dir/gdb.cmds" "$dir/loop" > "$dir/gdb-$kind.log" 2>&1
+    bench_stop "$server_pid"
+    wait "$server_pid" 2>/dev/null
+
+    if grep -q "as regular tracepoint\|does not support fast tracepoints\|IPA" "$dir/gdb-$kind.log"; then
+        log_tool_error "$BENCH_NAME" "Fast tracepoint not installed, see $dir/gdb-$kind.log"
+        return 1
+    fi
+
+    local frames=$(sed -n 's/.*Collected \([0-9]*\) trace frame.*/\1/p' "$dir/gdb-$kind.log" | tail -1)
+    [ -s "$dir/result" ] && [ -n "$frames" ] || return 1
+    echo "$(cut -d' ' -f2 "$dir/result") $frames"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! is_native_arch "$arch"; then
+        log_error "$BENCH_NAME needs a native build (x86_64 on this host); qemu-user cannot ptrace"
+        return 1
+    fi
+    if ! command -v gdb >/dev/null; then
+        log_error "$BENCH_NAME needs gdb on the host"
+        return 1
+    fi
+
+    local ipa_dir=$(get_output_dir "$arch" "gdbserver-ipa")
+    if [ ! -s "$ipa_dir/libinproctrace.so" ]; then
+        log_tool "$BENCH_NAME" "gdbserver-ipa not built for $arch, building it first..."
+        build_tool gdbserver-ipa "$arch" >/dev/null 2>&1 || {
+            log_error "Failed to build gdbserver-ipa for $arch"
+            return 1
+        }
+    fi
+
+    local dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch/$LIBC_TYPE"
+    mkdir -p "$dir"
+    if ! build_target "$arch" "$dir"; then
+        log_error "Could not build the sample program ($LIBC_TYPE) for $arch"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc mode hits frames ns_per_hit hits_per_s
+    log_tool "$BENCH_NAME" "$arch: $GDBSERVER_HITS calls to a traced function..."
+
+    local mode failed=0 base_ns=""
+    for mode in untraced trace ftrace; do
+        local loop_ns frames result
+        if [ "$mode" = "untraced" ]; then
+            rm -f "$dir/result"
+            "$dir/loop" "$GDBSERVER_HITS" "$dir/result" && [ -s "$dir/result" ] &&
+                result="$(cut -d' ' -f2 "$dir/result") -"
+        else
+            result=$(traced_run "$ipa_dir" "$dir" "$mode")
+        fi
+        if [ -z "$result" ]; then
+            log_tool_error "$BENCH_NAME" "$mode run failed on $arch (logs in $dir)"
+            failed=$((failed + 1))
+            continue
+        fi
+        read -r loop_ns frames <<< "$result"
+
+        if [ "$frames" != "-" ] && [ "$frames" -lt "$GDBSERVER_HITS" ]; then
+            log_tool_warn "$BENCH_NAME" "$mode collected $frames of $GDBSERVER_HITS hits"
+            failed=$((failed + 1))
+        fi
+
+        [ -n "$base_ns" ] || base_ns=$loop_ns
+        local per_hit=$(awk -v ns="$loop_ns" -v b="$base_ns" -v n="$GDBSERVER_HITS" \
+            'BEGIN { printf "%.0f", (ns - b) / n }')
+        local rate=$(awk -v ns="$loop_ns" -v n="$GDBSERVER_HITS" \
+            'BEGIN { if (ns <= 0) ns = 1; printf "%.0f", n * 1e9 / ns }')
+        bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$mode" "$GDBSERVER_HITS" \
+            "$frames" "$per_hit" "$rate"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
@@ -0,0 +1,183 @@
+#!/bin/bash
+# Cost of running under libheapprof (heapprof/heapprof.c): the malloc-stress
+# allocation loop, linked dynamically per libc, runs without the preload and
+# then with it at each HEAPPROF_SAMPLE setting. 0 keeps the counters and
+# size histogram only; the default (512 KiB) is what a production run uses;
+# smaller values sample more call sites and show the cost of the site table.
+#
+# Every preloaded run writes its exit dump to the work dir, and a run whose
+# dump is missing or counted no allocations is reported as a failure, so
+# the bench doubles as a check that the hooks are live on each arch/libc.
+#
+# ns_per_op is per allocator call (malloc/realloc plus its free) of the
+# stress loop; overhead_pct is relative to the run without the preload.
+# STRESS_THREADS and STRESS_ITERATIONS are shared with malloc-stress.sh.
+#
+# Usage: heapprof-overhead.sh <arch>
+# Results: $BENCH_DIR/heapprof-overhead.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/shared_lib_helpers.sh"
+source "$LIB_DIR/bench_helpers.sh"
+# write_stress_source and the STRESS_* defaults; its main only runs when
+# it is executed
+source "$(dirname "${BASH_SOURCE[0]}")/malloc-stress.sh"
+
+BENCH_NAME="heapprof-overhead"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+HEAPPROF_LIBCS="${HEAPPROF_LIBCS:-musl glibc}"
+HEAPPROF_SAMPLES="${HEAPPROF_SAMPLES:-0 524288 4096}"
+
+# build_stress_dynamic <arch> <libc> <dir> - build the stress test against
+# the libc's shared toolchain; prints "<loader> <library dir>"
+build_stress_dynamic() {
+    local arch=$1
+    local libc=$2
+    local dir=$3
+
+    (
+        export LIBC_TYPE=$libc
+        setup_shared_toolchain "$arch" >/dev/null 2>&1 || exit 1
+
+        write_stress_source "$dir/malloc-stress.c"
+        $CC -O2 -o "$dir/malloc-stress" "$dir/malloc-stress.c" -lpthread >&2 || exit 1
+
+        local libdir=$(dirname "$($CC -print-file-name=libc.so)")
+        local interp=$(readelf -l "$dir/malloc-stress" 2>/dev/null \
+            | sed -n 's/.*program interpreter: \(.*\)]/\1/p')
+        [ -n "$interp" ] || exit 1
+
+        local loader="$libdir/${interp##*/}"
+        if [ ! -e "$loader" ]; then
+            local toolchain_root=$(dirname "$(dirname "$(command -v "$CC")")")
+            loader=$(find "$toolchain_root" -name "${interp##*/}" 2>/dev/null | head -1)
+        fi
+        [ -n "$loader" ] && [ -e "$loader" ] || exit 1
+        echo "$loader $libdir"
+    )
+}
+
+# build_heapprof <arch> <libc> <dir> - build libheapprof into its own
+# output tree; prints the library path
+build_heapprof() {
+    local arch=$1
+    local libc=$2
+    local out="$3/lib"
+
+    (
+        export LIBC_TYPE=$libc STATIC_OUTPUT_DIR=$out SKIP_IF_EXISTS=false
+        bash "${SHARED_LIB_SCRIPTS[libheapprof]}" "$arch"
+    ) > "$out.log" 2>&1 || return 1
+
+    local lib="$out/$arch/shared/$libc/libheapprof.so"
+    [ -s "$lib" ] || return 1
+    echo "$lib"
+}
+
+# best_ms <cmd...> - fastest of BENCH_RUNS runs of a command, in ms
+best_ms() {
+    local best="" run ms
+
+    for run in $(seq 1 "$BENCH_RUNS"); do
+        ms=$(RUN_TIMEOUT=600 bench_time_ms "$@") || return 1
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+# check_dump <dir> - the preloaded runs left exit dumps that counted calls
+check_dump() {
+    local dir=$1
+    local dump
+
+    for dump in "$dir"/heapprof.*; do
+        [ -f "$dump" ] || return 1
+        grep -q '^# heapprof .*reason=exit' "$dump" || return 1
+        grep -q '^calls malloc=[1-9]' "$dump" || return 1
+    done
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc threads sample_bytes lib_bytes best_ms ns_per_op overhead_pct
+
+    local libc failed=0
+    for libc in $HEAPPROF_LIBCS; do
+        if ! LIBC_TYPE=$libc check_toolchain_availability "$arch"; then
+            log_tool_warn "$BENCH_NAME" "No $libc shared toolchain for $arch, skipping"
+            continue
+        fi
+
+        local dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch/$libc"
+        rm -rf "$dir"
+        mkdir -p "$dir"
+
+        local runtime loader libdir lib
+        if ! runtime=$(build_stress_dynamic "$arch" "$libc" "$dir"); then
+            log_tool_error "$BENCH_NAME" "Could not build the stress test ($libc) for $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        if ! lib=$(build_heapprof "$arch" "$libc" "$dir"); then
+            log_tool_error "$BENCH_NAME" "libheapprof ($libc) failed to build for $arch (see $dir/lib.log)"
+            failed=$((failed + 1))
+            continue
+        fi
+        read -r loader libdir <<< "$runtime"
+        local run=(run_target "$arch" "$loader" --library-path "$libdir")
+        local args=("$dir/malloc-stress" "$STRESS_THREADS" "$STRESS_ITERATIONS")
+        local lib_bytes=$(stat -c %s "$lib")
+
+        local base_ms
+        if ! base_ms=$(best_ms "${run[@]}" "${args[@]}"); then
+            log_tool_error "$BENCH_NAME" "Stress test ($libc) failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        bench_record "$BENCH_NAME" "$arch" "$libc" "$STRESS_THREADS" "-" "-" "$base_ms" \
+            "$(awk -v ms="$base_ms" -v n="$STRESS_ITERATIONS" 'BEGIN { printf "%.1f", ms * 1e6 / n }')" "-"
+
+        local sample
+        for sample in $HEAPPROF_SAMPLES; do
+            log_tool "$BENCH_NAME" "$arch/$libc: HEAPPROF_SAMPLE=$sample..."
+            local dumps="$dir/dumps-$sample"
+            mkdir -p "$dumps"
+
+            local ms
+            if ! ms=$(HEAPPROF_SAMPLE=$sample HEAPPROF_OUT="$dumps/heapprof.%p" \
+                best_ms "${run[@]}" --preload "$lib" "${args[@]}"); then
+                log_tool_error "$BENCH_NAME" "Stress test ($libc) failed under libheapprof (sample $sample) on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+            if ! check_dump "$dumps"; then
+                log_tool_error "$BENCH_NAME" "libheapprof ($libc, sample $sample) wrote no usable summary on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+
+            bench_record "$BENCH_NAME" "$arch" "$libc" "$STRESS_THREADS" "$sample" "$lib_bytes" "$ms" \
+                "$(awk -v ms="$ms" -v n="$STRESS_ITERATIONS" 'BEGIN { printf "%.1f", ms * 1e6 / n }')" \
+                "$(awk -v b="$base_ms" -v v="$ms" 'BEGIN { if (b <= 0) b = 1; printf "%+.1f", (v - b) * 100 / b }')"
+        done
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
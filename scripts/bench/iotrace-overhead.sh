@@ -0,0 +1,228 @@
+#!/bin/bash
+# Per-call cost of libiotrace (iotrace/iotrace.c): a loop of 64-byte
+# write/read pairs over a pipe, the cheapest calls the tracer wraps, runs
+# without the preload and then with it at each IOTRACE_SAMPLE setting. Two
+# clock reads and one ring record per traced call are the whole overhead,
+# so a target without a vDSO clock_gettime shows it here.
+#
+# The traced runs also check the ring: the static iotrace-read drains it
+# afterwards (-a -i 0) and must find every traced call, none lost.
+#
+# ns_per_call is per read or write; overhead_pct is relative to the run
+# without the preload.
+#
+# Usage: iotrace-overhead.sh <arch>
+# Results: $BENCH_DIR/iotrace-overhead.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/shared_lib_helpers.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="iotrace-overhead"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+IOTRACE_LIBCS="${IOTRACE_LIBCS:-musl glibc}"
+IOTRACE_SAMPLES="${IOTRACE_SAMPLES:-1 16}"
+IOTRACE_ITERATIONS="${IOTRACE_ITERATIONS:-200000}"
+
+write_loop_source() {
+    local path=$1
+
+    cat > "$path" << 'LOOP_EOF'
+/* write/read pairs over a pipe: no wait in the kernel, so the time per
+ * call is dominated by the syscall and whatever wraps it */
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 100000, i;
+    char buf[64] = { 0 };
+    int p[2];
+
+    if (pipe(p) != 0)
+        return 1;
+    for (i = 0; i < iterations; i++) {
+        if (write(p[1], buf, sizeof(buf)) != sizeof(buf)
+            || read(p[0], buf, sizeof(buf)) != sizeof(buf))
+            return 1;
+    }
+    return 0;
+}
+LOOP_EOF
+}
+
+# build_loop <arch> <libc> <dir> - build the loop against the libc's shared
+# toolchain; prints "<loader> <library dir>"
+build_loop() {
+    local arch=$1
+    local libc=$2
+    local dir=$3
+
+    (
+        export LIBC_TYPE=$libc
+        setup_shared_toolchain "$arch" >/dev/null 2>&1 || exit 1
+
+        write_loop_source "$dir/io-loop.c"
+        $CC -O2 -o "$dir/io-loop" "$dir/io-loop.c" >&2 || exit 1
+
+        local libdir=$(dirname "$($CC -print-file-name=libc.so)")
+        local interp=$(readelf -l "$dir/io-loop" 2>/dev/null \
+            | sed -n 's/.*program interpreter: \(.*\)]/\1/p')
+        [ -n "$interp" ] || exit 1
+
+        local loader="$libdir/${interp##*/}"
+        if [ ! -e "$loader" ]; then
+            local toolchain_root=$(dirname "$(dirname "$(command -v "$CC")")")
+            loader=$(find "$toolchain_root" -name "${interp##*/}" 2>/dev/null | head -1)
+        fi
+        [ -n "$loader" ] && [ -e "$loader" ] || exit 1
+        echo "$loader $libdir"
+    )
+}
+
+# build_iotrace <arch> <libc> <dir> - build libiotrace into its own output
+# tree; prints the library path
+build_iotrace() {
+    local arch=$1
+    local libc=$2
+    local out="$3/lib"
+
+    (
+        export LIBC_TYPE=$libc STATIC_OUTPUT_DIR=$out SKIP_IF_EXISTS=false
+        bash "${SHARED_LIB_SCRIPTS[libiotrace]}" "$arch"
+    ) > "$out.log" 2>&1 || return 1
+
+    local lib="$out/$arch/shared/$libc/libiotrace.so"
+    [ -s "$lib" ] || return 1
+    echo "$lib"
+}
+
+# best_ms <cmd...> - fastest of BENCH_RUNS runs of a command, in ms
+best_ms() {
+    local best="" run ms
+
+    for run in $(seq 1 "$BENCH_RUNS"); do
+        ms=$(RUN_TIMEOUT=600 bench_time_ms "$@") || return 1
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+# check_ring <arch> <reader> <ring> <expected> - the reader finds exactly
+# the expected number of records and lost none; prints the record count
+check_ring() {
+    local arch=$1
+    local reader=$2
+    local ring=$3
+    local expected=$4
+    local header
+
+    header=$(run_target "$arch" "$reader" -a -i 0 -H "$ring" 2>/dev/null | head -1) || return 1
+    local records=$(echo "$header" | sed -n 's/.* records=\([0-9]*\) .*/\1/p')
+    local lost=$(echo "$header" | sed -n 's/.* lost=\([0-9]*\) .*/\1/p')
+
+    echo "${records:--}"
+    [ "$records" = "$expected" ] && [ "$lost" = "0" ]
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc sample calls best_ms ns_per_call overhead_pct records
+
+    local work="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$work"
+
+    local reader=$(get_output_path "$arch" "iotrace-read")
+    if ! (export LIBC_TYPE=musl; build_tool "iotrace-read" "$arch") > "$work/reader.log" 2>&1 \
+        || [ ! -x "$reader" ]; then
+        log_tool_error "$BENCH_NAME" "iotrace-read failed to build for $arch (see $work/reader.log)"
+        return 1
+    fi
+
+    local calls=$((IOTRACE_ITERATIONS * 2))
+    # Big enough that the check reads every record of a run
+    local slots=$((calls + 1024))
+
+    local libc failed=0
+    for libc in $IOTRACE_LIBCS; do
+        if ! LIBC_TYPE=$libc check_toolchain_availability "$arch"; then
+            log_tool_warn "$BENCH_NAME" "No $libc shared toolchain for $arch, skipping"
+            continue
+        fi
+
+        local dir="$work/$libc"
+        rm -rf "$dir"
+        mkdir -p "$dir"
+
+        local runtime loader libdir lib
+        if ! runtime=$(build_loop "$arch" "$libc" "$dir"); then
+            log_tool_error "$BENCH_NAME" "Could not build the I/O loop ($libc) for $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        if ! lib=$(build_iotrace "$arch" "$libc" "$dir"); then
+            log_tool_error "$BENCH_NAME" "libiotrace ($libc) failed to build for $arch (see $dir/lib.log)"
+            failed=$((failed + 1))
+            continue
+        fi
+        read -r loader libdir <<< "$runtime"
+        local run=(run_target "$arch" "$loader" --library-path "$libdir")
+        local args=("$dir/io-loop" "$IOTRACE_ITERATIONS")
+
+        local base_ms
+        if ! base_ms=$(best_ms "${run[@]}" "${args[@]}"); then
+            log_tool_error "$BENCH_NAME" "I/O loop ($libc) failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        bench_record "$BENCH_NAME" "$arch" "$libc" "-" "$calls" "$base_ms" \
+            "$(awk -v ms="$base_ms" -v n="$calls" 'BEGIN { printf "%.1f", ms * 1e6 / n }')" "-" "-"
+
+        local sample
+        for sample in $IOTRACE_SAMPLES; do
+            log_tool "$BENCH_NAME" "$arch/$libc: IOTRACE_SAMPLE=$sample..."
+            local ring="$dir/ring-$sample"
+
+            local ms
+            if ! ms=$(IOTRACE_SAMPLE=$sample IOTRACE_SLOTS=$slots IOTRACE_RING="$ring" \
+                best_ms "${run[@]}" --preload "$lib" "${args[@]}"); then
+                log_tool_error "$BENCH_NAME" "I/O loop ($libc) failed under libiotrace (sample $sample) on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+
+            # Each thread traces its first call, then one in every $sample
+            local expected=$(( (calls + sample - 1) / sample ))
+            local records
+            if ! records=$(check_ring "$arch" "$reader" "$ring" "$expected"); then
+                log_tool_error "$BENCH_NAME" "iotrace-read found $records of $expected records ($libc, sample $sample) on $arch"
+                failed=$((failed + 1))
+            fi
+
+            bench_record "$BENCH_NAME" "$arch" "$libc" "$sample" "$calls" "$ms" \
+                "$(awk -v ms="$ms" -v n="$calls" 'BEGIN { printf "%.1f", ms * 1e6 / n }')" \
+                "$(awk -v b="$base_ms" -v v="$ms" 'BEGIN { if (b <= 0) b = 1; printf "%+.1f", (v - b) * 100 / b }')" \
+                "$records"
+        done
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
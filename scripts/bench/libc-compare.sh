@@ -0,0 +1,124 @@
+#!/bin/bash
+# Compare the libc variants (musl/glibc/uclibc) of each tool already built
+# for an arch: exec-to-exit startup time plus a representative workload
+# (natively on x86, under qemu-user otherwise). The fastest variant is
+# recorded per tool in output/<arch>/manifest.tsv; when variants are within
+# LIBC_TIE_PCT percent of each other the smaller binary wins.
+#
+#   <tool>        recommended_libc   musl
+#   <tool>.<libc> startup_ms         12
+#   <tool>.<libc> workload_ms        840
+#
+# Usage: libc-compare.sh <arch> [tool...]
+# Build the variants first, e.g. ./build tcpdump --arch aarch64 (both libcs).
+# Results: $BENCH_DIR/libc-compare.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/bench_helpers.sh"
+source "$LIB_DIR/manifest.sh"
+
+BENCH_NAME="libc-compare"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+LIBC_TIE_PCT="${LIBC_TIE_PCT:-5}"
+OUTPUT_ROOT="${STATIC_OUTPUT_DIR:-/build/output}"
+DEFAULT_TOOLS="tcpdump curl curl-full bash nmap busybox socat openssl microsocks"
+LIBC_VARIANTS="musl glibc uclibc"
+
+# Fastest of BENCH_RUNS version/usage runs, in ms
+measure_startup() {
+    local arch=$1
+    local tool=$2
+    local binary=$3
+    local args=$(bench_version_args "$tool")
+    local best="" run
+
+    for run in $(seq 1 "$BENCH_RUNS"); do
+        local ms
+        ms=$(bench_time_ms run_target "$arch" "$binary" $args)
+        [ $? -lt 124 ] || return 1
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+# pick_libc <libc:ms:size>... - fastest variant, smaller binary on near-ties
+pick_libc() {
+    printf '%s\n' "$@" | sort -t: -k2,2n | awk -F: -v tie="$LIBC_TIE_PCT" '
+        NR == 1 { best = $1; best_ms = $2; best_size = $3; limit = $2 * (1 + tie / 100); next }
+        $2 <= limit && $3 < best_size { best = $1; best_size = $3 }
+        END { print best }
+    '
+}
+
+compare_tool() {
+    local arch=$1
+    local tool=$2
+    local candidates=()
+    local libc
+
+    for libc in $LIBC_VARIANTS; do
+        local entry="$tool.$libc"
+        local binary="$OUTPUT_ROOT/$arch/$entry"
+        [ -s "$binary" ] || continue
+
+        local startup result
+        if ! startup=$(measure_startup "$arch" "$tool" "$binary") || \
+           ! result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$tool" "$arch" "$binary"); then
+            log_tool_error "$BENCH_NAME" "$entry failed to run on $arch"
+            bench_record "$BENCH_NAME" "$arch" "$tool" "$libc" "-" "-" "-" "-" "failed"
+            continue
+        fi
+
+        local bytes=${result% *}
+        local ms=${result#* }
+        local size=$(stat -c %s "$binary")
+        local rate="-"
+        [ "$bytes" -gt 0 ] && rate=$(bench_throughput "$bytes" "$ms")
+
+        bench_record "$BENCH_NAME" "$arch" "$tool" "$libc" "$size" "$startup" "$ms" "$rate" "ok"
+        manifest_set "$arch" "$entry" startup_ms "$startup"
+        manifest_set "$arch" "$entry" workload_ms "$ms"
+        candidates+=("$libc:$ms:$size")
+    done
+
+    if [ ${#candidates[@]} -eq 0 ]; then
+        log_tool_warn "$BENCH_NAME" "No runnable libc variants of $tool for $arch"
+        return 1
+    fi
+
+    local best=$(pick_libc "${candidates[@]}")
+    manifest_set "$arch" "$tool" recommended_libc "$best"
+    log_tool "$BENCH_NAME" "$tool on $arch: recommended libc is $best (${#candidates[@]} variants measured)"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [tool...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local tools="${*:-$DEFAULT_TOOLS}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch tool libc size_bytes startup_ms workload_ms mb_per_s status
+    bench_prepare_workloads
+
+    local tool
+    for tool in $tools; do
+        compare_tool "$arch" "$tool"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv, recommendations in $(get_manifest_path "$arch")"
+    return 0
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
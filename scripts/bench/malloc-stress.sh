@@ -0,0 +1,234 @@
+#!/bin/bash
+# Compare musl's malloc with mimalloc (TOOL_MALLOC_POLICY in
+# scripts/lib/dependency_builder.sh) on musl static builds:
+#
+#   - an allocator stress test (mixed small/medium allocations, realloc
+#     growth and frees over several threads) linked both ways
+#   - nmap, tcpdump and curl-full built with MALLOC_IMPL=musl and =mimalloc, timed
+#     on their shared bench workloads
+#
+# Usage: malloc-stress.sh <arch> [tool...]
+# Results: $BENCH_DIR/malloc-stress.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="malloc-stress"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+STRESS_THREADS="${STRESS_THREADS:-4}"
+STRESS_ITERATIONS="${STRESS_ITERATIONS:-2000000}"
+DEFAULT_TOOLS="nmap tcpdump curl-full"
+
+write_stress_source() {
+    local path=$1
+
+    cat > "$path" << 'STRESS_EOF'
+/* Allocation pattern loosely modelled on packet/host bookkeeping: mostly
+ * small objects, some buffers, occasional growth via realloc. */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOTS 4096
+
+static long iterations;
+
+static uint32_t next_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static size_t pick_size(uint32_t r)
+{
+    if ((r & 0xff) < 200)
+        return 8 + (r >> 8) % 120;      /* list nodes, small strings */
+    if ((r & 0xff) < 250)
+        return 128 + (r >> 8) % 1920;   /* headers, records */
+    return 2048 + (r >> 8) % 63488;     /* packet and transfer buffers */
+}
+
+static void *worker(void *arg)
+{
+    uint32_t state = 2463534242u + (uint32_t)(uintptr_t)arg;
+    void **slots = calloc(SLOTS, sizeof(*slots));
+    unsigned long sum = 0;
+    long i;
+
+    if (!slots)
+        return (void *)1;
+
+    for (i = 0; i < iterations; i++) {
+        uint32_t r = next_rand(&state);
+        size_t slot = r % SLOTS;
+        size_t size = pick_size(next_rand(&state));
+
+        if (slots[slot] && (r & 0x700) == 0) {
+            void *p = realloc(slots[slot], size * 2);
+            if (!p)
+                return (void *)1;
+            slots[slot] = p;
+        } else {
+            free(slots[slot]);
+            slots[slot] = malloc(size);
+            if (!slots[slot])
+                return (void *)1;
+        }
+        ((unsigned char *)slots[slot])[0] = (unsigned char)i;
+        sum += ((unsigned char *)slots[slot])[0];
+    }
+
+    for (i = 0; i < SLOTS; i++)
+        free(slots[i]);
+    free(slots);
+    return sum ? NULL : (void *)1;
+}
+
+int main(int argc, char **argv)
+{
+    int threads = argc > 1 ? atoi(argv[1]) : 4;
+    pthread_t tids[64];
+    int i, failed = 0;
+
+    iterations = argc > 2 ? atol(argv[2]) : 1000000;
+    if (threads < 1 || threads > 64)
+        threads = 4;
+    iterations /= threads;
+
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker, (void *)(uintptr_t)i) != 0)
+            return 1;
+    }
+    for (i = 0; i < threads; i++) {
+        void *rc;
+        pthread_join(tids[i], &rc);
+        failed |= rc != NULL;
+    }
+    return failed;
+}
+STRESS_EOF
+}
+
+# build_stress <arch> <work_dir> - link the stress test against each
+# allocator; prints the variants that were built
+build_stress() {
+    local arch=$1
+    local work_dir=$2
+
+    (
+        setup_toolchain_for_arch "$arch" >/dev/null 2>&1 || exit 1
+
+        local src="$work_dir/malloc-stress.c"
+        local cflags=$(get_compile_flags "$arch" "static" "$BENCH_NAME")
+        local ldflags=$(get_link_flags "$arch" "static")
+        write_stress_source "$src"
+
+        $CC $cflags -o "$work_dir/malloc-stress.musl" "$src" $ldflags -lpthread >&2 && echo musl
+
+        local mi_flags=$(MALLOC_IMPL=mimalloc get_malloc_link_flags "$arch" "$BENCH_NAME")
+        if [ -n "$mi_flags" ]; then
+            $CC $cflags -o "$work_dir/malloc-stress.mimalloc" "$src" $ldflags $mi_flags -lpthread >&2 && echo mimalloc
+        fi
+    )
+}
+
+# run_stress <arch> <binary> - fastest of BENCH_RUNS runs, in ms
+run_stress() {
+    local arch=$1
+    local binary=$2
+    local best="" run ms
+
+    for run in $(seq 1 "$BENCH_RUNS"); do
+        ms=$(RUN_TIMEOUT=600 bench_time_ms run_target "$arch" "$binary" \
+            "$STRESS_THREADS" "$STRESS_ITERATIONS") || return 1
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [tool...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local tools="${*:-$DEFAULT_TOOLS}"
+
+    export LIBC_TYPE=musl
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch test malloc size_bytes best_ms mb_per_s
+    bench_prepare_workloads
+
+    local work_dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$work_dir"
+
+    local failed=0 impl
+    local variants=$(build_stress "$arch" "$work_dir")
+    if [ -z "$variants" ]; then
+        log_tool_error "$BENCH_NAME" "Could not build the stress test for $arch"
+        failed=$((failed + 1))
+    elif [ "$variants" = "musl" ]; then
+        log_tool_warn "$BENCH_NAME" "mimalloc not available for $arch, measuring musl malloc only"
+    fi
+
+    for impl in $variants; do
+        local binary="$work_dir/malloc-stress.$impl"
+        local ms
+        if ! ms=$(run_stress "$arch" "$binary"); then
+            log_tool_error "$BENCH_NAME" "Stress test ($impl) failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        bench_record "$BENCH_NAME" "$arch" "stress" "$impl" "$(stat -c %s "$binary")" "$ms" "-"
+    done
+
+    local tool
+    for tool in $tools; do
+        if ! bench_build_variants "$tool" "$arch" "$work_dir" MALLOC_IMPL musl mimalloc; then
+            failed=$((failed + 1))
+            continue
+        fi
+        if cmp -s "$work_dir/$tool.musl" "$work_dir/$tool.mimalloc"; then
+            log_tool_warn "$BENCH_NAME" "$tool fell back to musl malloc on $arch, skipping"
+            continue
+        fi
+
+        for impl in musl mimalloc; do
+            local binary="$work_dir/$tool.$impl"
+            local result
+            if ! result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$tool" "$arch" "$binary"); then
+                log_tool_error "$BENCH_NAME" "$tool ($impl) workload failed on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+            local bytes=${result% *}
+            local ms=${result#* }
+            local rate="-"
+            [ "$bytes" -gt 0 ] && rate=$(bench_throughput "$bytes" "$ms")
+            bench_record "$BENCH_NAME" "$arch" "$tool" "$impl" \
+                "$(stat -c %s "$binary")" "$ms" "$rate"
+        done
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
@@ -0,0 +1,177 @@
+#!/bin/bash
+# memcpy/memmove/memset/strlen bandwidth of musl's own routines vs the
+# optimized ones ARCH_CONFIG selects for the arch (string_routines=), at
+# cache-resident and DRAM-sized blocks. Natively on x86, under qemu-user
+# otherwise; qemu numbers only compare the two builds, not real hardware.
+#
+# Usage: mem-bandwidth.sh <arch>
+# Results: $BENCH_DIR/mem-bandwidth.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="mem-bandwidth"
+BANDWIDTH_SIZES="${BANDWIDTH_SIZES:-64 1024 16384 262144 8388608}"
+BANDWIDTH_MB="${BANDWIDTH_MB:-256}"
+
+write_bandwidth_source() {
+    local path=$1
+
+    cat > "$path" << 'BANDWIDTH_EOF'
+/* Prints "<routine> <block bytes> <MB/s>" per routine and block size */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static volatile size_t sink;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, size_t size, size_t total, double secs)
+{
+    printf("%s %zu %.1f\n", name, size, total / 1048576.0 / (secs > 0 ? secs : 1e-9));
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = (size_t)(argc > 1 ? atol(argv[1]) : 256) << 20;
+    int i;
+
+    for (i = 2; i < argc; i++) {
+        size_t size = strtoul(argv[i], NULL, 10);
+        size_t reps = total / size ? total / size : 1;
+        char *src = malloc(size + 64);
+        char *dst = malloc(size + 64);
+        size_t r;
+        double t;
+
+        if (!src || !dst)
+            return 1;
+        memset(src, 'a', size + 64);
+        memset(dst, 'b', size + 64);
+        src[size - 1] = '\0';
+
+        t = now();
+        for (r = 0; r < reps; r++)
+            memcpy(dst + (r & 7), src, size);
+        report("memcpy", size, reps * size, now() - t);
+
+        t = now();
+        for (r = 0; r < reps; r++)
+            memmove(src + 1 + (r & 7), src, size);  /* overlapping, backwards */
+        report("memmove", size, reps * size, now() - t);
+
+        t = now();
+        for (r = 0; r < reps; r++)
+            memset(dst, (int)r, size);
+        report("memset", size, reps * size, now() - t);
+
+        memset(src, 'a', size);
+        src[size - 1] = '\0';
+        t = now();
+        for (r = 0; r < reps; r++)
+            sink += strlen(src);
+        report("strlen", size, reps * size, now() - t);
+
+        free(src);
+        free(dst);
+    }
+    return 0;
+}
+BANDWIDTH_EOF
+}
+
+# build_bandwidth <arch> <work_dir> - link the benchmark against libc's
+# routines and, when the arch has them, the optimized ones; prints the
+# variants built. The optimized link is checked against its map: every
+# routine must come from libstrroutines.a, or the variant is dropped.
+build_bandwidth() {
+    local arch=$1
+    local work_dir=$2
+
+    (
+        setup_toolchain_for_arch "$arch" >/dev/null 2>&1 || exit 1
+
+        local src="$work_dir/mem-bandwidth.c"
+        local cflags="$(get_compile_flags "$arch" "static" "$BENCH_NAME") -fno-builtin"
+        write_bandwidth_source "$src"
+
+        unset STRING_ROUTINES_DIR
+        $CC $cflags -o "$work_dir/mem-bandwidth.libc" "$src" $(get_link_flags "$arch" "static") >&2 && echo libc
+
+        prepare_string_routines "$arch"
+        if [ -n "${STRING_ROUTINES_DIR:-}" ]; then
+            local impl=$(get_string_routines "$arch")
+            local map="$work_dir/mem-bandwidth.$impl.map"
+            $CC $cflags -o "$work_dir/mem-bandwidth.$impl" "$src" $(get_link_flags "$arch" "static") \
+                -Wl,-Map="$map" >&2 || exit 0
+
+            local missing
+            if missing=$(check_string_routines_linked "$map" "$STRING_ROUTINES_DIR"); then
+                log_tool "$BENCH_NAME" "$impl routines replace libc's in the $impl build"
+                echo "$impl"
+            else
+                log_tool_error "$BENCH_NAME" "Still libc's in the $impl build: ${missing:-no map} (see $map)"
+            fi
+        fi
+    )
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE=musl
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch impl routine block_bytes mb_per_s
+
+    local work_dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$work_dir"
+
+    local variants=$(build_bandwidth "$arch" "$work_dir")
+    if [ -z "$variants" ]; then
+        log_tool_error "$BENCH_NAME" "Could not build the benchmark for $arch"
+        return 1
+    elif [ "$variants" = "libc" ]; then
+        log_tool_error "$BENCH_NAME" "No optimized string routines for $arch (string_routines= in ARCH_CONFIG), nothing to compare"
+        return 1
+    fi
+
+    local impl failed=0
+    for impl in $variants; do
+        log_tool "$BENCH_NAME" "Measuring $impl routines on $arch..."
+        local output
+        if ! output=$(RUN_TIMEOUT=900 run_target "$arch" "$work_dir/mem-bandwidth.$impl" \
+                "$BANDWIDTH_MB" $BANDWIDTH_SIZES); then
+            log_tool_error "$BENCH_NAME" "$impl run failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local routine size rate
+        while read -r routine size rate; do
+            bench_record "$BENCH_NAME" "$arch" "$impl" "$routine" "$size" "$rate"
+        done <<< "$output"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
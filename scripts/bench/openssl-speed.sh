@@ -0,0 +1,90 @@
+#!/bin/bash
+# Run the built openssl's "speed" for the ciphers our TLS tools negotiate
+# (AES-GCM, ChaCha20-Poly1305) plus SHA-256, natively or under qemu-user.
+# qemu numbers are only comparable between builds for the same arch, not
+# across archs or with real hardware.
+#
+# Usage: openssl-speed.sh <arch> [algorithm...]
+# Results: $BENCH_DIR/openssl-speed.tsv (throughput in MB/s per block size)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="openssl-speed"
+SPEED_SECONDS="${SPEED_SECONDS:-3}"
+DEFAULT_ALGS="aes-128-gcm aes-256-gcm chacha20-poly1305 sha256"
+
+# run_speed <arch> <binary> <alg> - print the "+F" machine-readable line:
+# +F:<n>:<alg>:<bytes/s at 16>:<64>:<256>:<1024>:<8192>:<16384>
+run_speed() {
+    local arch=$1
+    local binary=$2
+    local alg=$3
+
+    RUN_TIMEOUT=$((SPEED_SECONDS * 10 + 60)) \
+        run_target "$arch" "$binary" speed -mr -seconds "$SPEED_SECONDS" -evp "$alg" 2>/dev/null \
+        | grep '^+F:' | tail -n 1
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [algorithm...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local algs="${*:-$DEFAULT_ALGS}"
+
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    local binary=$(get_output_path "$arch" "openssl")
+    if [ ! -s "$binary" ]; then
+        log_tool "$BENCH_NAME" "openssl not built for $arch, building it first..."
+        build_tool openssl "$arch" >/dev/null 2>&1 || {
+            log_error "Failed to build openssl for $arch"
+            return 1
+        }
+    fi
+
+    local target=$(get_openssl_target "$arch")
+    local asm=$(get_openssl_asm_opt "$arch")
+    case "$target" in
+        linux-generic*) asm="no-asm" ;;
+    esac
+
+    bench_init "$BENCH_NAME" arch libc target asm algorithm mb_s_16 mb_s_1k mb_s_16k
+
+    local alg failed=0
+    for alg in $algs; do
+        log_tool "$BENCH_NAME" "openssl speed $alg on $arch (${SPEED_SECONDS}s per block size)..."
+        local line=$(run_speed "$arch" "$binary" "$alg")
+        if [ -z "$line" ]; then
+            log_tool_error "$BENCH_NAME" "openssl speed -evp $alg failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local rates
+        IFS=':' read -r -a rates <<< "$line"
+        local mb16=$(awk -v b="${rates[3]}" 'BEGIN { printf "%.2f", b / 1048576 }')
+        local mb1k=$(awk -v b="${rates[6]}" 'BEGIN { printf "%.2f", b / 1048576 }')
+        local mb16k=$(awk -v b="${rates[8]}" 'BEGIN { printf "%.2f", b / 1048576 }')
+
+        bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$target" "${asm:-asm}" \
+            "$alg" "$mb16" "$mb1k" "$mb16k"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
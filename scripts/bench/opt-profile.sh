@@ -0,0 +1,101 @@
+#!/bin/bash
+# Measure binary size and throughput of the data-path tools built with the
+# "size" (-Os) and "speed" (-O2) optimization profiles, to back the defaults
+# in TOOL_OPT_POLICY (scripts/lib/core/compile_flags.sh). Each tool's
+# recommendation is recorded in output/<arch>/manifest.tsv: "speed" when it
+# gains at least OPT_SPEED_MIN_GAIN percent MB/s over "size", else "size".
+#
+#   <tool>   recommended_profile   speed
+#
+# Usage: opt-profile.sh <arch> [tool...]
+# Results: $BENCH_DIR/opt-profile.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/bench_helpers.sh"
+source "$LIB_DIR/manifest.sh"
+
+BENCH_NAME="opt-profile"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+OPT_SPEED_MIN_GAIN="${OPT_SPEED_MIN_GAIN:-10}"
+DEFAULT_TOOLS="socat tcpdump curl openssl microsocks"
+
+# recommend_profile <arch> <tool> <size_rate> <size_bytes> <speed_rate> <speed_bytes>
+recommend_profile() {
+    local arch=$1
+    local tool=$2
+    local summary best gain growth
+
+    summary=$(awk -v sr="$3" -v sb="$4" -v fr="$5" -v fb="$6" -v min="$OPT_SPEED_MIN_GAIN" 'BEGIN {
+        if (sr <= 0) sr = 0.01
+        if (sb <= 0) sb = 1
+        gain = (fr - sr) * 100 / sr
+        printf "%s %+.1f %+.1f", (gain >= min ? "speed" : "size"), gain, (fb - sb) * 100 / sb
+    }')
+    read -r best gain growth <<< "$summary"
+
+    manifest_set "$arch" "$tool" recommended_profile "$best"
+    local current=$(OPT_PROFILE= get_tool_opt_profile "$tool")
+    log_tool "$BENCH_NAME" "$tool on $arch: speed vs size is ${gain}% MB/s, ${growth}% bytes; recommended profile is $best (TOOL_OPT_POLICY: $current)"
+    if [ "$best" != "$current" ]; then
+        log_tool_warn "$BENCH_NAME" "$tool: TOOL_OPT_POLICY default ($current) differs from the measurement ($best)"
+    fi
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [tool...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local tools="${*:-$DEFAULT_TOOLS}"
+
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc tool profile size_bytes best_ms mb_per_s
+    bench_prepare_workloads
+
+    local work_dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$work_dir"
+
+    local tool profile failed=0
+    for tool in $tools; do
+        if ! bench_build_variants "$tool" "$arch" "$work_dir" OPT_PROFILE size speed; then
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local measured=()
+        for profile in size speed; do
+            local binary="$work_dir/$tool.$profile"
+            local size=$(stat -c %s "$binary")
+            local result
+            if ! result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$tool" "$arch" "$binary"); then
+                log_tool_error "$BENCH_NAME" "$tool ($profile) workload failed on $arch"
+                failed=$((failed + 1))
+                continue
+            fi
+            local bytes=${result% *}
+            local ms=${result#* }
+            local rate=$(bench_throughput "$bytes" "$ms")
+            bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$tool" "$profile" \
+                "$size" "$ms" "$rate"
+            measured+=("$rate" "$size")
+        done
+
+        [ ${#measured[@]} -eq 4 ] && recommend_profile "$arch" "$tool" "${measured[@]}"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv, recommendations in $(get_manifest_path "$arch")"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
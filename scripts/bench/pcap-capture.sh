@@ -0,0 +1,149 @@
+#!/bin/bash
+# Live capture rate and kernel drops of the built tcpdump: frames from the
+# synthetic bench pcap are injected on lo through a packet socket as fast as
+# Python can send them while tcpdump captures them into /dev/null. Run once
+# with libpcap's built-in ring (LIBPCAP_RING_KB) and once per -B size in
+# CAPTURE_BUFFERS. Needs CAP_NET_RAW (root in the build container).
+#
+# Usage: pcap-capture.sh <arch>
+# Results: $BENCH_DIR/pcap-capture.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="pcap-capture"
+CAPTURE_PACKETS="${CAPTURE_PACKETS:-200000}"
+CAPTURE_BUFFERS="${CAPTURE_BUFFERS:-default 16384}"
+# Source MAC of every frame bench_make_pcap writes
+CAPTURE_FILTER="ether src 02:00:00:00:00:02"
+
+# inject_frames <pcap> <count> - send frames on lo, print "<sent> <seconds>".
+# The destination MAC is not lo's, so the stack drops them as OTHERHOST
+# right after the packet taps have seen them.
+inject_frames() {
+    python3 - "$1" "$2" << 'INJECT_EOF'
+import socket, struct, sys, time
+
+path, count = sys.argv[1], int(sys.argv[2])
+frames = []
+with open(path, "rb") as f:
+    f.read(24)
+    while len(frames) < count:
+        hdr = f.read(16)
+        if len(hdr) < 16:
+            f.seek(24)
+            continue
+        incl = struct.unpack("<IIII", hdr)[2]
+        frames.append(f.read(incl))
+
+s = socket.socket(socket.AF_PACKET, socket.SOCK_RAW)
+s.bind(("lo", 0))
+sent = 0
+start = time.time()
+for frame in frames:
+    try:
+        s.send(frame)
+        sent += 1
+    except OSError:
+        pass
+print(sent, "%.3f" % (time.time() - start))
+INJECT_EOF
+}
+
+# capture_run <arch> <binary> <buffer_kb|default> - print
+# "<sent> <seconds> <captured> <dropped by kernel>"
+capture_run() {
+    local arch=$1
+    local binary=$2
+    local buffer=$3
+    local log="$BENCH_WORK_DIR/$BENCH_NAME.$arch.log"
+    local args=(-i lo -n -Q in -w /dev/null)
+
+    [ "$buffer" = "default" ] || args+=(-B "$buffer")
+
+    RUN_TIMEOUT=600 run_target "$arch" "$binary" "${args[@]}" "$CAPTURE_FILTER" 2> "$log" &
+    local pid=$!
+
+    local waited=0
+    while ! grep -q "listening on" "$log" 2>/dev/null; do
+        sleep 0.2
+        waited=$((waited + 1))
+        if [ $waited -ge 150 ] || ! kill -0 "$pid" 2>/dev/null; then
+            bench_stop "$pid"
+            sed 's/^/    /' "$log" >&2
+            return 1
+        fi
+    done
+
+    local sent secs
+    read -r sent secs <<< "$(inject_frames "$BENCH_WORK_DIR/workload.pcap" "$CAPTURE_PACKETS")"
+    sleep 1
+    bench_stop "$pid"
+    wait "$pid" 2>/dev/null
+
+    local captured=$(sed -n 's/^\([0-9]*\) packets\{0,1\} captured.*/\1/p' "$log")
+    local dropped=$(sed -n 's/^\([0-9]*\) packets\{0,1\} dropped by kernel.*/\1/p' "$log")
+    [ -n "$sent" ] && [ -n "$captured" ] || return 1
+    echo "$sent $secs $captured ${dropped:-0}"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if [ "$(id -u)" != "0" ]; then
+        log_error "Live capture needs root (CAP_NET_RAW)"
+        return 1
+    fi
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    local binary=$(get_output_path "$arch" "tcpdump")
+    if [ ! -s "$binary" ]; then
+        log_tool "$BENCH_NAME" "tcpdump not built for $arch, building it first..."
+        build_tool tcpdump "$arch" >/dev/null 2>&1 || {
+            log_error "Failed to build tcpdump for $arch"
+            return 1
+        }
+    fi
+
+    bench_init "$BENCH_NAME" arch libc buffer_kb sent send_kpps captured dropped capture_pct
+    bench_prepare_workloads
+
+    local buffer failed=0
+    for buffer in $CAPTURE_BUFFERS; do
+        local label=$buffer
+        [ "$buffer" = "default" ] && label="default(${LIBPCAP_RING_KB})"
+
+        log_tool "$BENCH_NAME" "Capturing $CAPTURE_PACKETS frames on lo, buffer $label KB..."
+        local result
+        if ! result=$(capture_run "$arch" "$binary" "$buffer"); then
+            log_tool_error "$BENCH_NAME" "tcpdump capture failed on $arch (buffer $label)"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local sent secs captured dropped
+        read -r sent secs captured dropped <<< "$result"
+        local kpps=$(awk -v n="$sent" -v s="$secs" 'BEGIN { if (s <= 0) s = 0.001; printf "%.1f", n / s / 1000 }')
+        local pct=$(awk -v c="$captured" -v n="$sent" 'BEGIN { if (n > 0) printf "%.1f", c * 100 / n; else print "0.0" }')
+
+        bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$label" "$sent" "$kpps" \
+            "$captured" "$dropped" "$pct"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
@@ -0,0 +1,97 @@
+#!/bin/bash
+# Speedup of profile-guided builds (scripts/lib/pgo.sh) over the standard
+# build of each throughput tool. A tool without a profile for the arch is
+# trained first (instrumented build plus its scripts/pgo/ training run);
+# PGO_RETRAIN=true trains again. Both builds then run the same workload as
+# the other benches; the training inputs are generated the same way but
+# smaller, so expect the gain on real traffic to be somewhat lower.
+#
+# speedup_pct is relative to the standard build of the same tool: +8.0
+# means the PGO build finished the workload 8% faster.
+#
+# Usage: pgo.sh <arch> [tool...]
+# Results: $BENCH_DIR/pgo.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="pgo"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+DEFAULT_TOOLS="tcpdump socat ncat openssl curl"
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [tool...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local tools="${*:-$DEFAULT_TOOLS}"
+
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch libc tool version build size_bytes best_ms mb_per_s speedup_pct
+    bench_prepare_workloads
+
+    local work_dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$work_dir"
+
+    local tool failed=0
+    for tool in $tools; do
+        if ! pgo_supported "$tool" "$arch"; then
+            log_tool_warn "$BENCH_NAME" "No PGO for $tool on $arch (no training script or Zig build), skipping"
+            continue
+        fi
+
+        local profile_dir=$(pgo_profile_dir "$tool" "$arch")
+        if [ "${PGO_RETRAIN:-false}" = "true" ] || [ ! -s "$profile_dir/.trained" ]; then
+            if ! pgo_train "$tool" "$arch"; then
+                failed=$((failed + 1))
+                continue
+            fi
+        fi
+
+        export PGO_TOOL="$tool" PGO_PROFILE_DIR="$profile_dir"
+        if ! bench_build_variants "$tool" "$arch" "$work_dir" PGO_MODE off use; then
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local mode base_ms=""
+        for mode in off use; do
+            local binary="$work_dir/$tool.$mode"
+            local result
+            if ! result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$tool" "$arch" "$binary"); then
+                log_tool_error "$BENCH_NAME" "$tool (PGO_MODE=$mode) workload failed on $arch"
+                failed=$((failed + 1))
+                break
+            fi
+            local bytes=${result% *}
+            local ms=${result#* }
+            local speedup="-"
+            if [ "$mode" = "off" ]; then
+                base_ms=$ms
+            else
+                # Faster is positive: the standard time relative to this one
+                speedup=$(awk -v b="$base_ms" -v v="$ms" 'BEGIN { if (v <= 0) { print "-"; exit } printf "%+.1f", (b - v) * 100 / v }')
+            fi
+            bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$tool" "$(pgo_tool_version "$tool")" \
+                "$([ "$mode" = "use" ] && echo pgo || echo standard)" \
+                "$(stat -c %s "$binary")" "$ms" "$(bench_throughput "$bytes" "$ms")" "$speedup"
+        done
+    done
+    unset PGO_TOOL PGO_PROFILE_DIR
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
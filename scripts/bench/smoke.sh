@@ -0,0 +1,372 @@
+#!/bin/bash
+# Execute every static output natively or under qemu-user and catch binaries
+# that cannot run on their target (wrong float ABI, illegal instructions,
+# broken asm paths, crashes, hangs) before they are released.
+#
+# Per binary: a --version/--help style smoke check with exec-to-exit latency.
+# Per arch: loopback functional checks (socat relay, curl file:// and HTTP,
+# busybox applets, tcpdump reading a pcap, openssl digest, microsocks proxy)
+# with throughput. Everything runs offline on 127.0.0.1.
+#
+# Usage: smoke.sh <arch|all> [tool...]
+# Results: $BENCH_DIR/smoke.tsv, plus smoke/smoke_ms rows in the manifest
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/bench_helpers.sh"
+source "$LIB_DIR/manifest.sh"
+
+BENCH_NAME="smoke"
+OUTPUT_ROOT="${STATIC_OUTPUT_DIR:-/build/output}"
+SMOKE_TIMEOUT="${SMOKE_TIMEOUT:-20}"
+SMOKE_SLOW_MS="${SMOKE_SLOW_MS:-3000}"
+PAYLOAD_MB="${PAYLOAD_MB:-16}"
+PCAP_PACKETS=20000
+
+# classify_rc <rc> <output_bytes> - pass/hang/crash/noexec/fail
+classify_rc() {
+    local rc=$1
+    local output_bytes=$2
+
+    if [ "$rc" -eq 124 ]; then
+        echo "hang"
+    elif [ "$rc" -ge 128 ]; then
+        echo "crash"
+    elif [ "$rc" -ge 125 ]; then
+        echo "noexec"
+    elif [ "$rc" -eq 0 ] || [ "$output_bytes" -gt 0 ]; then
+        # Usage text with a non-zero exit is fine for --help
+        echo "pass"
+    else
+        echo "fail"
+    fi
+}
+
+# smoke_binary <arch> <entry> <tool> <libc> - returns 1 on failure
+smoke_binary() {
+    local arch=$1
+    local entry=$2
+    local tool=$3
+    local libc=$4
+    local binary="$OUTPUT_ROOT/$arch/$entry"
+    local args=$(bench_version_args "$tool")
+
+    if [ "$args" = "skip" ]; then
+        bench_record "$BENCH_NAME" "$arch" "$libc" "$tool" "exec" "skipped" "-" "-"
+        return 0
+    fi
+
+    local out="$BENCH_WORK_DIR/smoke.out"
+    local start=$(bench_now_ms)
+    RUN_TIMEOUT="$SMOKE_TIMEOUT" run_target "$arch" "$binary" $args > "$out" 2>&1 < /dev/null
+    local rc=$?
+    local ms=$(( $(bench_now_ms) - start ))
+
+    local status=$(classify_rc "$rc" "$(stat -c %s "$out")")
+    if [ "$status" = "pass" ] && [ "$ms" -gt "$SMOKE_SLOW_MS" ]; then
+        status="slow"
+    fi
+
+    bench_record "$BENCH_NAME" "$arch" "$libc" "$tool" "exec $args" "$status" "$ms" "-"
+    manifest_set "$arch" "$entry" smoke "$status"
+    manifest_set "$arch" "$entry" smoke_ms "$ms"
+
+    case "$status" in
+        pass) return 0 ;;
+        slow)
+            log_tool_warn "$arch" "$entry took ${ms}ms for '$args'"
+            return 0
+            ;;
+        *)
+            log_tool_error "$arch" "$entry: $status (rc=$rc) running '$args'"
+            head -n 5 "$out" | sed 's/^/    /' >&2
+            return 1
+            ;;
+    esac
+}
+
+# Functional checks: print "<bytes> <ms>" on success, return 1 on failure
+
+check_socat_relay() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local port=$(bench_free_port)
+    local received="$BENCH_WORK_DIR/socat.recv"
+
+    rm -f "$received"
+    run_target "$arch" "$binary" -u "TCP-LISTEN:$port,bind=127.0.0.1,reuseaddr" \
+        "CREATE:$received" >/dev/null 2>&1 &
+    local listener=$!
+    if ! bench_wait_port "$port" 30; then
+        bench_stop "$listener"
+        return 1
+    fi
+
+    local ms
+    ms=$(bench_time_ms run_target "$arch" "$binary" -u "OPEN:$payload,rdonly" "TCP:127.0.0.1:$port")
+    local rc=$?
+    wait "$listener" 2>/dev/null
+    bench_stop "$listener"
+
+    [ $rc -eq 0 ] && cmp -s "$payload" "$received" || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+check_curl_file() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local received="$BENCH_WORK_DIR/curl-file.recv"
+
+    local ms
+    ms=$(bench_time_ms run_target "$arch" "$binary" -s -o "$received" "file://$payload") || return 1
+    cmp -s "$payload" "$received" || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+check_curl_http() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local received="$BENCH_WORK_DIR/curl-http.recv"
+    local port=$(bench_free_port)
+    local server
+
+    server=$(bench_start_http_server "$(dirname "$payload")" "$port") || return 1
+    local ms
+    ms=$(bench_time_ms run_target "$arch" "$binary" -s -o "$received" \
+        "http://127.0.0.1:$port/$(basename "$payload")")
+    local rc=$?
+    bench_stop "$server"
+
+    [ $rc -eq 0 ] && cmp -s "$payload" "$received" || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+check_busybox_applets() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local expected=$(sha256sum "$payload" | cut -d' ' -f1)
+
+    local start=$(bench_now_ms)
+    local result
+    result=$(run_target "$arch" "$binary" sh -c "
+        [ \"\$(echo hello | sed s/hello/ok/)\" = ok ] || exit 1
+        [ \"\$(printf '3\n1\n2\n' | sort -n | tr -d '\n')\" = 123 ] || exit 1
+        gzip -c '$payload' | gunzip -c | sha256sum
+    " 2>/dev/null) || return 1
+    local ms=$(( $(bench_now_ms) - start ))
+
+    [ "${result%% *}" = "$expected" ] || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+check_tcpdump_pcap() {
+    local arch=$1
+    local binary=$2
+    local pcap=$3
+    local out="$BENCH_WORK_DIR/tcpdump.out"
+
+    local start=$(bench_now_ms)
+    run_target "$arch" "$binary" -nn -r "$pcap" > "$out" 2>/dev/null || return 1
+    local ms=$(( $(bench_now_ms) - start ))
+
+    [ "$(wc -l < "$out")" -eq "$PCAP_PACKETS" ] || return 1
+    echo "$(stat -c %s "$pcap") $ms"
+}
+
+check_openssl_digest() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local expected=$(sha256sum "$payload" | cut -d' ' -f1)
+
+    local start=$(bench_now_ms)
+    local result
+    result=$(run_target "$arch" "$binary" dgst -sha256 -r "$payload" 2>/dev/null) || return 1
+    local ms=$(( $(bench_now_ms) - start ))
+
+    [ "${result%% *}" = "$expected" ] || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+check_microsocks_proxy() {
+    local arch=$1
+    local binary=$2
+    local payload=$3
+    local received="$BENCH_WORK_DIR/socks.recv"
+    local http_port=$(bench_free_port)
+    local socks_port=$(bench_free_port)
+    local server proxy
+
+    server=$(bench_start_http_server "$(dirname "$payload")" "$http_port") || return 1
+    run_target "$arch" "$binary" -i 127.0.0.1 -p "$socks_port" >/dev/null 2>&1 &
+    proxy=$!
+    if ! bench_wait_port "$socks_port" 30; then
+        bench_stop "$server" "$proxy"
+        return 1
+    fi
+
+    local ms
+    ms=$(bench_time_ms curl -s -o "$received" --socks5 "127.0.0.1:$socks_port" \
+        "http://127.0.0.1:$http_port/$(basename "$payload")")
+    local rc=$?
+    bench_stop "$server" "$proxy"
+
+    [ $rc -eq 0 ] && cmp -s "$payload" "$received" || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+# run_functional <arch> <entry> <tool> <libc> <check_fn> <input>
+run_functional() {
+    local arch=$1
+    local entry=$2
+    local tool=$3
+    local libc=$4
+    local check=$5
+    local input=$6
+    local name="${check#check_}"
+
+    local result
+    if result=$(RUN_TIMEOUT=$((SMOKE_TIMEOUT * 6)) $check "$arch" "$OUTPUT_ROOT/$arch/$entry" "$input"); then
+        local bytes=${result% *}
+        local ms=${result#* }
+        bench_record "$BENCH_NAME" "$arch" "$libc" "$tool" "$name" "pass" "$ms" \
+            "$(bench_throughput "$bytes" "$ms")"
+        manifest_set "$arch" "$entry" "check_$name" pass
+        return 0
+    fi
+
+    bench_record "$BENCH_NAME" "$arch" "$libc" "$tool" "$name" "fail" "-" "-"
+    manifest_set "$arch" "$entry" "check_$name" fail
+    log_tool_error "$arch" "$entry: functional check '$name' failed"
+    return 1
+}
+
+# is_shared_library <path> - a library installed next to a tool (e.g.
+# gdbserver-ipa's libinproctrace.so): named like one, or an ELF shared
+# object with a SONAME. Static-PIE executables are ET_DYN too but have none.
+is_shared_library() {
+    local path=$1
+    local readelf=$(get_cross_binutil readelf)
+
+    case "${path##*/}" in
+        *.so|*.so.*) return 0 ;;
+    esac
+    [ -f "$path" ] || return 1
+    $readelf -h "$path" 2>/dev/null | grep -q 'Type: *DYN' || return 1
+    $readelf -d "$path" 2>/dev/null | grep -q '(SONAME)'
+}
+
+# list_entries <arch> - "<entry> <tool> <libc>" for every runnable output
+list_entries() {
+    local arch=$1
+    local arch_dir="$OUTPUT_ROOT/$arch"
+
+    find "$arch_dir" -path "$arch_dir/shared" -prune -o \( -type f -o -type l \) -print | sort | \
+    while IFS= read -r path; do
+        local entry="${path#$arch_dir/}"
+        case "$entry" in
+            manifest.tsv|*.exe) continue ;;
+        esac
+        is_shared_library "$path" && continue
+        local top="${entry%%/*}"
+        local libc="${top##*.}"
+        local tool
+        if [[ "$entry" == */* ]]; then
+            tool="${entry##*/}"
+        else
+            tool="${top%.*}"
+        fi
+        echo "$entry $tool $libc"
+    done
+}
+
+test_arch() {
+    local arch=$1
+    shift
+    local filter=" $* "
+    local failed=0
+
+    if ! can_run_arch "$arch"; then
+        log_tool_warn "$arch" "No native support or qemu-user emulator, skipping"
+        return 0
+    fi
+
+    local payload="$BENCH_WORK_DIR/payload-${PAYLOAD_MB}m.bin"
+    local pcap="$BENCH_WORK_DIR/smoke.pcap"
+    bench_make_payload "$payload" "$PAYLOAD_MB"
+    bench_make_pcap "$pcap" "$PCAP_PACKETS"
+
+    local runner=$(get_target_runner "$arch")
+    log_tool "$arch" "Running smoke tests (${runner:-native})"
+
+    local entry tool libc
+    while read -r entry tool libc; do
+        local suite="${entry%%/*}"
+        suite="${suite%.*}"
+        if [ "$filter" != "  " ] && [[ "$filter" != *" $tool "* ]] && [[ "$filter" != *" $suite "* ]]; then
+            continue
+        fi
+
+        smoke_binary "$arch" "$entry" "$tool" "$libc" || { failed=$((failed + 1)); continue; }
+
+        local check="" input="$payload"
+        case "$tool" in
+            socat|socat-ssl)        check=check_socat_relay ;;
+            curl|curl-full)         check=check_curl_file ;;
+            busybox|busybox_nodrop) check=check_busybox_applets ;;
+            tcpdump)                check=check_tcpdump_pcap; input="$pcap" ;;
+            openssl)                check=check_openssl_digest ;;
+            microsocks*)            check=check_microsocks_proxy ;;
+        esac
+        if [ -n "$check" ]; then
+            run_functional "$arch" "$entry" "$tool" "$libc" "$check" "$input" || failed=$((failed + 1))
+        fi
+        if [ "$check" = "check_curl_file" ]; then
+            run_functional "$arch" "$entry" "$tool" "$libc" check_curl_http "$payload" || failed=$((failed + 1))
+        fi
+    done < <(list_entries "$arch")
+
+    if [ $failed -gt 0 ]; then
+        log_tool_error "$arch" "$failed smoke/functional checks failed"
+    else
+        log_tool "$arch" "All smoke checks passed"
+    fi
+    return $failed
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture|all> [tool...]" "$@"
+
+    local arch_arg=$1
+    shift
+
+    local archs=()
+    if [ "$arch_arg" = "all" ]; then
+        local dir
+        for dir in "$OUTPUT_ROOT"/*/; do
+            [ -d "$dir" ] && archs+=("$(basename "$dir")")
+        done
+    else
+        archs=("$(map_arch_name "$arch_arg")")
+    fi
+
+    bench_init "$BENCH_NAME" arch libc tool check status ms mb_per_s
+
+    local arch failed=0
+    for arch in "${archs[@]}"; do
+        [ -d "$OUTPUT_ROOT/$arch" ] || continue
+        test_arch "$arch" "$@" || failed=$((failed + 1))
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    [ $failed -eq 0 ]
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
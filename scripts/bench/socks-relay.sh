@@ -0,0 +1,180 @@
+#!/bin/bash
+# Stock microsocks (thread per client) vs microsocks-epoll (one epoll loop,
+# splice relay) on loopback:
+#
+#   - tunnels: how many of SOCKS_CONNS concurrent CONNECT tunnels the proxy
+#     establishes and relays a byte through
+#   - RSS of the proxy idle and with every tunnel held open, and the
+#     difference per tunnel. Pipe buffers are kernel memory and do not show
+#     up in RSS; under qemu-user the RSS includes the emulator itself.
+#   - throughput of one bulk download through the proxy (host curl)
+#
+# Usage: socks-relay.sh <arch>
+# Results: $BENCH_DIR/socks-relay.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="socks-relay"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+SOCKS_CONNS="${SOCKS_CONNS:-1000}"
+VARIANTS="microsocks microsocks-epoll"
+
+# hold_tunnels <socks_port> <count> <ready_file> - open count tunnels to a
+# local listener through the proxy, write how many work to ready_file and
+# keep them open until ready_file is removed
+hold_tunnels() {
+    python3 - "$@" << 'TUNNELS_EOF'
+import os, resource, socket, struct, sys, time
+
+port, count, ready = int(sys.argv[1]), int(sys.argv[2]), sys.argv[3]
+soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+target = socket.socket()
+target.bind(("127.0.0.1", 0))
+target.listen(count)
+request = b"\x05\x01\x00\x01" + socket.inet_aton("127.0.0.1") + struct.pack(">H", target.getsockname()[1])
+
+held = []
+for _ in range(count):
+    try:
+        c = socket.create_connection(("127.0.0.1", port), timeout=10)
+        c.sendall(b"\x05\x01\x00")
+        if c.recv(2) != b"\x05\x00":
+            break
+        c.sendall(request)
+        reply = c.recv(10)
+        if len(reply) < 2 or reply[1] != 0:
+            break
+        peer, _ = target.accept()
+        c.sendall(b"x")
+        if peer.recv(1) != b"x":
+            break
+        held.append((c, peer))
+    except OSError:
+        break
+
+with open(ready + ".tmp", "w") as f:
+    f.write("%d\n" % len(held))
+os.rename(ready + ".tmp", ready)
+deadline = time.time() + 300
+while os.path.exists(ready) and time.time() < deadline:
+    time.sleep(0.1)
+TUNNELS_EOF
+}
+
+# proxy_rss_kb <socks_port> - VmRSS of the proxy listening on the port (the
+# largest match, so the timeout wrapper is skipped)
+proxy_rss_kb() {
+    local port=$1
+    local pid best=0
+
+    for pid in $(pgrep -f -- "-p $port\$"); do
+        local rss=$(awk '/^VmRSS:/ { print $2 }' "/proc/$pid/status" 2>/dev/null)
+        [ -n "$rss" ] && [ "$rss" -gt "$best" ] && best=$rss
+    done
+    echo "$best"
+}
+
+# tunnel_run <arch> <binary> - print "<tunnels> <idle_rss_kb> <loaded_rss_kb>"
+tunnel_run() {
+    local arch=$1
+    local binary=$2
+    local port=$(bench_free_port)
+    local ready="$BENCH_WORK_DIR/$BENCH_NAME.ready"
+
+    rm -f "$ready"
+    RUN_TIMEOUT=900 run_target "$arch" "$binary" -q -i 127.0.0.1 -p "$port" >/dev/null 2>&1 &
+    local proxy=$!
+    if ! bench_wait_port "$port" 30; then
+        bench_stop "$proxy"
+        return 1
+    fi
+    sleep 0.5
+    local idle=$(proxy_rss_kb "$port")
+
+    hold_tunnels "$port" "$SOCKS_CONNS" "$ready" &
+    local holder=$!
+    local waited=0
+    while [ ! -f "$ready" ]; do
+        sleep 0.2
+        waited=$((waited + 1))
+        if [ $waited -ge 3000 ] || ! kill -0 "$holder" 2>/dev/null; then
+            bench_stop "$holder" "$proxy"
+            return 1
+        fi
+    done
+    local loaded=$(proxy_rss_kb "$port")
+    local tunnels=$(cat "$ready")
+
+    rm -f "$ready"
+    wait "$holder" 2>/dev/null
+    bench_stop "$proxy"
+    echo "$tunnels $idle $loaded"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch variant tunnels rss_idle_kb rss_loaded_kb kb_per_tunnel best_ms mb_per_s
+    bench_prepare_workloads
+
+    local variant failed=0
+    for variant in $VARIANTS; do
+        local binary=$(get_output_path "$arch" "$variant")
+        if [ ! -s "$binary" ]; then
+            log_tool "$BENCH_NAME" "$variant not built for $arch, building it first..."
+            build_tool "$variant" "$arch" >/dev/null 2>&1 || {
+                log_tool_error "$BENCH_NAME" "Failed to build $variant for $arch"
+                failed=$((failed + 1))
+                continue
+            }
+        fi
+
+        log_tool "$BENCH_NAME" "Holding $SOCKS_CONNS tunnels through $variant on $arch..."
+        local result
+        if ! result=$(tunnel_run "$arch" "$binary"); then
+            log_tool_error "$BENCH_NAME" "$variant tunnel run failed on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+        local tunnels idle loaded
+        read -r tunnels idle loaded <<< "$result"
+        local per_tunnel=$(awk -v i="$idle" -v l="$loaded" -v n="$tunnels" \
+            'BEGIN { if (n > 0) printf "%.1f", (l - i) / n; else print "-" }')
+        [ "$tunnels" -lt "$SOCKS_CONNS" ] && \
+            log_tool_warn "$BENCH_NAME" "$variant held only $tunnels of $SOCKS_CONNS tunnels"
+
+        log_tool "$BENCH_NAME" "Bulk transfer through $variant on $arch..."
+        local ms="-" rate="-"
+        if result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$variant" "$arch" "$binary"); then
+            ms=${result#* }
+            rate=$(bench_throughput "${result% *}" "$ms")
+        else
+            log_tool_error "$BENCH_NAME" "$variant transfer failed on $arch"
+            failed=$((failed + 1))
+        fi
+
+        bench_record "$BENCH_NAME" "$arch" "$variant" "$tunnels" "$idle" "$loaded" \
+            "$per_tunnel" "$ms" "$rate"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
@@ -0,0 +1,177 @@
+#!/bin/bash
+# dropbear bulk throughput on loopback, default vs throughput profile
+# (DROPBEAR_PROFILE in build-dropbear.sh), per cipher:
+#
+#   - stream: the payload piped through a session channel into a remote
+#     "cat > /dev/null", which is the data path scp uses. scp itself is not
+#     run because its server side would need the target scp on dropbear's
+#     fixed session PATH.
+#   - forward: host curl downloads the payload through a dbclient -L local
+#     port forward
+#
+# Both dropbear and dbclient run on the target (qemu-user unless native).
+# Logs in as the current user with a throwaway key added to its
+# authorized_keys for the duration of the run.
+#
+# Usage: ssh-throughput.sh <arch>
+# Results: $BENCH_DIR/ssh-throughput.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="ssh-throughput"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+SSH_CIPHERS="${SSH_CIPHERS:-chacha20-poly1305@openssh.com aes128-ctr aes128-gcm@openssh.com aes256-gcm@openssh.com}"
+PROFILES="default throughput"
+
+AUTH_KEYS=""
+AUTH_KEYS_BACKUP=""
+
+# authorize_key <pubkey_line> - add a key to the current user's
+# authorized_keys; restore_authorized_keys undoes it
+authorize_key() {
+    local home=$(getent passwd "$(id -un)" | cut -d: -f6)
+    AUTH_KEYS="${home:-$HOME}/.ssh/authorized_keys"
+
+    mkdir -p "$(dirname "$AUTH_KEYS")"
+    chmod 700 "$(dirname "$AUTH_KEYS")"
+    if [ -f "$AUTH_KEYS" ]; then
+        AUTH_KEYS_BACKUP="$BENCH_WORK_DIR/$BENCH_NAME.authorized_keys"
+        cp -p "$AUTH_KEYS" "$AUTH_KEYS_BACKUP"
+    fi
+    echo "$1" >> "$AUTH_KEYS"
+    chmod 600 "$AUTH_KEYS"
+}
+
+restore_authorized_keys() {
+    [ -n "$AUTH_KEYS" ] || return 0
+    if [ -n "$AUTH_KEYS_BACKUP" ]; then
+        mv "$AUTH_KEYS_BACKUP" "$AUTH_KEYS"
+    else
+        rm -f "$AUTH_KEYS"
+    fi
+    AUTH_KEYS=""
+}
+
+# dbclient_run <arch> <dir> <profile> <port> <cipher> <args...>
+dbclient_run() {
+    local arch=$1
+    local dir=$2
+    local profile=$3
+    local port=$4
+    local cipher=$5
+    shift 5
+
+    RUN_TIMEOUT=600 run_target "$arch" "$dir/dbclient.$profile" -y -y -i "$dir/client_key" \
+        -p "$port" -c "$cipher" "$@"
+}
+
+# stream_run <arch> <dir> <profile> <port> <cipher> - print "<bytes> <ms>"
+stream_run() {
+    local payload="$BENCH_WORK_DIR/workload.bin"
+    local ms
+
+    ms=$(bench_time_ms dbclient_run "$@" "$(id -un)@127.0.0.1" "cat > /dev/null" \
+        < "$payload" 2>/dev/null) || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+# forward_run <arch> <dir> <profile> <port> <cipher> - print "<bytes> <ms>"
+forward_run() {
+    local payload="$BENCH_WORK_DIR/workload.bin"
+    local http_port=$(bench_free_port)
+    local fwd_port=$(bench_free_port)
+    local server tunnel ms
+
+    server=$(bench_start_http_server "$BENCH_WORK_DIR" "$http_port") || return 1
+    dbclient_run "$@" -N -L "$fwd_port:127.0.0.1:$http_port" "$(id -un)@127.0.0.1" \
+        >/dev/null 2>&1 &
+    tunnel=$!
+    if ! bench_wait_port "$fwd_port" 60; then
+        bench_stop "$server" "$tunnel"
+        return 1
+    fi
+
+    ms=$(bench_time_ms curl -s -o /dev/null "http://127.0.0.1:$fwd_port/${payload##*/}")
+    local rc=$?
+    bench_stop "$server" "$tunnel"
+    [ $rc -eq 0 ] || return 1
+    echo "$(stat -c %s "$payload") $ms"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch profile cipher mode dropbear_bytes best_ms mb_per_s
+    bench_prepare_workloads
+
+    local dir="$BENCH_WORK_DIR/$BENCH_NAME/$arch"
+    mkdir -p "$dir"
+
+    BENCH_VARIANT_OUTPUTS="dbclient dropbearkey" \
+        bench_build_variants dropbear "$arch" "$dir" DROPBEAR_PROFILE $PROFILES || return 1
+
+    rm -f "$dir/host_key" "$dir/client_key"
+    run_target "$arch" "$dir/dropbearkey.default" -t ed25519 -f "$dir/host_key" >/dev/null 2>&1
+    local pubkey=$(run_target "$arch" "$dir/dropbearkey.default" -t ed25519 -f "$dir/client_key" 2>/dev/null \
+        | grep '^ssh-ed25519 ')
+    if [ -z "$pubkey" ] || [ ! -s "$dir/host_key" ]; then
+        log_tool_error "$BENCH_NAME" "dropbearkey failed on $arch"
+        return 1
+    fi
+    authorize_key "$pubkey"
+    trap restore_authorized_keys EXIT
+
+    local profile failed=0
+    for profile in $PROFILES; do
+        local port=$(bench_free_port)
+        RUN_TIMEOUT=3600 run_target "$arch" "$dir/dropbear.$profile" -F -E -s \
+            -r "$dir/host_key" -P "$dir/dropbear.pid" -p "127.0.0.1:$port" \
+            > "$dir/dropbear.$profile.log" 2>&1 &
+        local server=$!
+        if ! bench_wait_port "$port" 30; then
+            log_tool_error "$BENCH_NAME" "dropbear ($profile) did not start on $arch"
+            bench_stop "$server"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local cipher mode
+        for cipher in $SSH_CIPHERS; do
+            for mode in stream forward; do
+                log_tool "$BENCH_NAME" "$profile: $mode with $cipher on $arch..."
+                local result
+                if ! result=$(bench_best_of "$BENCH_RUNS" "${mode}_run" "$arch" "$dir" "$profile" "$port" "$cipher"); then
+                    # Expected for GCM on the default profile, which lacks it
+                    log_tool_warn "$BENCH_NAME" "$profile: $mode with $cipher failed (cipher not built in?)"
+                    bench_record "$BENCH_NAME" "$arch" "$profile" "$cipher" "$mode" \
+                        "$(stat -c %s "$dir/dropbear.$profile")" "-" "-"
+                    continue
+                fi
+                local ms=${result#* }
+                bench_record "$BENCH_NAME" "$arch" "$profile" "$cipher" "$mode" \
+                    "$(stat -c %s "$dir/dropbear.$profile")" "$ms" "$(bench_throughput "${result% *}" "$ms")"
+            done
+        done
+        bench_stop "$server"
+    done
+
+    restore_authorized_keys
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
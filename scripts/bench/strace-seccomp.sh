@@ -0,0 +1,108 @@
+#!/bin/bash
+# Syscall throughput of a busy process traced by the built strace, with and
+# without the seccomp-bpf fast path. The workload is dd copying /dev/zero to
+# /dev/null one byte at a time (a read and a write per byte); strace only
+# traces openat, so with --seccomp-bpf the kernel lets every read/write run
+# without stopping the tracee, while plain ptrace stops on each of them.
+#
+# Native only: qemu-user cannot ptrace, so on anything but x86 hosts
+# running x86 builds the numbers would be meaningless.
+#
+# Usage: strace-seccomp.sh <arch>
+# Results: $BENCH_DIR/strace-seccomp.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/dependency_builder.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="strace-seccomp"
+# Bytes dd copies; about two syscalls each
+STRACE_SYSCALL_BYTES="${STRACE_SYSCALL_BYTES:-200000}"
+STRACE_RUNS="${STRACE_RUNS:-3}"
+STRACE_TRACE_SET="${STRACE_TRACE_SET:-openat}"
+
+# workload_run <strace|-> <mode> - one timed dd run; prints "<syscalls> <ms>"
+workload_run() {
+    local binary=$1
+    local mode=$2
+    local cmd=(dd if=/dev/zero of=/dev/null bs=1 count="$STRACE_SYSCALL_BYTES")
+
+    case "$mode" in
+        untraced) ;;
+        ptrace)   cmd=("$binary" -f -e trace="$STRACE_TRACE_SET" -o /dev/null "${cmd[@]}") ;;
+        seccomp)  cmd=("$binary" -f --seccomp-bpf -e trace="$STRACE_TRACE_SET" -o /dev/null "${cmd[@]}") ;;
+    esac
+
+    local ms
+    ms=$(bench_time_ms "${cmd[@]}") || return 1
+    echo "$((STRACE_SYSCALL_BYTES * 2)) $ms"
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture>" "$@"
+
+    local arch=$(map_arch_name "$1")
+    export LIBC_TYPE="${LIBC_TYPE:-musl}"
+
+    if ! is_native_arch "$arch"; then
+        log_error "$BENCH_NAME needs a native build (x86_64 on this host); qemu-user cannot ptrace"
+        return 1
+    fi
+
+    local binary=$(get_output_path "$arch" "strace")
+    if [ ! -s "$binary" ]; then
+        log_tool "$BENCH_NAME" "strace not built for $arch, building it first..."
+        build_tool strace "$arch" >/dev/null 2>&1 || {
+            log_error "Failed to build strace for $arch"
+            return 1
+        }
+    fi
+
+    # A tracer that cannot attach would make every mode look like "untraced"
+    if ! "$binary" -f -e trace=execve -o /dev/null true >/dev/null 2>&1; then
+        log_error "strace cannot ptrace here (container needs CAP_SYS_PTRACE / seccomp=unconfined)"
+        return 1
+    fi
+
+    local seccomp_warning
+    seccomp_warning=$("$binary" -f --seccomp-bpf -e trace=execve -o /dev/null true 2>&1 | grep -m1 seccomp)
+    if [ -n "$seccomp_warning" ]; then
+        log_tool_warn "$BENCH_NAME" "Filter not attached, seccomp row will match ptrace: $seccomp_warning"
+    fi
+
+    bench_init "$BENCH_NAME" arch libc mode trace_set syscalls ms syscalls_per_s slowdown
+    log_tool "$BENCH_NAME" "$arch: dd bs=1 count=$STRACE_SYSCALL_BYTES, best of $STRACE_RUNS, tracing $STRACE_TRACE_SET"
+
+    local mode base_ms="" failed=0
+    for mode in untraced ptrace seccomp; do
+        local result
+        if ! result=$(bench_best_of "$STRACE_RUNS" workload_run "$binary" "$mode"); then
+            log_tool_error "$BENCH_NAME" "Workload failed in $mode mode on $arch"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        local syscalls ms
+        read -r syscalls ms <<< "$result"
+        [ "$ms" -gt 0 ] || ms=1
+        [ -n "$base_ms" ] || base_ms=$ms
+
+        local rate=$(awk -v n="$syscalls" -v ms="$ms" 'BEGIN { printf "%.0f", n * 1000 / ms }')
+        local slowdown=$(awk -v a="$ms" -v b="$base_ms" 'BEGIN { printf "%.1f", a / b }')
+        local trace_set=$STRACE_TRACE_SET
+        [ "$mode" = "untraced" ] && trace_set="-"
+
+        bench_record "$BENCH_NAME" "$arch" "$LIBC_TYPE" "$mode" "$trace_set" \
+            "$syscalls" "$ms" "$rate" "$slowdown"
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
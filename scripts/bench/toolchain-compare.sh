@@ -0,0 +1,121 @@
+#!/bin/bash
+# Compare the GCC toolchain with zig cc and its bundled musl (--toolchain
+# zig) on one Linux arch: build time, binary size and workload throughput
+# of each tool built both ways. A tool is first built once per backend so
+# its dependencies are cached, then rebuilt under the clock, so build_ms
+# is the tool's own configure, compile and link. Zig's libc and
+# compiler-rt come from its cache (./build --download warms it).
+#
+# The size and speed columns are relative to the GCC row of the same tool:
+# +3.1 means 3.1% bigger, or 3.1% faster.
+#
+# Usage: toolchain-compare.sh <arch> [tool...]
+# Results: $BENCH_DIR/toolchain-compare.tsv
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/bench_helpers.sh"
+
+BENCH_NAME="toolchain-compare"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+DEFAULT_TOOLS="busybox curl tcpdump socat openssl"
+TOOLCHAINS="gcc zig"
+
+# timed_build <tool> <arch> <toolchain> - rebuild a tool with one backend
+# (building it untimed first when it has never been built); prints the
+# build time in ms
+timed_build() {
+    local tool=$1
+    local arch=$2
+    local toolchain=$3
+    local script="${TOOL_SCRIPTS[$tool]}"
+    local binary=$(TOOLCHAIN_BACKEND=$toolchain get_output_path "$arch" "$tool")
+
+    if [ ! -s "$binary" ]; then
+        (export TOOLCHAIN_BACKEND=$toolchain; build_tool "$tool" "$arch") >/dev/null 2>&1 || return 1
+    fi
+
+    local ms
+    ms=$(bench_time_ms env TOOLCHAIN_BACKEND="$toolchain" SKIP_IF_EXISTS=false \
+        bash "$script" "$arch") || return 1
+    [ -s "$binary" ] || return 1
+    echo "$ms"
+}
+
+# pct_delta <value> <base> - percent difference, one decimal, signed
+pct_delta() {
+    awk -v v="$1" -v b="$2" 'BEGIN { if (b <= 0) { print "-"; exit } printf "%+.1f", (v - b) * 100 / b }'
+}
+
+main() {
+    validate_args 1 "Usage: $0 <architecture> [tool...]" "$@"
+
+    local arch=$(map_arch_name "$1")
+    shift
+    local tools="${*:-$DEFAULT_TOOLS}"
+
+    export LIBC_TYPE="musl"
+
+    if [ -z "$(get_zig_linux_target "$arch")" ]; then
+        log_error "Zig does not cover $arch (no zig_target in ARCH_CONFIG)"
+        return 1
+    fi
+    if ! can_run_arch "$arch"; then
+        log_error "Cannot execute $arch binaries on this host (no native support or qemu-user)"
+        return 1
+    fi
+
+    bench_init "$BENCH_NAME" arch tool toolchain build_ms size_bytes workload_ms mb_per_s size_vs_gcc speed_vs_gcc
+    bench_prepare_workloads
+
+    local tool toolchain failed=0
+    for tool in $tools; do
+        local gcc_size="" gcc_ms=""
+        for toolchain in $TOOLCHAINS; do
+            local build_ms
+            log "[bench] Building $tool for $arch with $toolchain..."
+            if ! build_ms=$(timed_build "$tool" "$arch" "$toolchain"); then
+                log_tool_error "$BENCH_NAME" "$tool failed to build with $toolchain for $arch"
+                bench_record "$BENCH_NAME" "$arch" "$tool" "$toolchain" "-" "-" "-" "-" "-" "-"
+                failed=$((failed + 1))
+                continue
+            fi
+
+            local binary=$(TOOLCHAIN_BACKEND=$toolchain get_output_path "$arch" "$tool")
+            local size=$(stat -c %s "$binary")
+            local ms="-" rate="-" result
+            if result=$(bench_best_of "$BENCH_RUNS" bench_tool_workload "$tool" "$arch" "$binary"); then
+                local bytes=${result% *}
+                ms=${result#* }
+                [ "$bytes" -gt 0 ] && rate=$(bench_throughput "$bytes" "$ms")
+            else
+                log_tool_warn "$BENCH_NAME" "$tool ($toolchain) workload failed on $arch"
+                failed=$((failed + 1))
+            fi
+
+            local size_delta="-" speed_delta="-"
+            if [ "$toolchain" = "gcc" ]; then
+                gcc_size=$size
+                gcc_ms=$ms
+            else
+                [ -n "$gcc_size" ] && size_delta=$(pct_delta "$size" "$gcc_size")
+                # Faster is positive: the GCC time relative to this one
+                if [ -n "$gcc_ms" ] && [ "$gcc_ms" != "-" ] && [ "$ms" != "-" ]; then
+                    speed_delta=$(pct_delta "$gcc_ms" "$ms")
+                fi
+            fi
+
+            bench_record "$BENCH_NAME" "$arch" "$tool" "$toolchain" "$build_ms" \
+                "$size" "$ms" "$rate" "$size_delta" "$speed_delta"
+        done
+    done
+
+    log_tool "$BENCH_NAME" "Results: $BENCH_DIR/$BENCH_NAME.tsv"
+    return $failed
+}
+
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    main "$@"
+fi
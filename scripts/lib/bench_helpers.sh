@@ -0,0 +1,373 @@
+#!/bin/bash
+# Shared helpers for the measurement scripts in scripts/bench/.
+# Results are appended as tab-separated rows to $BENCH_DIR/<bench>.tsv so
+# runs across archs and builds can be compared with sort/awk.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+source "$(dirname "${BASH_SOURCE[0]}")/qemu_runner.sh"
+
+BENCH_DIR="${BENCH_DIR:-/build/logs/bench}"
+BENCH_WORK_DIR="${BENCH_WORK_DIR:-/tmp/sthenos-bench}"
+
+bench_now_ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+# bench_time_ms <cmd...> - run a command with output discarded and print the
+# wall-clock time in milliseconds. Returns the command's exit status.
+bench_time_ms() {
+    local start=$(bench_now_ms)
+    "$@" >/dev/null 2>&1
+    local rc=$?
+    echo $(( $(bench_now_ms) - start ))
+    return $rc
+}
+
+# bench_throughput <bytes> <ms> - MB/s with two decimals
+bench_throughput() {
+    local bytes=$1
+    local ms=$2
+    awk -v b="$bytes" -v ms="$ms" 'BEGIN { if (ms <= 0) ms = 1; printf "%.2f", (b / 1048576) / (ms / 1000) }'
+}
+
+# bench_init <bench> <column...> - create the result file with a header row
+bench_init() {
+    local bench=$1
+    shift
+    local result_file="$BENCH_DIR/${bench}.tsv"
+
+    mkdir -p "$BENCH_DIR" "$BENCH_WORK_DIR"
+    if [ ! -s "$result_file" ]; then
+        (IFS=$'\t'; echo "date	$*") > "$result_file"
+    fi
+}
+
+# bench_record <bench> <value...> - append one result row
+bench_record() {
+    local bench=$1
+    shift
+    local result_file="$BENCH_DIR/${bench}.tsv"
+
+    (IFS=$'\t'; echo "$(date '+%Y-%m-%dT%H:%M:%S')	$*") >> "$result_file"
+    (IFS=' '; log "[bench:$bench] $*")
+}
+
+# bench_make_payload <path> <size_mb> - random payload, reused between runs
+bench_make_payload() {
+    local path=$1
+    local size_mb=$2
+    local size=$((size_mb * 1048576))
+
+    if [ -f "$path" ] && [ "$(stat -c %s "$path")" -eq "$size" ]; then
+        return 0
+    fi
+    mkdir -p "$(dirname "$path")"
+    head -c "$size" /dev/urandom > "$path"
+}
+
+# bench_make_pcap <path> <packets> - synthetic Ethernet/IPv4 TCP+UDP capture
+# (with DNS and HTTP payloads so tcpdump's dissectors have real work to do)
+bench_make_pcap() {
+    local path=$1
+    local packets=${2:-100000}
+
+    if [ -s "$path" ]; then
+        return 0
+    fi
+    mkdir -p "$(dirname "$path")"
+
+    python3 - "$path" "$packets" << 'PCAP_EOF'
+import struct, sys
+
+path, count = sys.argv[1], int(sys.argv[2])
+
+def csum(data):
+    if len(data) % 2:
+        data += b"\0"
+    s = sum(struct.unpack("!%dH" % (len(data) // 2), data))
+    s = (s >> 16) + (s & 0xffff)
+    s += s >> 16
+    return ~s & 0xffff
+
+def ipv4(proto, src, dst, payload):
+    hdr = struct.pack("!BBHHHBBH4s4s", 0x45, 0, 20 + len(payload), 1, 0, 64,
+                      proto, 0, bytes(src), bytes(dst))
+    return hdr[:10] + struct.pack("!H", csum(hdr)) + hdr[12:] + payload
+
+dns = (b"\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00"
+       b"\x07example\x03com\x00\x00\x01\x00\x01")
+http = (b"GET /firmware.bin HTTP/1.1\r\nHost: mirror.local\r\n"
+        b"User-Agent: sthenos-bench\r\nAccept: */*\r\n\r\n")
+
+with open(path, "wb") as f:
+    f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+    for i in range(count):
+        src = [10, 0, (i >> 8) & 0xff, i & 0xff]
+        dst = [10, 1, 0, 1]
+        if i % 2:
+            udp = struct.pack("!HHHH", 1024 + i % 50000, 53, 8 + len(dns), 0) + dns
+            ip = ipv4(17, src, dst, udp)
+        else:
+            tcp = struct.pack("!HHIIBBHHH", 1024 + i % 50000, 80, i, 0,
+                              0x50, 0x18, 65535, 0, 0) + http
+            ip = ipv4(6, src, dst, tcp)
+        frame = b"\x02\x00\x00\x00\x00\x01\x02\x00\x00\x00\x00\x02\x08\x00" + ip
+        f.write(struct.pack("<IIII", i // 1000, (i % 1000) * 1000, len(frame), len(frame)))
+        f.write(frame)
+PCAP_EOF
+}
+
+# bench_free_port - print an unused TCP port on 127.0.0.1
+bench_free_port() {
+    python3 -c 'import socket; s = socket.socket(); s.bind(("127.0.0.1", 0)); print(s.getsockname()[1]); s.close()'
+}
+
+# bench_wait_port <port> [timeout_s] - wait until something listens on the
+# port. Reads /proc/net/tcp rather than connecting, so one-shot listeners
+# (socat -u TCP-LISTEN) don't consume their only connection on the probe.
+bench_wait_port() {
+    local port=$1
+    local timeout_s=${2:-30}
+    local port_hex=$(printf '%04X' "$port")
+    local waited=0
+
+    while ! awk -v p=":$port_hex" '$2 ~ p "$" && $4 == "0A" { found = 1 } END { exit !found }' \
+            /proc/net/tcp /proc/net/tcp6 2>/dev/null; do
+        sleep 0.2
+        waited=$((waited + 1))
+        if [ $waited -ge $((timeout_s * 5)) ]; then
+            return 1
+        fi
+    done
+    return 0
+}
+
+# bench_start_http_server <dir> <port> - serve a directory on 127.0.0.1;
+# prints the server PID
+bench_start_http_server() {
+    local dir=$1
+    local port=$2
+
+    python3 -m http.server --bind 127.0.0.1 --directory "$dir" "$port" >/dev/null 2>&1 &
+    local pid=$!
+    if ! bench_wait_port "$port" 10; then
+        kill "$pid" 2>/dev/null
+        log_error "HTTP server failed to start on port $port"
+        return 1
+    fi
+    echo "$pid"
+}
+
+# bench_stop <pid...> - stop background jobs, including the timeout/qemu
+# children that run_target leaves behind a backgrounded function call
+bench_stop() {
+    local pid
+    for pid in "$@"; do
+        [ -n "$pid" ] || continue
+        pkill -TERM -P "$pid" 2>/dev/null
+        kill "$pid" 2>/dev/null
+    done
+    return 0
+}
+
+# bench_version_args <tool> - arguments that make a tool print its version or
+# usage and exit. "skip" for programs that act immediately (connect back,
+# bind a port) whatever they are given.
+bench_version_args() {
+    local tool=$1
+
+    case "$tool" in
+        shell-*|bcmserver|canlogserver)     echo "skip" ;;
+        strace|ltrace|dropbear|socat*)      echo "-V" ;;
+        tinyproxy|screen)                   echo "-v" ;;
+        openssl)                            echo "version" ;;
+        bash|curl*|ncat*|nmap|gdbserver*|tcpdump|ply)
+                                            echo "--version" ;;
+        *)                                  echo "--help" ;;
+    esac
+}
+
+# bench_prepare_workloads - create the shared inputs bench_tool_workload uses
+bench_prepare_workloads() {
+    bench_make_payload "$BENCH_WORK_DIR/workload.bin" "${PAYLOAD_MB:-64}"
+    bench_make_pcap "$BENCH_WORK_DIR/workload.pcap" 200000
+}
+
+# bench_tool_workload <tool> <arch> <binary> - run one representative,
+# loopback-only workload for a tool and print "<bytes> <ms>"
+bench_tool_workload() {
+    local tool=$1
+    local arch=$2
+    local binary=$3
+    local payload="$BENCH_WORK_DIR/workload.bin"
+    local pcap="$BENCH_WORK_DIR/workload.pcap"
+    local ms
+
+    case "$tool" in
+        socat|socat-ssl)
+            ms=$(bench_time_ms run_target "$arch" "$binary" -u -b 131072 \
+                "OPEN:$payload,rdonly" "GOPEN:/dev/null") || return 1
+            echo "$(stat -c %s "$payload") $ms"
+            ;;
+        tcpdump)
+            ms=$(bench_time_ms run_target "$arch" "$binary" -nn -vvv -r "$pcap") || return 1
+            echo "$(stat -c %s "$pcap") $ms"
+            ;;
+        openssl)
+            ms=$(bench_time_ms run_target "$arch" "$binary" dgst -sha256 "$payload") || return 1
+            echo "$(stat -c %s "$payload") $ms"
+            ;;
+        curl|curl-full)
+            local port=$(bench_free_port)
+            local server_pid
+            server_pid=$(bench_start_http_server "$BENCH_WORK_DIR" "$port") || return 1
+            ms=$(bench_time_ms run_target "$arch" "$binary" -s -o /dev/null \
+                "http://127.0.0.1:$port/${payload##*/}")
+            local rc=$?
+            bench_stop "$server_pid"
+            [ $rc -eq 0 ] || return 1
+            echo "$(stat -c %s "$payload") $ms"
+            ;;
+        ncat|ncat-ssl)
+            local port=$(bench_free_port)
+            local listener
+            run_target "$arch" "$binary" -l --recv-only 127.0.0.1 "$port" >/dev/null 2>&1 &
+            listener=$!
+            if ! bench_wait_port "$port" 30; then
+                bench_stop "$listener"
+                return 1
+            fi
+            ms=$(bench_time_ms run_target "$arch" "$binary" --send-only 127.0.0.1 "$port" < "$payload")
+            local rc=$?
+            wait "$listener" || rc=1
+            [ $rc -eq 0 ] || return 1
+            echo "$(stat -c %s "$payload") $ms"
+            ;;
+        microsocks|microsocks-epoll)
+            # Host curl drives the transfer; only the proxy runs on the target
+            local http_port=$(bench_free_port)
+            local socks_port=$(bench_free_port)
+            local server_pid proxy_pid
+            server_pid=$(bench_start_http_server "$BENCH_WORK_DIR" "$http_port") || return 1
+            run_target "$arch" "$binary" -i 127.0.0.1 -p "$socks_port" >/dev/null 2>&1 &
+            proxy_pid=$!
+            if ! bench_wait_port "$socks_port" 30; then
+                bench_stop "$server_pid" "$proxy_pid"
+                return 1
+            fi
+            ms=$(bench_time_ms curl -s -o /dev/null --socks5 "127.0.0.1:$socks_port" \
+                "http://127.0.0.1:$http_port/${payload##*/}")
+            local rc=$?
+            bench_stop "$server_pid" "$proxy_pid"
+            [ $rc -eq 0 ] || return 1
+            echo "$(stat -c %s "$payload") $ms"
+            ;;
+        bash)
+            # String building, substitution and associative arrays (malloc heavy)
+            ms=$(bench_time_ms run_target "$arch" "$binary" -c '
+                declare -A seen; s=""
+                for ((i = 0; i < 20000; i++)); do
+                    w="w${i}x"; s+="$w"; seen[$w]=${w//x/y}; (( i % 500 )) || t=${s//x/y}
+                done; echo ${#t} ${#seen[@]}') || return 1
+            echo "0 $ms"
+            ;;
+        busybox|busybox_nodrop)
+            ms=$(bench_time_ms run_target "$arch" "$binary" sh -c \
+                "seq 1 300000 | sort -r | sed 's/1/one/g' | gzip -c | gunzip -c | md5sum") || return 1
+            echo "0 $ms"
+            ;;
+        nmap)
+            # List scan with no DNS and no packets sent: target parsing and
+            # host-group bookkeeping only
+            ms=$(bench_time_ms run_target "$arch" "$binary" -n -sL 10.0.0.0/14) || return 1
+            echo "0 $ms"
+            ;;
+        *)
+            log_error "No workload defined for $tool"
+            return 1
+            ;;
+    esac
+}
+
+# bench_build_variants <tool> <arch> <work_dir> <var> <value...> - build a
+# tool once per value of an environment variable (OPT_PROFILE, MALLOC_IMPL,
+# ...) and stash each binary as <work_dir>/<tool>.<value>, leaving whatever
+# was in output/ before untouched. Tools that install several binaries list
+# the others in BENCH_VARIANT_OUTPUTS (e.g. "dbclient scp"); they are stashed
+# the same way. Needs tools.sh for build_tool.
+bench_build_variants() {
+    local tool=$1
+    local arch=$2
+    local work_dir=$3
+    local var=$4
+    shift 4
+    local outputs="$tool ${BENCH_VARIANT_OUTPUTS:-}"
+    local output_path=$(get_output_path "$arch" "$tool")
+    local name
+
+    for name in $outputs; do
+        local path=$(get_output_path "$arch" "$name")
+        rm -f "$work_dir/$name.orig"
+        [ -f "$path" ] && cp "$path" "$work_dir/$name.orig"
+    done
+
+    local value rc=0
+    for value in "$@"; do
+        log "[bench] Building $tool ($var=$value) for $arch..."
+        if (export "$var=$value" SKIP_IF_EXISTS=false; build_tool "$tool" "$arch") >/dev/null 2>&1 \
+            && [ -s "$output_path" ]; then
+            for name in $outputs; do
+                cp "$(get_output_path "$arch" "$name")" "$work_dir/$name.$value" || rc=1
+            done
+        else
+            log_error "Build of $tool ($var=$value) failed for $arch"
+            rc=1
+        fi
+        [ $rc -eq 0 ] || break
+    done
+
+    for name in $outputs; do
+        local path=$(get_output_path "$arch" "$name")
+        if [ -f "$work_dir/$name.orig" ]; then
+            mv "$work_dir/$name.orig" "$path"
+        else
+            rm -f "$path"
+        fi
+    done
+    return $rc
+}
+
+# bench_best_of <runs> <cmd...> - fastest of several runs of a command that
+# prints "<bytes> <ms>"
+bench_best_of() {
+    local runs=$1
+    shift
+    local best_ms="" bytes="" result run
+
+    for run in $(seq 1 "$runs"); do
+        result=$("$@") || return 1
+        bytes=${result% *}
+        local ms=${result#* }
+        if [ -z "$best_ms" ] || [ "$ms" -lt "$best_ms" ]; then
+            best_ms=$ms
+        fi
+    done
+    echo "$bytes $best_ms"
+}
+
+export -f bench_now_ms
+export -f bench_time_ms
+export -f bench_throughput
+export -f bench_init
+export -f bench_record
+export -f bench_make_payload
+export -f bench_make_pcap
+export -f bench_free_port
+export -f bench_wait_port
+export -f bench_start_http_server
+export -f bench_stop
+export -f bench_version_args
+export -f bench_prepare_workloads
+export -f bench_tool_workload
+export -f bench_build_variants
+export -f bench_best_of
@@ -247,6 +247,15 @@ create_build_dir() {
     local tool_name=$1
     local arch=$2
     local build_dir="/tmp/${tool_name}-build-${arch}-$$"
+
+    # GCC names each .gcda after its object's full path, so the instrumented
+    # and the optimized build of a PGO run must share the directory
+    case "${PGO_MODE:-}" in
+        generate|use)
+            build_dir="/tmp/${tool_name}-build-${arch}-pgo"
+            rm -rf "$build_dir"
+            ;;
+    esac
     
     mkdir -p "$build_dir"
     echo "$build_dir"
@@ -277,6 +286,10 @@ install_binary() {
         return 1
     fi
 
+    if type save_symbol_sizes >/dev/null 2>&1; then
+        save_symbol_sizes "$source_file" "$arch" "$dest_name"
+    fi
+
     # Try to strip the binary, but don't fail if it doesn't work (e.g., Windows PE)
     if ! $STRIP "$source_file" 2>/dev/null; then
         log_tool_warn "$tool_name" "Could not strip binary for $arch (may be cross-platform binary)"
@@ -395,10 +408,16 @@ get_binary_size() {
 }
 
 get_libc_suffix() {
+    local arch=${1:-}
+
     # Zig targets use their bundled libc (Darwin libSystem, BSD libc, etc.),
     # not musl or glibc. Force "zig" suffix regardless of LIBC_TYPE to avoid
-    # mislabelling outputs as .musl/.glibc on non-Linux targets.
-    if [ "${USE_ZIG:-0}" = "1" ]; then
+    # mislabelling outputs as .musl/.glibc on non-Linux targets. Linux
+    # arches built with --toolchain zig get it too, so they sit next to the
+    # GCC build instead of replacing it; given the arch, that holds before
+    # setup_arch has run.
+    if [ "${USE_ZIG:-0}" = "1" ] || \
+       { [ -n "$arch" ] && declare -F uses_zig_linux >/dev/null && uses_zig_linux "$arch"; }; then
         echo "zig"
         return
     fi
@@ -428,14 +447,14 @@ get_output_path() {
     if [[ "$arch" == *_windows ]]; then
         ext=".exe"
     fi
-    echo "/build/output/$arch/${tool_name}.$(get_libc_suffix)${ext}"
+    echo "/build/output/$arch/${tool_name}.$(get_libc_suffix "$arch")${ext}"
 }
 
 get_output_dir() {
     local arch=$1
     local tool_name=$2
     # For directory-based tools (can-utils, shell), append libc suffix
-    echo "/build/output/$arch/${tool_name}.$(get_libc_suffix)"
+    echo "/build/output/$arch/${tool_name}.$(get_libc_suffix "$arch")"
 }
 
 validate_args() {
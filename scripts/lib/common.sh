@@ -13,6 +13,9 @@ COMMON_DIR="$(dirname "${BASH_SOURCE[0]}")"
 source "$COMMON_DIR/logging.sh"
 source "$COMMON_DIR/core/compile_flags.sh"
 source "$COMMON_DIR/build_helpers.sh"
+source "$COMMON_DIR/size_report.sh"
+source "$COMMON_DIR/support_matrix.sh"
+source "$COMMON_DIR/failure_cache.sh"
 source "$COMMON_DIR/core/architectures.sh"
 source "$COMMON_DIR/core/arch_helper.sh"
 
@@ -34,6 +37,7 @@ declare -A TOOL_SCRIPTS=(
     ["ncat"]="$SCRIPT_DIR/../static/tools/build-ncat.sh"
     ["ncat-ssl"]="$SCRIPT_DIR/../static/tools/build-ncat-ssl.sh"
     ["gdbserver"]="$SCRIPT_DIR/../static/tools/build-gdbserver.sh"
+    ["gdbserver-ipa"]="$SCRIPT_DIR/../static/tools/build-gdbserver-ipa.sh"
     ["nmap"]="$SCRIPT_DIR/../static/tools/build-nmap.sh"
     ["dropbear"]="$SCRIPT_DIR/../static/tools/build-dropbear.sh"
     ["ltrace"]="$SCRIPT_DIR/../static/tools/build-ltrace.sh"
@@ -41,9 +45,12 @@ declare -A TOOL_SCRIPTS=(
     ["can-utils"]="$SCRIPT_DIR/../static/tools/build-can-utils.sh"
     ["shell"]="$SCRIPT_DIR/../static/tools/build-shell-static.sh"
     ["custom"]="$SCRIPT_DIR/../static/tools/build-custom.sh"
+    ["delta"]="$SCRIPT_DIR/../static/tools/build-delta.sh"
+    ["iotrace-read"]="$SCRIPT_DIR/../static/tools/build-iotrace-read.sh"
     ["curl"]="$SCRIPT_DIR/../static/tools/build-curl.sh"
     ["curl-full"]="$SCRIPT_DIR/../static/tools/build-curl-full.sh"
     ["microsocks"]="$SCRIPT_DIR/../static/tools/build-microsocks.sh"
+    ["microsocks-epoll"]="$SCRIPT_DIR/../static/tools/build-microsocks-epoll.sh"
     ["tinyproxy"]="$SCRIPT_DIR/../static/tools/build-tinyproxy.sh"
     ["i2c-tools"]="$SCRIPT_DIR/../static/tools/build-i2c-tools.sh"
     ["spidev-tools"]="$SCRIPT_DIR/../static/tools/build-spidev-tools.sh"
@@ -58,80 +65,80 @@ declare -A SHARED_LIB_SCRIPTS=(
     ["libtlsnoverify"]="$SCRIPT_DIR/../shared/tools/build-tls-noverify.sh"
     ["libdesock"]="$SCRIPT_DIR/../shared/tools/build-libdesock.sh"
     ["libcustom"]="$SCRIPT_DIR/../shared/tools/build-custom-lib.sh"
+    ["libheapprof"]="$SCRIPT_DIR/../shared/tools/build-heapprof.sh"
+    ["libiotrace"]="$SCRIPT_DIR/../shared/tools/build-iotrace.sh"
 )
 
-setup_arch() {
+# get_zig_triple <arch> - Zig target triple for a Zig-style arch name
+# (x86_64_windows -> x86_64-windows-gnu), with the OS's default ABI filled in
+get_zig_triple() {
     local arch=$1
 
-    if is_zig_target "$arch"; then
-        # Zig CC mode
-        export USE_ZIG=1
-        export ZIG_TARGET="$arch"
-
-        # Convert to proper Zig target triple
-        # x86_64_windows -> x86_64-windows
-        # aarch64_macos -> aarch64-macos
-        # We only replace the LAST underscore(s) with dashes
-        local parts=(${arch//_/ })
-        local arch_part="${parts[0]}"
-        if [[ "${parts[0]}" == "x86" ]] && [[ "${parts[1]}" == "64" ]]; then
-            arch_part="x86_64"
-            parts=("${parts[@]:2}")  # Remove first two elements
-        else
-            parts=("${parts[@]:1}")  # Remove first element
-        fi
+    # Convert to proper Zig target triple
+    # x86_64_windows -> x86_64-windows
+    # aarch64_macos -> aarch64-macos
+    # We only replace the LAST underscore(s) with dashes
+    local parts=(${arch//_/ })
+    local arch_part="${parts[0]}"
+    if [[ "${parts[0]}" == "x86" ]] && [[ "${parts[1]}" == "64" ]]; then
+        arch_part="x86_64"
+        parts=("${parts[@]:2}")  # Remove first two elements
+    else
+        parts=("${parts[@]:1}")  # Remove first element
+    fi
 
-        # Join remaining parts with dashes (OS and optional ABI)
-        local os_abi=$(IFS=-; echo "${parts[*]}")
+    # Join remaining parts with dashes (OS and optional ABI)
+    local os_abi=$(IFS=-; echo "${parts[*]}")
 
-        # Source OS targets if available for ABI defaults
-        if [ -f "/build/scripts/lib/core/os_targets.sh" ]; then
-            source "/build/scripts/lib/core/os_targets.sh"
+    # Source OS targets if available for ABI defaults
+    if [ -f "/build/scripts/lib/core/os_targets.sh" ]; then
+        source "/build/scripts/lib/core/os_targets.sh"
 
-            # Get OS name (first part of os_abi)
-            local os_name="${os_abi%%-*}"
+        # Get OS name (first part of os_abi)
+        local os_name="${os_abi%%-*}"
 
-            # Get default ABI if not specified
-            if [ "$os_abi" = "$os_name" ]; then
-                local default_abi=$(get_default_abi "$os_name")
-                if [ -n "$default_abi" ]; then
-                    os_abi="${os_name}-${default_abi}"
-                fi
-            fi
-        else
-            # Fallback: For Windows, default to gnu ABI if not specified
-            if [[ "$os_abi" == "windows" ]]; then
-                os_abi="windows-gnu"
+        # Get default ABI if not specified
+        if [ "$os_abi" = "$os_name" ]; then
+            local default_abi=$(get_default_abi "$os_name")
+            if [ -n "$default_abi" ]; then
+                os_abi="${os_name}-${default_abi}"
             fi
         fi
+    else
+        # Fallback: For Windows, default to gnu ABI if not specified
+        if [[ "$os_abi" == "windows" ]]; then
+            os_abi="windows-gnu"
+        fi
+    fi
 
-        local zig_triple="${arch_part}-${os_abi}"
+    local zig_triple="${arch_part}-${os_abi}"
 
-        # ARM on BSDs requires an explicit -eabi ABI suffix in Zig (e.g.
-        # arm-openbsd-eabi, arm-netbsd-eabi). get_default_abi returns empty
-        # for BSDs, so patch it here when the bare triple would be rejected.
-        if ! zig_has_libc "$zig_triple" && zig_has_libc "${zig_triple}-eabi"; then
-            zig_triple="${zig_triple}-eabi"
-        fi
+    # ARM on BSDs requires an explicit -eabi ABI suffix in Zig (e.g.
+    # arm-openbsd-eabi, arm-netbsd-eabi). get_default_abi returns empty
+    # for BSDs, so patch it here when the bare triple would be rejected.
+    if ! zig_has_libc "$zig_triple" && zig_has_libc "${zig_triple}-eabi"; then
+        zig_triple="${zig_triple}-eabi"
+    fi
 
-        # Validate that Zig has libc support for this target
-        if ! zig_has_libc "$zig_triple"; then
-            log_error "Zig 0.16.0 does not have libc support for target '$zig_triple' (arch: $arch)"
-            log_error "Without bundled libc, system headers (stdio.h, etc.) are unavailable."
-            log_error "Run 'zig targets' and check the .libc section for supported targets."
-            return 1
-        fi
+    echo "$zig_triple"
+}
 
-        # Set up Zig as compiler
-        export CC="zig cc -target $zig_triple"
-        export CXX="zig c++ -target $zig_triple"
-        export AR="zig ar"
-        # GNU libtool invokes `ranlib -t` to touch the archive; Zig's ranlib
-        # rejects the -t flag and aborts `make install` mid-flow (breaking
-        # header installation for libssh2 on OpenBSD etc.). Wrap it to
-        # silently accept and ignore flags we don't recognise.
-        local zig_ranlib_wrapper=/tmp/.zig-ranlib-wrapper.sh
-        cat > "$zig_ranlib_wrapper" << 'WRAPPER_EOF'
+# setup_zig_cc <arch> <zig_triple> - point CC and the binutils at zig for a
+# target (the caller sets USE_ZIG and ZIG_TARGET)
+setup_zig_cc() {
+    local arch=$1
+    local zig_triple=$2
+
+    # Set up Zig as compiler
+    export CC="zig cc -target $zig_triple"
+    export CXX="zig c++ -target $zig_triple"
+    export AR="zig ar"
+    # GNU libtool invokes `ranlib -t` to touch the archive; Zig's ranlib
+    # rejects the -t flag and aborts `make install` mid-flow (breaking
+    # header installation for libssh2 on OpenBSD etc.). Wrap it to
+    # silently accept and ignore flags we don't recognise.
+    local zig_ranlib_wrapper=/tmp/.zig-ranlib-wrapper.sh
+    cat > "$zig_ranlib_wrapper" << 'WRAPPER_EOF'
 #!/bin/bash
 # Filter out flags zig ranlib doesn't support
 args=()
@@ -143,18 +150,18 @@ for a in "$@"; do
 done
 exec zig ranlib "${args[@]}"
 WRAPPER_EOF
-        chmod +x "$zig_ranlib_wrapper"
-        export RANLIB="$zig_ranlib_wrapper"
-
-        # Windows builds (OpenSSL, curl, etc) invoke `windres` to compile .rc
-        # resource files. Zig doesn't ship windres, and MinGW's is not in the
-        # Docker image. The resource data is purely cosmetic (icons, version
-        # info) and not required for static linking, so ship a stub that
-        # produces an empty object file satisfying the Makefile dependency.
-        if [[ "$zig_triple" == *"windows"* ]]; then
-            local zig_windres_wrapper=/tmp/.zig-windres-wrapper.sh
-            # Embed the current triple so the stub object matches the target arch
-            cat > "$zig_windres_wrapper" << WINDRES_EOF
+    chmod +x "$zig_ranlib_wrapper"
+    export RANLIB="$zig_ranlib_wrapper"
+
+    # Windows builds (OpenSSL, curl, etc) invoke `windres` to compile .rc
+    # resource files. Zig doesn't ship windres, and MinGW's is not in the
+    # Docker image. The resource data is purely cosmetic (icons, version
+    # info) and not required for static linking, so ship a stub that
+    # produces an empty object file satisfying the Makefile dependency.
+    if [[ "$zig_triple" == *"windows"* ]]; then
+        local zig_windres_wrapper=/tmp/.zig-windres-wrapper.sh
+        # Embed the current triple so the stub object matches the target arch
+        cat > "$zig_windres_wrapper" << WINDRES_EOF
 #!/bin/bash
 # Emit an empty COFF object at the -o path matching the Zig target arch.
 output=""
@@ -170,22 +177,22 @@ if [ -z "\$output" ]; then
 fi
 echo 'int _windres_stub = 0;' | zig cc -target ${zig_triple} -c -x c -o "\$output" - 2>/dev/null
 WINDRES_EOF
-            chmod +x "$zig_windres_wrapper"
-            # Expose as `windres` on PATH ahead of anything else
-            local wrapper_bin_dir=/tmp/.zig-wrapper-bin
-            mkdir -p "$wrapper_bin_dir"
-            ln -sf "$zig_windres_wrapper" "$wrapper_bin_dir/windres"
-            export PATH="$wrapper_bin_dir:$PATH"
-        fi
-        # Pick a strip that understands the target's object format.
-        # Host GNU `strip` cannot parse Mach-O (macOS) or handle some BSD
-        # variants. `zig objcopy --strip-all` is unimplemented in Zig 0.16 and
-        # truncates its output file before failing, so we always strip to a
-        # temp path and only replace the original on non-empty success — if
-        # stripping fails, the binary stays unstripped rather than zeroed.
-        # The linker's -Wl,--strip-all already handles most cases anyway.
-        local zig_strip_wrapper=/tmp/.zig-strip-wrapper.sh
-        cat > "$zig_strip_wrapper" << 'WRAPPER_EOF'
+        chmod +x "$zig_windres_wrapper"
+        # Expose as `windres` on PATH ahead of anything else
+        local wrapper_bin_dir=/tmp/.zig-wrapper-bin
+        mkdir -p "$wrapper_bin_dir"
+        ln -sf "$zig_windres_wrapper" "$wrapper_bin_dir/windres"
+        export PATH="$wrapper_bin_dir:$PATH"
+    fi
+    # Pick a strip that understands the target's object format.
+    # Host GNU `strip` cannot parse Mach-O (macOS) or handle some BSD
+    # variants. `zig objcopy --strip-all` is unimplemented in Zig 0.16 and
+    # truncates its output file before failing, so we always strip to a
+    # temp path and only replace the original on non-empty success — if
+    # stripping fails, the binary stays unstripped rather than zeroed.
+    # The linker's -Wl,--strip-all already handles most cases anyway.
+    local zig_strip_wrapper=/tmp/.zig-strip-wrapper.sh
+    cat > "$zig_strip_wrapper" << 'WRAPPER_EOF'
 #!/bin/bash
 for f in "$@"; do
     [ -f "$f" ] || continue
@@ -197,32 +204,77 @@ for f in "$@"; do
     fi
 done
 WRAPPER_EOF
-        chmod +x "$zig_strip_wrapper"
-        export STRIP="$zig_strip_wrapper"
-        export LD="zig cc -target $zig_triple"
-
-        # Set CROSS_COMPILE to empty (not needed with Zig)
-        export CROSS_COMPILE=""
-        export HOST="$zig_triple"
-
-        # Use full arch name for output directory (includes OS)
-        mkdir -p /build/output/$arch
-
-        # Set dependency prefix for cache separation
-        export DEPS_PREFIX="zig"
-
-        log_tool "$arch" "Using Zig CC for cross-compilation (target: $zig_triple)" >&2
-
-        if [ "${DEBUG:-0}" = "1" ] || [ "${DEBUG:-0}" = "true" ]; then
-            log "[DEBUG] Zig Configuration for $arch:" >&2
-            log "  ZIG_TARGET: $zig_triple" >&2
-            log "  CC: $CC" >&2
-            log "  CXX: $CXX" >&2
-            log "  AR: $AR" >&2
-            log "  LD: $LD" >&2
-            log "  DEPS_PREFIX: $DEPS_PREFIX" >&2
+    chmod +x "$zig_strip_wrapper"
+    export STRIP="$zig_strip_wrapper"
+    export LD="zig cc -target $zig_triple"
+
+    # Set CROSS_COMPILE to empty (not needed with Zig)
+    export CROSS_COMPILE=""
+    export HOST="$zig_triple"
+
+    # Use full arch name for output directory (includes OS)
+    mkdir -p /build/output/$arch
+
+    # Set dependency prefix for cache separation
+    export DEPS_PREFIX="zig"
+
+    log_tool "$arch" "Using Zig CC for cross-compilation (target: $zig_triple)" >&2
+
+    if [ "${DEBUG:-0}" = "1" ] || [ "${DEBUG:-0}" = "true" ]; then
+        log "[DEBUG] Zig Configuration for $arch:" >&2
+        log "  ZIG_TARGET: $zig_triple" >&2
+        log "  CC: $CC" >&2
+        log "  CXX: $CXX" >&2
+        log "  AR: $AR" >&2
+        log "  LD: $LD" >&2
+        log "  DEPS_PREFIX: $DEPS_PREFIX" >&2
+    fi
+
+    return 0
+}
+
+setup_arch() {
+    local arch=$1
+
+    if is_zig_target "$arch"; then
+        # Zig CC mode
+        export USE_ZIG=1
+        export ZIG_TARGET="$arch"
+
+        # get_zig_triple runs in a subshell; load zig_has_libc here too
+        if [ -f "/build/scripts/lib/core/os_targets.sh" ]; then
+            source "/build/scripts/lib/core/os_targets.sh"
         fi
+        local zig_triple=$(get_zig_triple "$arch")
 
+        # Validate that Zig has libc support for this target
+        if ! zig_has_libc "$zig_triple"; then
+            log_error "Zig 0.16.0 does not have libc support for target '$zig_triple' (arch: $arch)"
+            log_error "Without bundled libc, system headers (stdio.h, etc.) are unavailable."
+            log_error "Run 'zig targets' and check the .libc section for supported targets."
+            return 1
+        fi
+
+        setup_zig_cc "$arch" "$zig_triple"
+        return $?
+    fi
+
+    # Linux on Zig's bundled musl (./build --toolchain zig): same arch name
+    # and output dir as the GCC build, no toolchain download
+    if uses_zig_linux "$arch"; then
+        export USE_ZIG=1
+        export ZIG_TARGET="${arch}_linux"
+
+        local zig_triple=$(get_zig_linux_target "$arch")
+        local zig_cpu=$(get_zig_linux_cpu "$arch")
+        setup_zig_cc "$arch" "$zig_triple" || return 1
+
+        # configure and Kbuild want the GNU names the GCC toolchain has
+        export HOST=$(get_musl_toolchain "$arch")
+        export CFLAGS_ARCH="${zig_cpu:+-mcpu=$zig_cpu}"
+        export CONFIG_ARCH=$(get_config_arch "$arch")
+        export TOOLCHAIN_TYPE="musl"
+        export LIBC_TYPE="musl"
         return 0
     fi
 
@@ -230,6 +282,10 @@ WRAPPER_EOF
     export USE_ZIG=0
     export DEPS_PREFIX="gcc"
 
+    if [ "${TOOLCHAIN_BACKEND:-gcc}" = "zig" ]; then
+        log_tool_warn "$arch" "No Zig coverage for $arch (${LIBC_TYPE:-musl}), using its GCC toolchain" >&2
+    fi
+
     if ! is_valid_arch "$arch"; then
         log_error "Unknown architecture: $arch"
         return 1
@@ -453,6 +509,8 @@ setup_toolchain_for_arch() {
     return $?
 }
 
+export -f get_zig_triple
+export -f setup_zig_cc
 export -f setup_arch
 export -f download_and_extract
 export -f setup_toolchain_for_arch
@@ -77,6 +77,27 @@ is_zig_target() {
     [[ "$arch" == *_* ]]
 }
 
+# Zig's musl triple and CPU (Zig -mcpu syntax: model[+feature...]) for a
+# Linux arch, from zig_target=/zig_cpu= in ARCH_CONFIG. Arches without a
+# zig_target always use their GCC toolchain.
+get_zig_linux_target() {
+    get_arch_field "$1" "zig_target"
+}
+
+get_zig_linux_cpu() {
+    get_arch_field "$1" "zig_cpu"
+}
+
+# Whether a Linux arch builds with zig cc instead of its GCC toolchain:
+# TOOLCHAIN_BACKEND=zig (./build --toolchain zig), a musl build and an arch
+# Zig covers. Glibc and uclibc builds keep their toolchains.
+uses_zig_linux() {
+    local arch="$1"
+    [ "${TOOLCHAIN_BACKEND:-gcc}" = "zig" ] || return 1
+    [ -z "${LIBC_TYPE:-}" ] || [ "${LIBC_TYPE:-}" = "musl" ] || return 1
+    ! is_zig_target "$arch" && [ -n "$(get_zig_linux_target "$arch")" ]
+}
+
 source "$ARCH_HELPER_DIR/../arch_map.sh"
 
 get_musl_toolchain_dir() {
@@ -120,6 +141,9 @@ export -f is_glibc_only_arch
 export -f get_glibc_supported_archs
 export -f is_soft_float_arch
 export -f is_zig_target
+export -f get_zig_linux_target
+export -f get_zig_linux_cpu
+export -f uses_zig_linux
 export -f map_arch_name
 export -f get_musl_toolchain_dir
 export -f get_glibc_toolchain_dir
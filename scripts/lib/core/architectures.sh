@@ -35,6 +35,8 @@ bootlin_url=x86-64--glibc--stable-2024.02-1.tar.bz2
 musl_sha512=52abd1a56e670952116e35d1a62e048a9b6160471d988e16fa0e1611923dd108a581d2e00874af5eb04e4968b1ba32e0eb449a1f15c3e4d5240ebe09caf5a9f3
 cflags=-march=x86-64
 config_arch=x86_64
+zig_target=x86_64-linux-musl
+zig_cpu=x86_64
 bootlin_sha512=02b62c26b3cab277623198dc48d9f1c1f6d12018911acf2d66aafde370c6c40d92ccc58b63255d0726636e39fd659f6430473241508e37ad59fc0bbd74ac4760
 "
 
@@ -46,6 +48,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=x86-64 -mx32 -Wno-error=type-limits
 config_arch=x86_64
+zig_target=x86_64-linux-muslx32
+zig_cpu=x86_64
 musl_sha512=3b4cb87e94ad822934793139653fce216016f5d96309094f46ec152d369d4ad67c5e21b7276f43ff055433c42e7c38a5c0fe6ee0c56e1069729d447e45a2f122
 "
 
@@ -57,6 +61,8 @@ bootlin_arch=x86-i686
 bootlin_url=x86-i686--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=i486
 config_arch=i386
+zig_target=x86-linux-musl
+zig_cpu=i486
 musl_sha512=0a6e508d919d2b5404e53c5bad7ea10924967c4b528012495ecc41ca3f4b371a0da4d814a2a5a18e079b1c330fa808ab0eaa924a3571f3792bcf9004feee856c
 bootlin_sha512=e57a0c0f49917c8dfbc12bb949d3bbc33fd9b824f0cd776c65b10f410c5da128e98f2065ab6053926e32387b252dfee3c9283e32847199c2f68fab804ba9e0c2
 "
@@ -69,6 +75,8 @@ bootlin_arch=x86-i686
 bootlin_url=x86-i686--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=i486 -mno-sse -mno-sse2
 config_arch=i386
+zig_target=x86-linux-musl
+zig_cpu=i486
 musl_sha512=5047afc68170a2910895db2dfa448227e71a984bfa2130a1bc946fd1015d722b80b15e4abf90c64300815aa84fe781cc8b8a72f10174f9dce96169e035911880
 bootlin_sha512=e57a0c0f49917c8dfbc12bb949d3bbc33fd9b824f0cd776c65b10f410c5da128e98f2065ab6053926e32387b252dfee3c9283e32847199c2f68fab804ba9e0c2
 "
@@ -82,6 +90,8 @@ bootlin_url=aarch64--glibc--stable-2024.02-1.tar.bz2
 musl_sha512=8695ff86979cdf30fbbcd33061711f5b1ebc3c48a87822b9ca56cde6d3a22abd4dab30fdcd1789ac27c6febbaeb9e5bde59d79d66552fae53d54cc1377a19272
 cflags=-march=armv8-a
 config_arch=aarch64
+zig_target=aarch64-linux-musl
+zig_cpu=generic
 bootlin_sha512=1122cf6a0d6d8438181942011432c68d63807566117dde2e24171dbac5413dc752f687cd41af6e0557aab66bb89c004f5b246ec7f390fa730f1c0d4726bf4e9a
 "
 
@@ -93,6 +103,8 @@ bootlin_arch=aarch64be
 bootlin_url=aarch64be--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv8-a -mbig-endian
 config_arch=aarch64
+zig_target=aarch64_be-linux-musl
+zig_cpu=generic
 musl_sha512=1196cefffca4ab1add29c0d80bfebeb6a9f0eb2f1dd89f2ba5119af23b7177e2ad7fff21594f7dbfb3c5b0624e0a5f78c1678d12e1604f51c7cecb27ce4bf8b5
 bootlin_sha512=16425c406519b24865b4077ab050805120d9b8fb7ef19d884fb5633af6e2d169a131dfbdde02f5a218e8e13a933b7c6b04e0d109f077790178f475a4f7d65cab
 "
@@ -106,6 +118,8 @@ bootlin_url=armv5-eabi--glibc--stable-2024.02-1.tar.bz2
 musl_sha512=000e9e49a24ad581c2096c52dc28942688c422b8beed8c6b7c46f82029bbebae8e513118a44da36827907e215c6eca543b5d87da762ed6e37ead0a739ef403b7
 cflags=-march=armv5te -marm -mno-unaligned-access
 config_arch=arm
+zig_target=arm-linux-musleabi
+zig_cpu=arm926ej_s+strict_align
 bootlin_sha512=d3b8f0c84ee589a255ec59a6eb51bc02de502c411fa0bac6a1a784e46f01efdc322d32a6a67c7185fb6062ae4b5bd296d265868f86effb8c8d6f9158ff66ed5d
 "
 
@@ -128,6 +142,8 @@ bootlin_arch=armv7-eabihf
 bootlin_url=armv7-eabihf--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv7-a -mfpu=vfpv3-d16 -mfloat-abi=hard -mthumb -mthumb-interwork
 config_arch=arm
+zig_target=arm-linux-musleabihf
+zig_cpu=generic+v7a+vfp3d16+thumb_mode
 musl_sha512=1bb399a61da425faac521df9b8d303e60ad101f6c7827469e0b4bc685ce1f3dedc606ac7b1e8e34d79f762a3bfe3e8ab479a97e97d9f36fbd9fc5dc9d7ed6fd1
 bootlin_sha512=96d35eac687bebea5c6c79cd26280b3fab5f2a5bf105b86d70728a0895b12118e839fcceb9ec2b1e6b3ea2ade9cbd069635709a45ccad4a4ed42f647857e0d18
 "
@@ -140,6 +156,8 @@ bootlin_arch=armv7-eabihf
 bootlin_url=armv7-eabihf--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv7-a -mfpu=neon-vfpv3 -mfloat-abi=hard -mthumb -mthumb-interwork
 config_arch=arm
+zig_target=arm-linux-musleabihf
+zig_cpu=generic+v7a+neon+thumb_mode
 musl_sha512=1bb399a61da425faac521df9b8d303e60ad101f6c7827469e0b4bc685ce1f3dedc606ac7b1e8e34d79f762a3bfe3e8ab479a97e97d9f36fbd9fc5dc9d7ed6fd1
 bootlin_sha512=96d35eac687bebea5c6c79cd26280b3fab5f2a5bf105b86d70728a0895b12118e839fcceb9ec2b1e6b3ea2ade9cbd069635709a45ccad4a4ed42f647857e0d18
 "
@@ -152,6 +170,8 @@ bootlin_arch=armv7-eabihf
 bootlin_url=armv7-eabihf--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv7-a -mfpu=neon-vfpv4 -mfloat-abi=hard -mthumb -mthumb-interwork
 config_arch=arm
+zig_target=arm-linux-musleabihf
+zig_cpu=generic+v7a+neon+vfp4+thumb_mode
 musl_sha512=1bb399a61da425faac521df9b8d303e60ad101f6c7827469e0b4bc685ce1f3dedc606ac7b1e8e34d79f762a3bfe3e8ab479a97e97d9f36fbd9fc5dc9d7ed6fd1
 bootlin_sha512=96d35eac687bebea5c6c79cd26280b3fab5f2a5bf105b86d70728a0895b12118e839fcceb9ec2b1e6b3ea2ade9cbd069635709a45ccad4a4ed42f647857e0d18
 "
@@ -164,6 +184,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=armv5te -mbig-endian
 config_arch=arm
+zig_target=armeb-linux-musleabi
+zig_cpu=arm926ej_s
 musl_sha512=6ad112d169cf7a91e3fb119822598d37c071a21323c34de021daca02f36b5c4cd38fae6ecbdc6768d6dcb97f3ccd871403b154bccf0b62d68d3e802980351797
 "
 
@@ -175,6 +197,8 @@ bootlin_arch=armebv7-eabihf
 bootlin_url=armebv7-eabihf--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv7-a -mbig-endian -mfpu=vfpv3 -mfloat-abi=hard
 config_arch=arm
+zig_target=armeb-linux-musleabihf
+zig_cpu=generic+v7a+vfp3
 musl_sha512=19dd99084f930cce2d3a1b5aa7a411a45c69ecabbcaa282f688b53ffafd5a962900fad80d74846bcc9c2755b0242920da4b689406f4a5ba21359e79d97b12c17
 bootlin_sha512=ce95b0befb77403506184e4df1efb4aa3f2ce27b6e4719faa34df472a02400595336f182d8f1b695c017a49d004d839570978047ea02f0f992dbf55312a219d3
 "
@@ -187,6 +211,8 @@ bootlin_arch=armv6-eabihf
 bootlin_url=armv6-eabihf--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=armv6 -mfpu=vfp -mfloat-abi=hard -mno-unaligned-access
 config_arch=arm
+zig_target=arm-linux-musleabihf
+zig_cpu=arm1176jzf_s+strict_align
 bootlin_sha512=55b8a738aa202efae3906afef870873a678063b3fb77552a331eed6e38147299a720b95f1d7e328e160ebec139a2175c35543c8dc5d68407bea5981fecb1a771
 musl_sha512=bcf47e82ec0c0c620c7b47aeb03355fe3f22d9dd9f719a77e2b21322291e04f7a35d1592275f487db4f754f3aede7f51bb0c2f07c1a3b3ce880b3341ec947bea
 "
@@ -232,6 +258,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=armv4t -marm
 config_arch=arm
+zig_target=arm-linux-musleabi
+zig_cpu=arm7tdmi
 musl_sha512=72d9ca8bca8cb7fb9c7a4ba05b5abd69cd074f76d56bdbf87f0fdab075c62a2babf099db0ad160fa81015778a1f9d9f94a1dfff3b159b7404495e5ee361ec581
 "
 
@@ -254,6 +282,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=armv5te -marm -mno-unaligned-access
 config_arch=arm
+zig_target=arm-linux-musleabi
+zig_cpu=arm926ej_s+strict_align
 musl_sha512=2104a0edb08e2e9696ef8cb8c284705e987031904ede6ed49e8303f942b35886aa656c7dbd52f8a3a67abd0a2ce2eb3fa82eb8414f09dda2ae1df300edfb62db
 "
 
@@ -276,6 +306,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=armv6 -marm -mno-unaligned-access
 config_arch=arm
+zig_target=arm-linux-musleabi
+zig_cpu=arm1176jz_s+strict_align
 musl_sha512=db983f159f79cff134ed3050ab170eb35df79623b63dee974b237acf5bb1f8bb7f1a475126e073922c8a2141eb87593a684b3e364c46505489487f670115d99d
 "
 
@@ -287,6 +319,8 @@ bootlin_arch=mips32
 bootlin_url=mips32--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=mips32 -mabi=32 -EB
 config_arch=mips
+zig_target=mips-linux-musleabihf
+zig_cpu=mips32
 bootlin_sha512=baa68ede5046607f0c4a29853332ca64b867fcbbf426a72af2ac5adcf75a001c4de6ceda9c971dac385a9f65b11590f851c880aab7f92c78a63200580e13fc9e
 musl_sha512=c1b04aaad4b0d24826d087acf93b5ac28b9f87633fd8554b52625f5b9916073d10b16be3fa2eaa9782e35ad9e850921269cb3b78f49cfbe4d2deed3d1a3291c6
 "
@@ -300,6 +334,8 @@ musl_sha512=d0275cade2a6162659a610a41e0be4450b893a8f75a4f67a00cfe358c1e9657b86c4
 bootlin_url=mips32el--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=mips32 -mabi=32
 config_arch=mips
+zig_target=mipsel-linux-musleabihf
+zig_cpu=mips32
 bootlin_sha512=1a73e95735cb80c28291e35aa010f8ba44ec9d3a39585352d249ee9f15467cf70193366c7e283e9614ab1b1aa7e3cab9071708c68268a3423858451ad4eedcc8
 "
 
@@ -311,6 +347,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=mips32 -mabi=32 -EB -msoft-float
 config_arch=mips
+zig_target=mips-linux-musleabi
+zig_cpu=mips32
 musl_sha512=4b598ca2a9ad157d989eceaff05fbf5bc149474e02a12641b41ff1736c18882b5ddfc7be36d225b16235e60908730db38445920874873b426611c4d5506e957a
 "
 
@@ -322,6 +360,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=mips32 -mabi=32 -msoft-float
 config_arch=mips
+zig_target=mipsel-linux-musleabi
+zig_cpu=mips32
 musl_sha512=0d42ee6f9d9fe844875d9031bdfe05cf4cb6e80c7d669452295d1b2d5e14e98a0b59aa4b06be4ac0567dfebdf4bf007fbd62ec29d4b7bf677461e132e54345a8
 "
 
@@ -333,6 +373,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=mips64 -mabi=64
 config_arch=mips64
+zig_target=mips64-linux-muslabi64
+zig_cpu=mips64
 musl_sha512=8ceead53f611b3672c98b4431fd78ec8e25b6e9841f103274d7b2305026e392c61f924ed24afe7a569727099da49cb77e2d1d68353cc0dd165e5d1547b3565d2
 "
 
@@ -344,6 +386,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=mips64 -mabi=64
 config_arch=mips64
+zig_target=mips64el-linux-muslabi64
+zig_cpu=mips64
 musl_sha512=c19f23d947aaf304953a5fa3f677c8ab596e7d3c6fcd212f42e731211bfe757b28b055b2b761c84d932c54eeaba7000ab3c37be23682fb1b291291e30a99b9f8
 "
 
@@ -355,6 +399,8 @@ bootlin_arch=mips64-n32
 bootlin_url=mips64-n32--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=mips64 -mabi=n32
 config_arch=mips64
+zig_target=mips64-linux-muslabin32
+zig_cpu=mips64
 bootlin_sha512=a79b83c6741d12e199733d37a79b0de042bbf9725a31316222f4591bd558e5b1714b89dfda707bae6a43ba9053f844e7425b697485c1527d420856c22a3eea38
 musl_sha512=22383a40902b6830e4202316faa2d18ed07c0b59b95e5cf703477e9535f2f9b703dc9e13624968740b11268160f23d59b82020cb49031be42a9e7667ae9c5064
 "
@@ -367,6 +413,8 @@ bootlin_arch=mips64el-n32
 bootlin_url=mips64el-n32--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=mips64 -mabi=n32
 config_arch=mips64
+zig_target=mips64el-linux-muslabin32
+zig_cpu=mips64
 bootlin_sha512=f0fab26a5e672470501150311d66a5a8b8f0f9e350f03a18ad857e08183bd578c71bd245405ddf927be6bf4c3293e2679f8326adc4ca2caa8c1a4018de82b4e6
 musl_sha512=8a3fcd26e41dd9701ded101bbdbd2fd5a8656348d7025c14f778e2bcca3b44a83cb82bcadb1bbc33d9d8e4a788180df9bbd258945f50b58a353c67397d04bdbc
 "
@@ -380,6 +428,8 @@ bootlin_arch=powerpc-e500mc
 bootlin_url=powerpc-e500mc--glibc--stable-2024.02-1.tar.bz2
 cflags=-mcpu=powerpc -m32 -mno-altivec -mno-vsx
 config_arch=powerpc
+zig_target=powerpc-linux-musleabihf
+zig_cpu=ppc
 bootlin_sha512=ed79f841689af76cc35d9a041d8f5ed63573921b5b87e454f98d5375bf24a88157f690036c792e49a42b9617eceb38c4b57dc9d28964ec2dc6780c031a324954
 musl_sha512=0653252f8406b1f4d6f6a189651855413b5be6112b54606a0f663296059e1d595310f1c25f767c8d44202b7dd04bb4736a60fbd4e533368177401cef0d01dcfe
 "
@@ -392,6 +442,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-mcpu=powerpc -m32 -msoft-float
 config_arch=powerpc
+zig_target=powerpc-linux-musleabi
+zig_cpu=ppc
 musl_sha512=f31630114c8933482f097b091fe0b5a346a45005db23581397b37c23c694bdea47dbc777daeebdfcee6f7dbeac0e400fa3583751fe3fd3d55bdb853aa9496abe
 "
 
@@ -425,6 +477,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-mcpu=power4 -m64
 config_arch=powerpc64
+zig_target=powerpc64-linux-musl
+zig_cpu=pwr4
 musl_sha512=3975cc64530dab6738eb3aacc37f34f8a0d782bf0a1ef1e21da4710c90bb9478afc929b8092bf2df61e92f0994df3eaf15ffaab1c53d3ac296e39dcf6e9c31a8
 "
 
@@ -436,6 +490,8 @@ bootlin_arch=powerpc64le-power8
 bootlin_url=powerpc64le-power8--glibc--stable-2024.02-1.tar.bz2
 cflags=-mcpu=powerpc64le -m64 -mlittle-endian
 config_arch=powerpc64
+zig_target=powerpc64le-linux-musl
+zig_cpu=ppc64le
 bootlin_sha512=346f04c665f85b5e4a1dec58e8385a6786682a320a3c031cb809dfba980259fda956a63134f98516e7b109df2ee8e9fd18925cfbaa0c389adf54e262150047c7
 musl_sha512=68f72b4ff0d0f28094581a4dbd81090f28898c74f5a97cd39d725e2e332aa099eebe71ccab5d7db1646ec443ed6165997eeea42510b918ea7626720e4e78b19c
 "
@@ -448,6 +504,8 @@ bootlin_arch=riscv32-ilp32d
 bootlin_url=riscv32-ilp32d--glibc--stable-2024.05-1.tar.xz
 cflags=-march=rv32gc -mabi=ilp32d
 config_arch=riscv
+zig_target=riscv32-linux-musl
+zig_cpu=baseline_rv32
 bootlin_sha512=5ab3d3533bef4b715138c982e50732db27fea96a5dd28c1a8b2cb3b89462a863010c1d22376600d4144f96f67252237ae690426a40612b39b67a6f4ae17978f4
 musl_sha512=28c85aa4f08419816b93f3775a0339e21f8e6c2c55efca416ed350df1a9f22469ee965c8f8a9ac186aa36411977c375afae39f7224d386b7c032b513833ff90d
 "
@@ -461,6 +519,8 @@ musl_sha512=9fdb9f6077db2e7091fab5fccec875d7f73e901fa8be27a2eae6b40ac6ba35ca789f
 bootlin_url=riscv64-lp64d--glibc--stable-2024.02-1.tar.bz2
 cflags=-march=rv64gc -mabi=lp64d
 config_arch=riscv64
+zig_target=riscv64-linux-musl
+zig_cpu=baseline_rv64
 bootlin_sha512=a43986358d77aeddf8e51213b7a99edc651767f30e80eeb934502416074adb538189fa0342da6b2ea5f48875855ee9028d061005ceb5cdd464365070649cb88c
 "
 
@@ -473,6 +533,8 @@ bootlin_arch=m68k
 bootlin_url=m68k-68xxx--glibc--stable-2024.02-1.tar.bz2
 cflags=-mcpu=68020
 config_arch=m68k
+zig_target=m68k-linux-musl
+zig_cpu=M68020
 bootlin_sha512=2bf9cf1e286b2c567d6524917386180eff81ea4de257492b1c2aa2fa3d500f71ca18df751fda3473db6c6a79819e6aacd593647feb42a6f0533a4a5dd7672e02
 musl_sha512=efaa25090bee6832009c9e0e0bb9812fe2b976cb3ba4f0d59dd290695a95d53291068fac3df4b65e75c0a4e05bc084ba57b6edb8e4236d7a1a46cb9789fb5c2b
 "
@@ -521,6 +583,8 @@ bootlin_arch=s390x-z13
 bootlin_url=s390x-z13--glibc--stable-2024.02-1.tar.bz2
 cflags=
 config_arch=s390x
+zig_target=s390x-linux-musl
+zig_cpu=
 bootlin_sha512=fa638b803147c6d1258e0d9b9d146a27457188764248a8f468a1c47c4fb0ee4324f5633b55949da39761f7a283999af1abba96617e59c9383d12e275b80d1cae
 musl_sha512=8d74962f19faa05ffcbd2ba4717dd554ef782ea72f4f058d6e71b772e4c3adbd80111d86c2c3b4b694c88a177c18b46602a1d7b9b31fd7bf2a696275b15dd980
 "
@@ -633,6 +697,8 @@ bootlin_arch=
 bootlin_url=
 cflags=-march=loongarch64 -mabi=lp64d
 config_arch=loongarch64
+zig_target=loongarch64-linux-musl
+zig_cpu=
 custom_musl_url=https://github.com/loong64/cross-tools/releases/download/20250911/x86_64-cross-tools-loongarch64-unknown-linux-musl-stable.tar.xz
 custom_glibc_url=https://github.com/loong64/cross-tools/releases/download/20250911/x86_64-cross-tools-loongarch64-unknown-linux-gnu-stable.tar.xz
 custom_musl_sha512=f62c0730cf0275bf99e75a228424586bde62dac93fbfb8012f8b6e49b5f93edd65cc1ee4a9ff1a460ce6f2470a32f605d28eb0b12f761a60a4ad4b8daff81065
@@ -669,6 +735,7 @@ get_uclibc_toolchain() { get_arch_field "$1" "uclibc_name"; }
 get_custom_uclibc_url() { get_arch_field "$1" "custom_uclibc_url"; }
 get_custom_uclibc_sha512() { get_arch_field "$1" "custom_uclibc_sha512"; }
 get_toolchain_extract_subdir() { get_arch_field "$1" "toolchain_extract_subdir"; }
+get_string_routines() { get_arch_field "$1" "string_routines"; }
 
 arch_supports_glibc() {
     local arch="$1"
@@ -3,6 +3,42 @@
 source "$(dirname "${BASH_SOURCE[0]}")/arch_helper.sh"
 source "$(dirname "${BASH_SOURCE[0]}")/os_targets.sh"
 
+# Optimization policy per tool/dependency. Everything defaults to "size"
+# (-Os). A tool listed here as "speed" gets -O2 plus
+# -fno-semantic-interposition (add_tool_specific_flags), nothing more.
+# OPT_PROFILE=speed|size (./build --profile) overrides the table for every
+# tool. Only add a tool once `./build --bench opt-profile` has recorded
+# recommended_profile=speed for it in output/<arch>/manifest.tsv.
+if [ -z "${TOOL_OPT_POLICY+x}" ]; then
+    declare -gA TOOL_OPT_POLICY=()
+fi
+
+get_tool_opt_profile() {
+    local tool=${1:-}
+
+    case "${OPT_PROFILE:-}" in
+        speed|size)
+            echo "$OPT_PROFILE"
+            return 0
+            ;;
+    esac
+
+    if [ -n "$tool" ] && [ -n "${TOOL_OPT_POLICY[$tool]:-}" ]; then
+        echo "${TOOL_OPT_POLICY[$tool]}"
+    else
+        echo "size"
+    fi
+}
+
+get_opt_level_flags() {
+    local tool=${1:-}
+
+    case "$(get_tool_opt_profile "$tool")" in
+        speed) echo "-O2" ;;
+        *)     echo "-Os" ;;
+    esac
+}
+
 get_compile_flags() {
     local arch=$1
     local mode=$2
@@ -13,6 +49,7 @@ get_compile_flags() {
     fi
     
     local base_flags=""
+    local opt_flags=$(get_opt_level_flags "$tool")
     
     # _GNU_SOURCE enables glibc/musl GNU extensions (e.g. GNU strerror_r returning char*).
     # Darwin/BSD libc provides the XSI variants instead, so defining _GNU_SOURCE there
@@ -29,7 +66,7 @@ get_compile_flags() {
 
     case "$mode" in
         static)
-            base_flags="-Os $gnu_source_flag"
+            base_flags="$opt_flags $gnu_source_flag"
             base_flags="$base_flags -fno-strict-aliasing -ffunction-sections -fdata-sections"
             base_flags="$base_flags -fvisibility=hidden -fno-ident -fmerge-all-constants"
             base_flags="$base_flags -fno-unwind-tables -fno-asynchronous-unwind-tables"
@@ -57,7 +94,7 @@ get_compile_flags() {
             fi
             ;;
         shared)
-            base_flags="-Os -fPIC $gnu_source_flag"
+            base_flags="$opt_flags -fPIC $gnu_source_flag"
             base_flags="$base_flags -fno-strict-aliasing -ffunction-sections -fdata-sections"
             base_flags="$base_flags -fvisibility=hidden -fno-ident"
             base_flags="$base_flags -Wall"
@@ -69,12 +106,22 @@ get_compile_flags() {
     esac
     
     local arch_flags=$(get_arch_cflags "$arch")
+    # zig cc takes a Zig CPU name, not the GCC -march/-mfpu spelling
+    if [ "${USE_ZIG:-0}" = "1" ] && uses_zig_linux "$arch"; then
+        local zig_cpu=$(get_zig_linux_cpu "$arch")
+        arch_flags="${zig_cpu:+-mcpu=$zig_cpu}"
+    fi
     if [ -n "$arch_flags" ]; then
         base_flags="$base_flags $arch_flags"
     fi
     
     if [ -n "$tool" ]; then
         base_flags="$(add_tool_specific_flags "$tool" "$base_flags")"
+
+        local pgo_flags=$(get_pgo_flags "$tool")
+        if [ -n "$pgo_flags" ]; then
+            base_flags="$base_flags $pgo_flags"
+        fi
     fi
     
     if [ "${DEBUG:-}" = "1" ]; then
@@ -140,6 +187,16 @@ get_link_flags() {
                     link_flags="$link_flags -Wl,--defsym,fmod=__ieee754_fmod -lm"
                     ;;
             esac
+
+            local string_flags=$(get_string_routines_link_flags "$arch")
+            if [ -n "$string_flags" ]; then
+                link_flags="$link_flags $string_flags"
+            fi
+
+            # Pulls in libgcov for the instrumented build of a PGO run
+            if [ "${PGO_MODE:-}" = "generate" ] && [ -n "${PGO_TOOL:-}" ] && [ "${USE_ZIG:-0}" != "1" ]; then
+                link_flags="$link_flags -fprofile-generate"
+            fi
             ;;
             
         shared)
@@ -162,6 +219,49 @@ get_link_flags() {
     echo "$link_flags"
 }
 
+# Profile-guided optimization flags (scripts/lib/pgo.sh). Only the tool
+# being trained (PGO_TOOL) gets them; its dependencies come from the shared
+# cache and stay uninstrumented. Zig builds never get them: zig cc writes
+# LLVM raw profiles that need llvm-profdata.
+get_pgo_flags() {
+    local tool=${1:-}
+    local dir="${PGO_PROFILE_DIR:-}"
+
+    [ -n "$tool" ] && [ "$tool" = "${PGO_TOOL:-}" ] && [ -n "$dir" ] || return 0
+    [ "${USE_ZIG:-0}" = "1" ] && return 0
+
+    case "${PGO_MODE:-}" in
+        generate)
+            # Atomic counters where the arch has them: curl and ncat run
+            # threads, and racy counters make a misleading profile
+            echo "-fprofile-generate=$dir -fprofile-update=prefer-atomic"
+            ;;
+        use)
+            # Code the training never reached keeps its normal optimization
+            # instead of being treated as cold, and functions that changed
+            # since training (other flags, patches) build without a profile
+            echo "-fprofile-use=$dir -fprofile-partial-training -Wno-missing-profile -Wno-coverage-mismatch"
+            ;;
+    esac
+}
+
+# Optimized string/memory routines for the arch (string_routines= in
+# ARCH_CONFIG), prepared by prepare_string_routines in dependency_builder.sh.
+# LDFLAGS come before the objects, so each routine is marked undefined up
+# front to make the linker take it from the archive instead of libc.a.
+get_string_routines_link_flags() {
+    local arch=$1
+    local dir="${STRING_ROUTINES_DIR:-}"
+
+    [ -n "$dir" ] && [[ "$dir" == */"$arch"/* ]] || return 0
+    [ -f "$dir/lib/libstrroutines.a" ] && [ -s "$dir/lib/routines" ] || return 0
+
+    local flags="" name
+    for name in $(cat "$dir/lib/routines"); do
+        flags="$flags -Wl,--undefined=$name"
+    done
+    echo "${flags# } -L$dir/lib -lstrroutines"
+}
 
 add_tool_specific_flags() {
     local tool=$1
@@ -177,6 +277,12 @@ add_tool_specific_flags() {
             flags="${flags/-fvisibility=hidden/}"
             ;;
     esac
+
+    # Speed-profile code is often -fPIC (OpenSSL, shared libs); let GCC
+    # inline and clone across exported functions like it does for non-PIC.
+    if [ "$(get_tool_opt_profile "$tool")" = "speed" ]; then
+        flags="$flags -fno-semantic-interposition"
+    fi
     
     echo "$flags"
 }
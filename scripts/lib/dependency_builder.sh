@@ -8,6 +8,32 @@ source "$SCRIPT_DIR/tools.sh"
 
 DEPS_CACHE_DIR="/build/deps-cache"
 
+# get_dependency_cache_dir <dep> <version> <arch> [cache_tag] - where
+# build_dependency_generic keeps a built dependency
+get_dependency_cache_dir() {
+    local dep_name=$1
+    local version=$2
+    local arch=$3
+    local cache_tag=${4:-}
+
+    # Use DEPS_PREFIX to separate cache by compiler type (gcc/zig)
+    local prefix="${DEPS_PREFIX:-gcc}"
+    local cache_dir="$DEPS_CACHE_DIR/$prefix/$arch/$dep_name-$version"
+
+    # Keep speed-profile builds apart from the default -Os cache entries
+    local opt_profile=$(get_tool_opt_profile "$dep_name")
+    if [ "$opt_profile" != "size" ]; then
+        cache_dir="$cache_dir-$opt_profile"
+    fi
+
+    # Optional build-variant tag (e.g. the OpenSSL Configure target), so a
+    # changed variant never reuses a stale cache entry
+    if [ -n "$cache_tag" ]; then
+        cache_dir="$cache_dir-$cache_tag"
+    fi
+    echo "$cache_dir"
+}
+
 build_dependency_generic() {
     local dep_name=$1
     local version=$2
@@ -18,11 +44,9 @@ build_dependency_generic() {
     local build_func=$7
     local install_func=$8
     local expected_sha512=$9
-    
-    # Use DEPS_PREFIX to separate cache by compiler type (gcc/zig)
-    local prefix="${DEPS_PREFIX:-gcc}"
-    local cache_dir="$DEPS_CACHE_DIR/$prefix/$arch/$dep_name-$version"
-    
+    local cache_tag=${10:-}
+    local cache_dir=$(get_dependency_cache_dir "$dep_name" "$version" "$arch" "$cache_tag")
+
     if $install_func check "$cache_dir"; then
         log_info "Using cached $dep_name $version for $arch from $cache_dir" >&2
         echo "$cache_dir"
@@ -98,6 +122,57 @@ build_dependency_generic() {
     return 0
 }
 
+# OpenSSL Configure target for an arch. Prefer targets with a perlasm
+# flavour so libcrypto gets its assembly AES/GCM/ChaCha20/Poly1305/SHA and
+# bignum paths; SIMD/crypto extensions (NEON, ARMv8 CE, AltiVec, AES-NI)
+# are still probed at runtime, so baseline CPUs keep working. Targets
+# without any 1.1.1 assembly (riscv, sh, m68k, ...) stay on linux-generic*.
+get_openssl_target() {
+    local arch=$1
+
+    # Zig cross-platform targets — OpenSSL's OS-specific Configure names
+    case $arch in
+        x86_64_macos)       echo "darwin64-x86_64-cc" ;;
+        aarch64_macos)      echo "darwin64-arm64-cc" ;;
+        x86_64_freebsd|x86_64_openbsd|x86_64_netbsd)     echo "BSD-x86_64" ;;
+        aarch64_freebsd|aarch64_openbsd|aarch64_netbsd)  echo "BSD-generic64" ;;
+        riscv64_freebsd)    echo "BSD-generic64" ;;
+        x86_64_windows|aarch64_windows) echo "mingw64" ;;
+        x86_64)             echo "linux-x86_64" ;;
+        x86_64_x32)         echo "linux-x32" ;;
+        ix86le|i486)        echo "linux-x86" ;;
+        # Cortex-M/R profiles are Thumb-only — built with no-asm below
+        armv7m|armv7r)      echo "linux-generic32" ;;
+        # armv4 perlasm covers ARMv4T through ARMv7 in ARM or Thumb-2 mode,
+        # either endianness; NEON code is only entered when detected
+        arm*)               echo "linux-armv4" ;;
+        aarch64*)           echo "linux-aarch64" ;;
+        mips64n32*)         echo "linux-mips64" ;;
+        mips64*)            echo "linux64-mips64" ;;
+        mips*)              echo "linux-mips32" ;;
+        ppc64le)            echo "linux-ppc64le" ;;
+        ppc64be)            echo "linux-ppc64" ;;
+        # OpenSSL's 32-bit PowerPC assembly is big-endian only
+        ppc32le*)           echo "linux-generic32" ;;
+        ppc32*)             echo "linux-ppc" ;;
+        sparc64)            echo "linux64-sparcv9" ;;
+        s390x)              echo "linux64-s390x" ;;
+        riscv64|loongarch64) echo "linux-generic64" ;;
+        *)                  echo "linux-generic32" ;;
+    esac
+}
+
+# Archs whose OpenSSL target would pick assembly they can't run: Thumb-only
+# ARM profiles, and aarch64/thumb Windows where mingw64 expects x86_64 asm.
+get_openssl_asm_opt() {
+    local arch=$1
+
+    case "$arch" in
+        armv7m|armv7r) echo "no-asm" ;;
+        aarch64_windows|thumb_windows) echo "no-asm" ;;
+    esac
+}
+
 configure_openssl() {
     local arch=$1
     local build_dir=$2
@@ -106,45 +181,7 @@ configure_openssl() {
     local openssl_cflags=$(echo "$CFLAGS" | sed 's/-fno-pie//g; s/-no-pie//g')
     openssl_cflags="$openssl_cflags -fPIC"
     
-    local openssl_target
-    # Zig cross-platform targets — OpenSSL's OS-specific Configure names
-    case $arch in
-        x86_64_macos)       openssl_target="darwin64-x86_64-cc" ;;
-        aarch64_macos)      openssl_target="darwin64-arm64-cc" ;;
-        x86_64_freebsd|x86_64_openbsd|x86_64_netbsd)     openssl_target="BSD-x86_64" ;;
-        aarch64_freebsd|aarch64_openbsd|aarch64_netbsd)  openssl_target="BSD-generic64" ;;
-        riscv64_freebsd)    openssl_target="BSD-generic64" ;;
-        x86_64_windows|aarch64_windows) openssl_target="mingw64" ;;
-        *)
-            case $arch in
-                x86_64) openssl_target="linux-x86_64" ;;
-                ix86le|i486) openssl_target="linux-x86" ;;
-                armv7m|armv7r)
-                    # Cortex-M/R profiles are Thumb-only — OpenSSL ARM assembly
-                    # assumes full ARM mode, so disable it and use a generic target
-                    openssl_target="linux-generic32"
-                    ;;
-                arm*)
-                    if [[ "$arch" == *"v7"* ]]; then
-                        openssl_target="linux-armv4"
-                    else
-                        openssl_target="linux-generic32"
-                    fi
-                    ;;
-                aarch64*) openssl_target="linux-aarch64" ;;
-                mips64n32*) openssl_target="linux-mips64" ;;
-                mips64*) openssl_target="linux64-mips64" ;;
-                mips*) openssl_target="linux-mips32" ;;
-                ppc64*) openssl_target="linux-ppc64le" ;;
-                ppc32*) openssl_target="linux-ppc" ;;
-                riscv64) openssl_target="linux-generic64" ;;
-                riscv32) openssl_target="linux-generic32" ;;
-                s390x) openssl_target="linux-s390x" ;;
-                sh*) openssl_target="linux-generic32" ;;
-                *) openssl_target="linux-generic32" ;;
-            esac
-            ;;
-    esac
+    local openssl_target=$(get_openssl_target "$arch")
     
     # Save and unset CROSS_COMPILE — OpenSSL's Configure uses it to prefix
     # compiler names, which conflicts with our already-set CC. We restore it
@@ -152,25 +189,13 @@ configure_openssl() {
     local _saved_cross_compile="${CROSS_COMPILE:-}"
     unset CROSS_COMPILE
 
-    # For s390x, we need to use linux64-s390x instead of linux-s390x
-    if [ "$arch" = "s390x" ]; then
-        openssl_target="linux64-s390x"
-    fi
-    
     # Build zlib first if enabling zlib support
     local zlib_dir=$(build_zlib_cached "$arch") || {
         log_error "Failed to build zlib for OpenSSL"
         return 1
     }
 
-    # Disable assembly for Thumb-only ARM profiles (Cortex-M/R) and for
-    # aarch64-windows / thumb-windows where our mingw64 Configure target
-    # expects x86_64 asm.
-    local openssl_asm_opt=""
-    case "$arch" in
-        armv7m|armv7r) openssl_asm_opt="no-asm" ;;
-        aarch64_windows|thumb_windows) openssl_asm_opt="no-asm" ;;
-    esac
+    local openssl_asm_opt=$(get_openssl_asm_opt "$arch")
 
     # riscv32 lacks legacy __NR_io_getevents syscall (only has time64 variants),
     # so the AF_ALG engine won't compile
@@ -262,7 +287,20 @@ build_openssl_cached() {
         configure_openssl \
         build_openssl \
         install_openssl \
-        "$sha512"
+        "$sha512" \
+        "$(get_openssl_target "$arch")"
+}
+
+# Default capture ring for Linux libpcap (used when tcpdump/nmap are not
+# given -B). Upstream requests 2 MB, which busy interfaces overrun.
+LIBPCAP_RING_KB="${LIBPCAP_RING_KB:-4096}"
+
+# libpcap compiles its TPACKET_V3 (block-based PACKET_MMAP) capture path
+# only when the toolchain's <linux/if_packet.h> defines it; otherwise a
+# cross build silently ends up on the V2 per-frame ring.
+check_tpacket_v3_headers() {
+    printf '#include <linux/if_packet.h>\n#ifndef TPACKET3_HDRLEN\n#error no TPACKET_V3\n#endif\n' \
+        | $CC $CFLAGS -E -x c - >/dev/null 2>&1
 }
 
 configure_libpcap() {
@@ -282,6 +320,20 @@ configure_libpcap() {
         *_macos|*_freebsd|*_openbsd|*_netbsd|*_dragonfly) pcap_backend="bpf" ;;
     esac
 
+    if [ "$pcap_backend" = "linux" ]; then
+        if ! check_tpacket_v3_headers; then
+            log_error "Kernel headers for $arch lack TPACKET_V3, libpcap would lose its mmap ring"
+            return 1
+        fi
+
+        if sed -i 's/\(opt\.buffer_size = \)2 *\* *1024 *\* *1024;/\1PCAP_DEFAULT_RING_BYTES;/' pcap-linux.c \
+            && grep -q 'PCAP_DEFAULT_RING_BYTES' pcap-linux.c; then
+            export CFLAGS="$CFLAGS -DPCAP_DEFAULT_RING_BYTES=$((LIBPCAP_RING_KB * 1024))"
+        else
+            log_warn "libpcap default ring size not patched, keeping upstream 2 MB"
+        fi
+    fi
+
     ./configure \
         --host=$HOST \
         --prefix="$cache_dir" \
@@ -330,7 +382,8 @@ build_libpcap_cached() {
         configure_libpcap \
         build_libpcap \
         install_libpcap \
-        "$sha512"
+        "$sha512" \
+        "ring${LIBPCAP_RING_KB}k"
 }
 
 configure_zlib() {
@@ -866,3 +919,427 @@ build_libssh2_cached() {
         install_libssh2 \
         "$sha512"
 }
+
+# HTTP/2 (nghttp2) and zstd content decoding for curl-full, which fails to
+# build without either. Release tarball checksums below; download_source
+# refuses an unpinned source.
+NGHTTP2_VERSION="${NGHTTP2_VERSION:-1.64.0}"
+NGHTTP2_SHA512="${NGHTTP2_SHA512:-}"
+ZSTD_VERSION="${ZSTD_VERSION:-1.5.6}"
+ZSTD_SHA512="${ZSTD_SHA512:-}"
+
+configure_nghttp2() {
+    local arch=$1
+    local build_dir=$2
+    local cache_dir=$3
+
+    export CFLAGS="$CFLAGS -ffunction-sections -fdata-sections"
+
+    # Library only: no nghttpx/h2load (they need libev, c-ares, ...)
+    ./configure \
+        --host=$HOST \
+        --prefix="$cache_dir" \
+        --enable-lib-only \
+        --enable-static \
+        --disable-shared \
+        --disable-dependency-tracking
+}
+
+build_nghttp2() {
+    local arch=$1
+    local build_dir=$2
+
+    parallel_make
+}
+
+install_nghttp2() {
+    local action=$1
+    local cache_dir=$2
+    local build_dir=$3
+
+    if [ "$action" = "check" ]; then
+        [ -f "$cache_dir/lib/libnghttp2.a" ]
+        return $?
+    fi
+
+    make install
+}
+
+build_nghttp2_cached() {
+    local arch=$1
+
+    build_dependency_generic \
+        "nghttp2" \
+        "$NGHTTP2_VERSION" \
+        "https://github.com/nghttp2/nghttp2/releases/download/v$NGHTTP2_VERSION/nghttp2-$NGHTTP2_VERSION.tar.xz" \
+        "nghttp2-$NGHTTP2_VERSION" \
+        "$arch" \
+        configure_nghttp2 \
+        build_nghttp2 \
+        install_nghttp2 \
+        "$NGHTTP2_SHA512"
+}
+
+configure_zstd() {
+    # Plain Makefile build, nothing to configure
+    return 0
+}
+
+build_zstd() {
+    local arch=$1
+    local build_dir=$2
+    local zstd_cflags="$CFLAGS -ffunction-sections -fdata-sections"
+
+    # The x86-64 Huffman decoder assembly assumes LP64
+    if [ "$arch" = "x86_64_x32" ]; then
+        zstd_cflags="$zstd_cflags -DZSTD_DISABLE_ASM"
+    fi
+
+    # Legacy (pre-v0.8) frame support is dead weight for content decoding
+    CFLAGS="$zstd_cflags" make -C lib -j$(nproc) libzstd.a \
+        CC="$CC" AR="$AR" ZSTD_LEGACY_SUPPORT=0
+}
+
+install_zstd() {
+    local action=$1
+    local cache_dir=$2
+    local build_dir=$3
+
+    if [ "$action" = "check" ]; then
+        [ -f "$cache_dir/lib/libzstd.a" ]
+        return $?
+    fi
+
+    make -C lib install-static install-includes install-pc PREFIX="$cache_dir"
+}
+
+build_zstd_cached() {
+    local arch=$1
+
+    build_dependency_generic \
+        "zstd" \
+        "$ZSTD_VERSION" \
+        "https://github.com/facebook/zstd/releases/download/v$ZSTD_VERSION/zstd-$ZSTD_VERSION.tar.gz" \
+        "zstd-$ZSTD_VERSION" \
+        "$arch" \
+        configure_zstd \
+        build_zstd \
+        install_zstd \
+        "$ZSTD_SHA512"
+}
+
+# Allocator per tool. musl's malloc trades speed for size and hardening,
+# which shows in tools that allocate per packet, host or transfer. nmap,
+# tcpdump and curl-full can link mimalloc in its place on musl static
+# builds; MALLOC_IMPL=mimalloc or musl (./build --malloc) selects it for
+# all three. The table is empty until MIMALLOC_SHA512 is pinned and
+# `./build --bench malloc-stress` has measured a gain for a tool.
+if [ -z "${TOOL_MALLOC_POLICY+x}" ]; then
+    declare -gA TOOL_MALLOC_POLICY=()
+fi
+
+MIMALLOC_VERSION="${MIMALLOC_VERSION:-2.1.7}"
+# sha512sum of the release tarball (URL in build_mimalloc_cached). Unset,
+# a tool that asks for mimalloc fails to build.
+MIMALLOC_SHA512="${MIMALLOC_SHA512:-}"
+
+get_tool_malloc() {
+    local tool=${1:-}
+
+    case "${MALLOC_IMPL:-}" in
+        mimalloc|musl)
+            echo "$MALLOC_IMPL"
+            return 0
+            ;;
+    esac
+
+    if [ -n "$tool" ] && [ -n "${TOOL_MALLOC_POLICY[$tool]:-}" ]; then
+        echo "${TOOL_MALLOC_POLICY[$tool]}"
+    else
+        echo "musl"
+    fi
+}
+
+# mimalloc reserves address space in 4 MiB segments and relies on lazy
+# page commit; no-MMU targets would have to back every segment with
+# contiguous physical memory. m68k and microblaze are attempted like any
+# other arch and fall back to musl malloc if the library does not build.
+arch_supports_mimalloc() {
+    local arch=$1
+
+    case "$arch" in
+        sh2|sh2eb|armv7m|armv7r) return 1 ;;
+    esac
+    return 0
+}
+
+configure_mimalloc() {
+    # Built as a single translation unit, nothing to configure
+    return 0
+}
+
+build_mimalloc() {
+    local arch=$1
+    local build_dir=$2
+
+    # MI_MALLOC_OVERRIDE defines malloc/free/calloc/realloc/posix_memalign/...
+    # so musl's allocator is never pulled from libc.a. Statistics and debug
+    # checks are compiled out.
+    $CC $CFLAGS -std=gnu11 -DNDEBUG -DMI_MALLOC_OVERRIDE -DMI_LIBC_MUSL=1 \
+        -DMI_DEBUG=0 -DMI_STAT=0 -Iinclude -c src/static.c -o mimalloc.o && \
+    $AR rcs libmimalloc.a mimalloc.o
+}
+
+install_mimalloc() {
+    local action=$1
+    local cache_dir=$2
+    local build_dir=$3
+
+    if [ "$action" = "check" ]; then
+        [ -f "$cache_dir/lib/libmimalloc.a" ]
+        return $?
+    fi
+
+    mkdir -p "$cache_dir/lib" "$cache_dir/include"
+    cp libmimalloc.a "$cache_dir/lib/" && cp include/mimalloc.h "$cache_dir/include/"
+}
+
+build_mimalloc_cached() {
+    local arch=$1
+
+    build_dependency_generic \
+        "mimalloc" \
+        "$MIMALLOC_VERSION" \
+        "https://github.com/microsoft/mimalloc/archive/refs/tags/v$MIMALLOC_VERSION.tar.gz" \
+        "mimalloc-$MIMALLOC_VERSION" \
+        "$arch" \
+        configure_mimalloc \
+        build_mimalloc \
+        install_mimalloc \
+        "$MIMALLOC_SHA512"
+}
+
+# get_malloc_link_flags <arch> <tool> - extra LDFLAGS that replace musl's
+# malloc for tools opted in via TOOL_MALLOC_POLICY; empty (musl malloc)
+# otherwise or when the allocator is unavailable for the arch.
+get_malloc_link_flags() {
+    local arch=$1
+    local tool=$2
+
+    [ "$(get_tool_malloc "$tool")" = "mimalloc" ] || return 0
+    [ "${LIBC_TYPE:-}" = "musl" ] || return 0
+    [ "${USE_ZIG:-0}" != "1" ] || return 0
+
+    if ! arch_supports_mimalloc "$arch"; then
+        log_tool "$tool" "No MMU on $arch, keeping musl malloc"
+        return 0
+    fi
+
+    if [ -z "$MIMALLOC_SHA512" ]; then
+        log_tool_error "$tool" "mimalloc requested but MIMALLOC_SHA512 is not pinned"
+        return 1
+    fi
+
+    local mimalloc_dir
+    mimalloc_dir=$(build_mimalloc_cached "$arch") || {
+        log_tool_warn "$tool" "mimalloc unavailable for $arch, keeping musl malloc"
+        return 0
+    }
+
+    # LDFLAGS precede the objects, so mark malloc undefined up front: the
+    # linker then takes the allocator (a single object) from libmimalloc.a
+    # before it ever scans libc.a.
+    local flags="-Wl,--undefined=malloc -L$mimalloc_dir/lib -lmimalloc"
+
+    # 32-bit targets without 64-bit atomics need libatomic's helpers
+    local libatomic=$($CC $CFLAGS_ARCH -print-file-name=libatomic.a 2>/dev/null)
+    if [ -f "$libatomic" ]; then
+        flags="$flags -latomic"
+    fi
+
+    log_tool "$tool" "Linking mimalloc $MIMALLOC_VERSION in place of musl malloc"
+    echo "$flags"
+}
+
+# check_malloc_linked <binary> <tool> - a tool given mimalloc link flags
+# must contain it: if the link order ever let libc.a's malloc win, the build
+# would still succeed with musl's allocator. mimalloc's option and message
+# strings ("mimalloc_", "mimalloc: ...") survive stripping.
+check_malloc_linked() {
+    local binary=$1
+    local tool=$2
+
+    if ! grep -aq "mimalloc" "$binary"; then
+        log_tool_error "$tool" "Linked with mimalloc flags, but $binary has no mimalloc in it"
+        return 1
+    fi
+    log_tool "$tool" "mimalloc confirmed in $(basename "$binary")"
+}
+
+# Architecture-optimized string/memory routines, selected per arch with
+# string_routines= in ARCH_CONFIG. "aor" is Arm Optimized Routines: the
+# AArch64 Advanced SIMD and ARMv7 versions of memcpy/memset/strlen/...,
+# which replace musl's generic C (or, for memcpy, baseline asm) versions.
+# No arch selects it until STRING_ROUTINES_SHA512 is pinned.
+STRING_ROUTINES_VERSION="${STRING_ROUTINES_VERSION:-24.01}"
+# sha512sum of the release tarball (URL in build_string_routines_cached).
+# Unset, builds keep libc's routines without trying the download.
+STRING_ROUTINES_SHA512="${STRING_ROUTINES_SHA512:-}"
+
+# get_aor_string_routines <arch> - "<libc name>:<source>:<AOR symbol>" per
+# routine. memcpy-advsimd.S also provides memmove.
+get_aor_string_routines() {
+    local arch=$1
+
+    case "$(get_config_arch "$arch")" in
+        aarch64)
+            echo "memcpy:string/aarch64/memcpy-advsimd.S:__memcpy_aarch64_simd"
+            echo "memmove:string/aarch64/memcpy-advsimd.S:__memmove_aarch64_simd"
+            echo "memset:string/aarch64/memset.S:__memset_aarch64"
+            echo "memchr:string/aarch64/memchr.S:__memchr_aarch64"
+            echo "memcmp:string/aarch64/memcmp.S:__memcmp_aarch64"
+            echo "strlen:string/aarch64/strlen.S:__strlen_aarch64"
+            echo "strnlen:string/aarch64/strnlen.S:__strnlen_aarch64"
+            echo "strchr:string/aarch64/strchr.S:__strchr_aarch64"
+            echo "strcmp:string/aarch64/strcmp.S:__strcmp_aarch64"
+            ;;
+        arm)
+            # ARMv7-A only (Thumb-2); musl's memmove calls memcpy for the
+            # non-overlapping case and so picks this one up
+            echo "memcpy:string/arm/memcpy.S:__memcpy_arm"
+            echo "memset:string/arm/memset.S:__memset_arm"
+            echo "memchr:string/arm/memchr.S:__memchr_arm"
+            echo "strlen:string/arm/strlen-armv6t2.S:__strlen_armv6t2"
+            echo "strcmp:string/arm/strcmp.S:__strcmp_arm"
+            ;;
+    esac
+}
+
+configure_string_routines() {
+    # Only the selected sources are assembled, nothing to configure
+    return 0
+}
+
+# Assemble each routine and rename its entry point to the libc name, so the
+# archive can stand in for libc.a's copies. The names are listed in
+# lib/routines for get_string_routines_link_flags.
+build_string_routines() {
+    local arch=$1
+    local build_dir=$2
+    local objcopy="${OBJCOPY:-${CROSS_COMPILE}objcopy}"
+    local objs=()
+    local entry
+
+    : > routines
+    for entry in $(get_aor_string_routines "$arch"); do
+        local name=${entry%%:*}
+        local rest=${entry#*:}
+        local src=${rest%%:*}
+        local sym=${rest#*:}
+        local obj="$(basename "$src" .S).o"
+
+        if [ ! -f "$obj" ]; then
+            $CC $CFLAGS_ARCH -c -Istring -Istring/include -I"$(dirname "$src")" "$src" -o "$obj" || return 1
+            objs+=("$obj")
+        fi
+        $objcopy --redefine-sym "$sym=$name" "$obj" || return 1
+        echo "$name" >> routines
+    done
+
+    [ ${#objs[@]} -gt 0 ] || return 1
+    $AR rcs libstrroutines.a "${objs[@]}"
+}
+
+install_string_routines() {
+    local action=$1
+    local cache_dir=$2
+    local build_dir=$3
+
+    if [ "$action" = "check" ]; then
+        [ -f "$cache_dir/lib/libstrroutines.a" ] && [ -s "$cache_dir/lib/routines" ]
+        return $?
+    fi
+
+    mkdir -p "$cache_dir/lib"
+    cp libstrroutines.a routines "$cache_dir/lib/"
+}
+
+build_string_routines_cached() {
+    local arch=$1
+
+    build_dependency_generic \
+        "optimized-routines" \
+        "$STRING_ROUTINES_VERSION" \
+        "https://github.com/ARM-software/optimized-routines/archive/refs/tags/v$STRING_ROUTINES_VERSION.tar.gz" \
+        "optimized-routines-$STRING_ROUTINES_VERSION" \
+        "$arch" \
+        configure_string_routines \
+        build_string_routines \
+        install_string_routines \
+        "$STRING_ROUTINES_SHA512"
+}
+
+# prepare_string_routines <arch> - dependency stage run before each musl
+# tool build of an arch with string_routines= set: reuse (or build) the
+# routines ARCH_CONFIG selects and export STRING_ROUTINES_DIR for
+# get_link_flags. STRING_ROUTINES=libc turns the stage off.
+prepare_string_routines() {
+    local arch=$1
+    local impl=$(get_string_routines "$arch" 2>/dev/null)
+
+    unset STRING_ROUTINES_DIR
+    [ -n "$impl" ] || return 0
+    [ "${STRING_ROUTINES:-}" != "libc" ] || return 0
+    [ "${TOOLCHAIN_TYPE:-${LIBC_TYPE:-musl}}" = "musl" ] || return 0
+    [ "${USE_ZIG:-0}" != "1" ] || return 0
+
+    case "$impl" in
+        aor) ;;
+        *)
+            log_tool_warn "$arch" "Unknown string_routines '$impl' in ARCH_CONFIG, using libc's"
+            return 0
+            ;;
+    esac
+
+    # Cached: no toolchain setup, no download
+    local dir=$(get_dependency_cache_dir "optimized-routines" "$STRING_ROUTINES_VERSION" "$arch")
+    if ! install_string_routines check "$dir"; then
+        if [ -z "$STRING_ROUTINES_SHA512" ]; then
+            if [ -z "${STRING_ROUTINES_UNPINNED_LOGGED:-}" ]; then
+                log_tool_warn "$arch" "STRING_ROUTINES_SHA512 is not pinned, using libc's string routines"
+                STRING_ROUTINES_UNPINNED_LOGGED=1
+            fi
+            return 0
+        fi
+        dir=$(build_string_routines_cached "$arch") || {
+            log_tool_warn "$arch" "Optimized string routines unavailable, using libc's"
+            return 0
+        }
+    fi
+    export STRING_ROUTINES_DIR="$dir"
+}
+
+# check_string_routines_linked <map> <routines dir> - every routine in the
+# archive's list was defined by libstrroutines.a in the link the GNU ld map
+# describes, not by libc.a. Prints the routines that were not.
+check_string_routines_linked() {
+    local map=$1
+    local dir=$2
+
+    [ -f "$map" ] && [ -s "$dir/lib/routines" ] || return 1
+
+    local missing=$(awk -v list="$(tr '\n' ' ' < "$dir/lib/routines")" '
+        BEGIN { n = split(list, names, " "); for (i = 1; i <= n; i++) want[names[i]] = 1 }
+        /^Linker script and memory map/ { on = 1; next }
+        !on { next }
+        # Input section line: remember the object the following symbols are in
+        /^ [.A-Z]/ && $2 ~ /^0x/ && NF >= 4 { obj = $4; next }
+        /^ +0x/ && NF >= 3 { obj = $3; next }
+        /^ +0x[0-9a-fA-F]+ +[A-Za-z_][A-Za-z0-9_]*$/ && ($2 in want) {
+            if (obj ~ /libstrroutines\.a\(/) found[$2] = 1
+        }
+        END { for (r in want) if (!(r in found)) printf "%s ", r }
+    ' "$map")
+
+    [ -z "$missing" ] || { echo "${missing% }"; return 1; }
+}
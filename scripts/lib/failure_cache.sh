@@ -0,0 +1,122 @@
+#!/bin/bash
+# Negative-result cache: remembers tool/arch/libc combinations that failed
+# and skips them on later runs until one of their inputs changes.
+#
+# An entry lives at $FAILURE_CACHE_DIR/<tool>/<arch>-<libc> and holds the
+# input fingerprint plus when and where it failed. The fingerprint covers
+# the tool's build script, every shared build library (scripts/lib, which
+# also pins source versions), the tool's patches, any in-tree source the
+# script builds from, the toolchain name and the build knobs that change
+# the output. Edit any of those and the combo is retried.
+#
+# FAILURE_CACHE=false (./build --retry-failed or -f) ignores the cache for
+# a run; a success always clears the entry. ./build --clear-deps wipes it.
+
+FAILURE_CACHE_DIR="${FAILURE_CACHE_DIR:-/build/deps-cache/failure-cache}"
+FAILURE_CACHE_LIB_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+FAILURE_CACHE="${FAILURE_CACHE:-true}"
+
+# Build knobs that select a different output for the same script
+FAILURE_CACHE_ENV_VARS="TOOLCHAIN_BACKEND PGO OPT_PROFILE MALLOC_IMPL DROPBEAR_PROFILE MULTICALL LIBPCAP_RING_KB DESOCK_FD_TABLE_SIZE DESOCK_MAX_CONNS DESOCK_REQUEST_DELIMITER TARGET_OS"
+
+# In-tree source trees a build script may copy from
+FAILURE_CACHE_SOURCE_DIRS="shared-libs example-custom-tool example-custom-lib heapprof iotrace delta-tool"
+
+_failure_cache_entry() {
+    echo "$FAILURE_CACHE_DIR/$1/$2-$3"
+}
+
+# Hash every file under a path, in a stable order
+_failure_cache_hash_tree() {
+    local path=$1
+
+    [ -e "$path" ] || return 0
+    find "$path" -type f -print0 2>/dev/null | sort -z | xargs -0 -r sha256sum 2>/dev/null
+}
+
+# failure_cache_init - hash the shared libraries once per run; planners
+# call this so each fingerprint (computed in a subshell) can reuse it
+failure_cache_init() {
+    _FAILURE_CACHE_LIB_HASH=$(_failure_cache_hash_tree "$FAILURE_CACHE_LIB_DIR" | sha256sum | cut -d' ' -f1)
+    export _FAILURE_CACHE_LIB_HASH
+}
+
+# failure_fingerprint <tool> <arch> <libc> <script> - print the input hash
+failure_fingerprint() {
+    local tool=$1
+    local arch=$2
+    local libc=$3
+    local script=$4
+    local base="${BASE_DIR:-/build}"
+
+    [ -n "${_FAILURE_CACHE_LIB_HASH:-}" ] || failure_cache_init
+
+    {
+        echo "tool=$tool arch=$arch libc=$libc"
+        echo "lib=$_FAILURE_CACHE_LIB_HASH"
+        [ -f "$script" ] && sha256sum < "$script"
+
+        # Variant wrappers (busybox_nodrop, gdbserver-ipa) run a sibling script
+        local sibling
+        if [ -f "$script" ]; then
+            for sibling in $(grep -o 'build-[A-Za-z0-9_-]*\.sh' "$script" | sort -u); do
+                [ -f "$(dirname "$script")/$sibling" ] && sha256sum < "$(dirname "$script")/$sibling"
+            done
+        fi
+        _failure_cache_hash_tree "$base/patches/$tool"
+
+        local dir
+        for dir in $FAILURE_CACHE_SOURCE_DIRS; do
+            if [ -f "$script" ] && grep -q "/build/$dir" "$script"; then
+                _failure_cache_hash_tree "$base/$dir"
+            fi
+        done
+
+        case "$libc" in
+            glibc) echo "toolchain=$(get_glibc_toolchain "$arch" 2>/dev/null)" ;;
+            *)     echo "toolchain=$(get_musl_toolchain "$arch" 2>/dev/null)" ;;
+        esac
+
+        local var
+        for var in $FAILURE_CACHE_ENV_VARS; do
+            echo "$var=${!var:-}"
+        done
+    } | sha256sum | cut -d' ' -f1
+}
+
+# failure_cache_check <tool> <arch> <libc> <fingerprint> - return 0 and
+# print "<date> <log>" when this exact input set is known to fail
+failure_cache_check() {
+    local entry=$(_failure_cache_entry "$1" "$2" "$3")
+    local fingerprint=$4
+
+    [ "$FAILURE_CACHE" = "true" ] || return 1
+    [ -f "$entry" ] || return 1
+
+    local recorded when log_file
+    read -r recorded when log_file < "$entry"
+    [ "$recorded" = "$fingerprint" ] || return 1
+    echo "$when ${log_file:--}"
+}
+
+# failure_cache_record <tool> <arch> <libc> <fingerprint> [log]
+failure_cache_record() {
+    local entry=$(_failure_cache_entry "$1" "$2" "$3")
+
+    mkdir -p "$(dirname "$entry")" 2>/dev/null || return 0
+    echo "$4 $(date '+%Y-%m-%dT%H:%M:%S') ${5:--}" > "$entry" 2>/dev/null || true
+}
+
+# failure_cache_clear <tool> <arch> <libc>
+failure_cache_clear() {
+    rm -f "$(_failure_cache_entry "$1" "$2" "$3")" 2>/dev/null || true
+}
+
+export FAILURE_CACHE_DIR FAILURE_CACHE FAILURE_CACHE_LIB_DIR
+export -f _failure_cache_entry
+export -f _failure_cache_hash_tree
+export -f failure_cache_init
+export -f failure_fingerprint
+export -f failure_cache_check
+export -f failure_cache_record
+export -f failure_cache_clear
@@ -0,0 +1,78 @@
+#!/bin/bash
+# Cache of host-side build artifacts that do not depend on the target:
+# Kbuild's scripts/basic (fixdep), the kconfig programs and configs made
+# with the host compiler. They are built in the first arch's tree and
+# unpacked into every later one, so only the cross steps run per arch.
+#
+# An archive lives at $HOST_TOOLS_CACHE_DIR/<name>-<key>.tar, where the key
+# (host_tools_key) covers the source version, the host compiler and any
+# extra inputs the caller passes (host flags). tar keeps the build-time
+# mtimes, which are newer than the freshly extracted sources, and Kbuild's
+# .cmd files come along, so make treats the restored files as up to date.
+#
+# HOST_TOOLS_CACHE=false disables it; ./build --clear-deps wipes it.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+
+HOST_TOOLS_CACHE_DIR="${HOST_TOOLS_CACHE_DIR:-/build/deps-cache/host-tools}"
+HOST_TOOLS_CACHE="${HOST_TOOLS_CACHE:-true}"
+
+# host_tools_key <name> <version> [extra...] - print the cache key
+host_tools_key() {
+    local name=$1
+    local version=$2
+    shift 2
+    local host_cc="${HOST_TOOLS_CC:-/usr/bin/gcc}"
+
+    {
+        echo "$name $version"
+        "$host_cc" --version 2>/dev/null | head -1
+        "$host_cc" -dumpmachine 2>/dev/null
+        echo "$*"
+    } | sha256sum | cut -c1-16
+}
+
+# host_tools_restore <name> <key> - unpack the cached artifacts into the
+# current source tree; fails when there is nothing cached
+host_tools_restore() {
+    local name=$1
+    local key=$2
+    local archive="$HOST_TOOLS_CACHE_DIR/$name-$key.tar"
+
+    [ "$HOST_TOOLS_CACHE" = "true" ] || return 1
+    [ -s "$archive" ] || return 1
+
+    tar -xf "$archive" || return 1
+    log_tool "$name" "Reusing cached host tools ($key)"
+}
+
+# host_tools_save <name> <key> <path...> - archive paths (relative to the
+# current source tree) unless the key is already cached
+host_tools_save() {
+    local name=$1
+    local key=$2
+    shift 2
+    local archive="$HOST_TOOLS_CACHE_DIR/$name-$key.tar"
+
+    [ "$HOST_TOOLS_CACHE" = "true" ] || return 0
+    [ -s "$archive" ] && return 0
+    mkdir -p "$HOST_TOOLS_CACHE_DIR" 2>/dev/null || return 0
+
+    local path existing=()
+    for path in "$@"; do
+        [ -e "$path" ] && existing+=("$path")
+    done
+    [ ${#existing[@]} -gt 0 ] || return 0
+
+    if tar -cf "$archive.tmp.$$" "${existing[@]}" 2>/dev/null; then
+        mv "$archive.tmp.$$" "$archive"
+    else
+        rm -f "$archive.tmp.$$"
+    fi
+    return 0
+}
+
+export HOST_TOOLS_CACHE_DIR HOST_TOOLS_CACHE
+export -f host_tools_key
+export -f host_tools_restore
+export -f host_tools_save
@@ -0,0 +1,71 @@
+#!/bin/bash
+# Per-architecture build manifest: output/<arch>/manifest.tsv
+#
+# One "<entry>\t<key>\t<value>" row per fact, where <entry> is the output
+# path relative to output/<arch> (e.g. tcpdump.musl, can-utils.musl/candump).
+# The file ships inside the release archive next to the binaries, so later
+# stages (size regressions, qemu checks, libc recommendations) can compare
+# against what was recorded for the previous build.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+
+get_manifest_path() {
+    local arch=$1
+    echo "${STATIC_OUTPUT_DIR:-/build/output}/$arch/manifest.tsv"
+}
+
+# manifest_get <arch> <entry> <key> - print the recorded value (empty if none)
+manifest_get() {
+    local arch=$1
+    local entry=$2
+    local key=$3
+    local manifest=$(get_manifest_path "$arch")
+
+    [ -f "$manifest" ] || return 0
+    awk -F'\t' -v e="$entry" -v k="$key" '$1 == e && $2 == k { v = $3 } END { if (v != "") print v }' "$manifest"
+}
+
+# manifest_set <arch> <entry> <key> <value> - add or replace one row
+manifest_set() {
+    local arch=$1
+    local entry=$2
+    local key=$3
+    local value=$4
+    local manifest=$(get_manifest_path "$arch")
+
+    mkdir -p "$(dirname "$manifest")"
+    touch "$manifest"
+
+    local tmp="${manifest}.tmp.$$"
+    awk -F'\t' -v OFS='\t' -v e="$entry" -v k="$key" -v v="$value" '
+        $1 == e && $2 == k { if (!done) print e, k, v; done = 1; next }
+        { print }
+        END { if (!done) print e, k, v }
+    ' "$manifest" > "$tmp" && mv "$tmp" "$manifest"
+}
+
+# manifest_entries <arch> - list the entries that have at least one row
+manifest_entries() {
+    local arch=$1
+    local manifest=$(get_manifest_path "$arch")
+
+    [ -f "$manifest" ] || return 0
+    cut -f1 "$manifest" | sort -u
+}
+
+# manifest_remove_entry <arch> <entry> - drop every row of an entry
+manifest_remove_entry() {
+    local arch=$1
+    local entry=$2
+    local manifest=$(get_manifest_path "$arch")
+
+    [ -f "$manifest" ] || return 0
+    local tmp="${manifest}.tmp.$$"
+    awk -F'\t' -v e="$entry" '$1 != e' "$manifest" > "$tmp" && mv "$tmp" "$manifest"
+}
+
+export -f get_manifest_path
+export -f manifest_get
+export -f manifest_set
+export -f manifest_entries
+export -f manifest_remove_entry
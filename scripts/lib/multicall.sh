@@ -0,0 +1,263 @@
+#!/bin/bash
+# Multicall (busybox-style) builds for the hardware utility suites.
+#
+# Instead of shipping one static binary per program, every program of a
+# suite is linked into a single binary that dispatches on argv[0], and the
+# individual names are installed as symlinks to it. libc and shared
+# dependencies (zlib, libi2c, ...) are then carried once per suite.
+#
+# The suite's own build system is left alone: multicall_begin wraps $CC so
+# every link command is recorded, and multicall_install re-links the
+# recorded objects of each program into a relocatable object whose only
+# global symbol is its renamed main(). Everything else is localized, so
+# globals that clash between programs (or helper objects such as can-utils'
+# lib.o that get linked into several of them) cannot collide.
+#
+# Enable with MULTICALL=true (all suites) or MULTICALL=can-utils,mtd-utils.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+
+# multicall_enabled <suite> - succeeds if the suite should be built multicall
+multicall_enabled() {
+    local suite=$1
+
+    case ",${MULTICALL:-false}," in
+        *,true,*|*,all,*|*,"$suite",*) ;;
+        *) return 1 ;;
+    esac
+
+    # zig objcopy cannot localize symbols, so Zig targets keep the
+    # separate binaries.
+    if [ "${USE_ZIG:-0}" = "1" ]; then
+        log_tool_warn "$suite" "Multicall needs a GCC toolchain, building separate binaries"
+        return 1
+    fi
+    return 0
+}
+
+# multicall_begin <build_dir> - route $CC through a wrapper that records link
+# commands. Call after the toolchain (and any export_cross_compiler) is set.
+multicall_begin() {
+    local build_dir=$1
+    local mc_dir="$build_dir/.multicall"
+    local wrapper="$mc_dir/cc"
+
+    mkdir -p "$mc_dir"
+    : > "$mc_dir/links"
+
+    cat > "$wrapper" << WRAPPER_EOF
+#!/bin/bash
+# Record "<cwd> <output> <args...>" for every link, then run the real compiler
+output=""
+link=1
+prev=""
+for a in "\$@"; do
+    case "\$a" in
+        -c|-E|-S|-M|-MM) link=0 ;;
+    esac
+    [ "\$prev" = "-o" ] && output="\$a"
+    prev="\$a"
+done
+if [ \$link -eq 1 ] && [ -n "\$output" ]; then
+    # make -j runs links side by side: build the whole record first and
+    # append it in one printf, under flock where there is one (a long
+    # record can take more than one write)
+    printf -v record '%q %q' "\$PWD" "\$output"
+    printf -v args ' %q' "\$@"
+    { flock 9 2>/dev/null; printf '%s\n' "\$record\$args" >&9; } 9>> "$mc_dir/links"
+fi
+exec $CC "\$@"
+WRAPPER_EOF
+    chmod +x "$wrapper"
+
+    export MULTICALL_REAL_CC="$CC"
+    export MULTICALL_DIR="$mc_dir"
+    export CC="$wrapper"
+}
+
+# Symbol-safe applet id: can-calc-bit-timing -> can_calc_bit_timing
+multicall_applet_id() {
+    echo "$1" | sed 's/[^A-Za-z0-9_]/_/g'
+}
+
+# multicall_generate_main <suite> <file> <tool...> - argv[0] dispatcher
+multicall_generate_main() {
+    local suite=$1
+    local main_c=$2
+    shift 2
+    local tool
+
+    {
+        echo "/* Generated by scripts/lib/multicall.sh for $suite */"
+        echo "#include <stdio.h>"
+        echo "#include <string.h>"
+        echo
+        for tool in "$@"; do
+            echo "int applet_$(multicall_applet_id "$tool")_main(int argc, char **argv);"
+        done
+        echo
+        echo "static const struct {"
+        echo "    const char *name;"
+        echo "    int (*main)(int argc, char **argv);"
+        echo "} applets[] = {"
+        for tool in "$@"; do
+            echo "    { \"$tool\", applet_$(multicall_applet_id "$tool")_main },"
+        done
+        echo "};"
+        cat << 'MAIN_EOF'
+
+static int find_applet(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    size_t i;
+
+    name = name ? name + 1 : path;
+    for (i = 0; i < sizeof(applets) / sizeof(applets[0]); i++) {
+        if (strcmp(name, applets[i].name) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t i;
+    int applet = argc > 0 ? find_applet(argv[0]) : -1;
+
+    /* "suite <applet> [args]" works as well as a symlink named <applet> */
+    if (applet < 0 && argc > 1) {
+        applet = find_applet(argv[1]);
+        if (applet >= 0) {
+            argc--;
+            argv++;
+        }
+    }
+    if (applet >= 0)
+        return applets[applet].main(argc, argv);
+
+MAIN_EOF
+        echo "    fputs(\"$suite multicall binary\\nUsage: $suite <applet> [args], or symlink <applet> to it\\n\\nApplets:\\n\", stderr);"
+        cat << 'MAIN_EOF'
+    for (i = 0; i < sizeof(applets) / sizeof(applets[0]); i++)
+        fprintf(stderr, "  %s\n", applets[i].name);
+    return 1;
+}
+MAIN_EOF
+    } > "$main_c"
+}
+
+# multicall_install <suite> <arch> <out_dir> <tool...>
+# Link the recorded programs into <out_dir>/<suite> and symlink each tool
+# name to it. A tool without a usable link record (an optional program
+# that did not build) is left out with a warning. Returns 1 (leaving
+# out_dir untouched) if anything fails, so the caller can fall back to
+# installing the separate binaries.
+multicall_install() {
+    local suite=$1
+    local arch=$2
+    local out_dir=$3
+    shift 3
+
+    local mc_dir="${MULTICALL_DIR:?multicall_begin was not called}"
+    local cc="${MULTICALL_REAL_CC:-$CC}"
+    local objcopy="${OBJCOPY:-${CROSS_COMPILE}objcopy}"
+    local applet_objs=()
+    local link_libs=()
+    local applets=()
+    local tool
+
+    for tool in "$@"; do
+        local record=$(awk -v t="$tool" '{ o = $2; sub(/.*\//, "", o) } o == t { r = $0 } END { print r }' "$mc_dir/links")
+        if [ -z "$record" ]; then
+            log_tool_warn "$suite" "No link of $tool was recorded, leaving it out of the multicall binary"
+            continue
+        fi
+
+        local args
+        eval "args=($record)"
+        local cwd="${args[0]}"
+        local output="${args[1]}"
+        [[ "$output" = /* ]] || output="$cwd/$output"
+        if [ ! -f "$output" ]; then
+            log_tool_warn "$suite" "$tool was not built, leaving it out of the multicall binary"
+            continue
+        fi
+
+        local inputs=()
+        local a prev=""
+        for a in "${args[@]:2}"; do
+            if [ "$prev" = "-o" ]; then
+                prev=""
+                continue
+            fi
+            prev="$a"
+            case "$a" in
+                *.o|*.a)
+                    [[ "$a" = /* ]] || a="$cwd/$a"
+                    inputs+=("$a")
+                    ;;
+                -L/*|-l*)
+                    link_libs+=("$a")
+                    ;;
+                -L*)
+                    link_libs+=("-L$cwd/${a#-L}")
+                    ;;
+            esac
+        done
+        if [ ${#inputs[@]} -eq 0 ]; then
+            log_tool_warn "$suite" "The recorded link of $tool has no objects, leaving it out of the multicall binary"
+            continue
+        fi
+
+        local id=$(multicall_applet_id "$tool")
+        local obj="$mc_dir/$id.o"
+        $cc ${CFLAGS_ARCH:-} -nostdlib -r -o "$obj" "${inputs[@]}" || {
+            log_tool_warn "$suite" "Partial link of $tool failed"
+            return 1
+        }
+        $objcopy --redefine-sym "main=applet_${id}_main" "$obj" && \
+        $objcopy --keep-global-symbol="applet_${id}_main" "$obj" || {
+            log_tool_warn "$suite" "Could not localize symbols of $tool"
+            return 1
+        }
+        applet_objs+=("$obj")
+        applets+=("$tool")
+    done
+
+    if [ ${#applets[@]} -eq 0 ]; then
+        log_tool_warn "$suite" "No link commands recorded for multicall"
+        return 1
+    fi
+
+    # Keep the first occurrence of each -L/-l, in recorded order
+    local libs=($(printf '%s\n' "${link_libs[@]}" | awk '!seen[$0]++'))
+
+    local cflags=$(get_compile_flags "$arch" "static" "$suite")
+    local ldflags=$(get_link_flags "$arch" "static")
+    local binary="$mc_dir/$suite"
+
+    multicall_generate_main "$suite" "$mc_dir/main.c" "${applets[@]}"
+    $cc $cflags -o "$binary" "$mc_dir/main.c" "${applet_objs[@]}" $ldflags "${libs[@]}" || {
+        log_tool_warn "$suite" "Multicall link failed for $arch"
+        return 1
+    }
+
+    save_symbol_sizes "$binary" "$arch" "$suite"
+    $STRIP "$binary" 2>/dev/null || true
+
+    mkdir -p "$out_dir"
+    cp "$binary" "$out_dir/$suite"
+    for tool in "${applets[@]}"; do
+        ln -sf "$suite" "$out_dir/$tool"
+    done
+
+    local size=$(get_binary_size "$out_dir/$suite")
+    log_tool "$suite" "Built multicall binary for $arch ($size, ${#applets[@]} applets)"
+    return 0
+}
+
+export -f multicall_enabled
+export -f multicall_begin
+export -f multicall_applet_id
+export -f multicall_generate_main
+export -f multicall_install
@@ -0,0 +1,195 @@
+#!/bin/bash
+# Profile-guided optimization for the throughput tools (tcpdump, socat,
+# ncat, openssl, curl). pgo_build trains a tool before building it:
+#
+#   1. an instrumented build (PGO_MODE=generate) is moved aside;
+#   2. the tool's training script, scripts/pgo/<tool>.sh, drives it through
+#      its hot paths, natively or under qemu-user, and GCC's runtime writes
+#      one .gcda file per object into the profile dir on exit;
+#   3. the real build (PGO_MODE=use) compiles with -fprofile-use.
+#
+# Profiles live at $PGO_PROFILE_ROOT/<tool>-<version>/<arch>.<libc>.<opt>,
+# so a version bump or an opt profile switch trains again, and later builds
+# of the same combination reuse them (PGO_RETRAIN=true forces a new run).
+# GCC names each .gcda after the full path of its object file, so both
+# builds use the same build directory (see create_build_dir).
+#
+# PGO=true (./build --pgo) routes build_tool here for every tool with a
+# training script. zig cc needs llvm-profdata to merge raw profiles, so
+# Zig builds are made without PGO. ./build --bench pgo reports the speedup.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+source "$(dirname "${BASH_SOURCE[0]}")/qemu_runner.sh"
+source "$(dirname "${BASH_SOURCE[0]}")/manifest.sh"
+
+PGO_LIB_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PGO_TRAINING_DIR="${PGO_TRAINING_DIR:-$(dirname "$PGO_LIB_DIR")/pgo}"
+PGO_PROFILE_ROOT="${PGO_PROFILE_ROOT:-/build/deps-cache/pgo}"
+PGO_WORK_DIR="${PGO_WORK_DIR:-/tmp/sthenos-pgo}"
+
+# pgo_training_script <tool> - print the training script for a tool, or
+# nothing when the tool has none. Variants share their base tool's script.
+pgo_training_script() {
+    local tool=$1
+    local name
+
+    case "$tool" in
+        tcpdump)        name="tcpdump" ;;
+        socat|socat-ssl) name="socat" ;;
+        ncat|ncat-ssl)  name="ncat" ;;
+        openssl)        name="openssl" ;;
+        curl|curl-full) name="curl" ;;
+        *)              return 0 ;;
+    esac
+
+    [ -f "$PGO_TRAINING_DIR/$name.sh" ] && echo "$PGO_TRAINING_DIR/$name.sh"
+}
+
+# pgo_tool_version <tool> - source version the tool is built from: the
+# environment override if set, else the default in its build script or in
+# source_versions.sh
+pgo_tool_version() {
+    local tool=$1
+    local var
+
+    case "$tool" in
+        tcpdump)        var="TCPDUMP_VERSION" ;;
+        socat|socat-ssl) var="SOCAT_VERSION" ;;
+        ncat|ncat-ssl)  var="NMAP_VERSION" ;;
+        openssl)        var="OPENSSL_VERSION" ;;
+        curl|curl-full) var="CURL_VERSION" ;;
+        *)              echo "unknown"; return 0 ;;
+    esac
+
+    if [ -n "${!var:-}" ]; then
+        echo "${!var}"
+        return 0
+    fi
+
+    local version=$(sed -n "s/^${var}=\"\${${var}:-\([^}]*\)}\"/\1/p" \
+        "${TOOL_SCRIPTS[$tool]:-/dev/null}" "$PGO_LIB_DIR/source_versions.sh" 2>/dev/null | head -1)
+    echo "${version:-unknown}"
+}
+
+# pgo_profile_dir <tool> <arch> - where the tool's .gcda files are kept
+pgo_profile_dir() {
+    local tool=$1
+    local arch=$2
+
+    echo "$PGO_PROFILE_ROOT/$tool-$(pgo_tool_version "$tool")/$arch.$(get_libc_suffix "$arch").$(get_tool_opt_profile "$tool")"
+}
+
+# pgo_supported <tool> <arch> - the tool has a training script, the arch
+# builds with GCC and its binaries can run here
+pgo_supported() {
+    local tool=$1
+    local arch=$2
+
+    [ -n "$(pgo_training_script "$tool")" ] || return 1
+    [ "${USE_ZIG:-0}" = "1" ] && return 1
+    is_zig_target "$arch" && return 1
+    uses_zig_linux "$arch" && return 1
+    can_run_arch "$arch"
+}
+
+# pgo_train <tool> <arch> - instrumented build plus training run; leaves
+# the profile in pgo_profile_dir and whatever was in output/ untouched
+pgo_train() {
+    local tool=$1
+    local arch=$2
+    local script=$(pgo_training_script "$tool")
+    local profile_dir=$(pgo_profile_dir "$tool" "$arch")
+    local output_path=$(get_output_path "$arch" "$tool")
+    local work_dir="$PGO_WORK_DIR/$tool-$arch"
+
+    rm -rf "$profile_dir" "$work_dir"
+    mkdir -p "$profile_dir" "$work_dir" || return 1
+    [ -f "$output_path" ] && cp -p "$output_path" "$work_dir/$tool.orig"
+
+    log_tool "pgo" "Building instrumented $tool for $arch..."
+    local rc=0
+    (export PGO_MODE=generate PGO_TOOL="$tool" PGO_PROFILE_DIR="$profile_dir" SKIP_IF_EXISTS=false
+     build_tool "$tool" "$arch") || rc=1
+    if [ $rc -eq 0 ] && [ -s "$output_path" ]; then
+        mv "$output_path" "$work_dir/$tool"
+    else
+        log_tool_error "pgo" "Instrumented build of $tool failed for $arch"
+        rc=1
+    fi
+    if [ -f "$work_dir/$tool.orig" ]; then
+        mv "$work_dir/$tool.orig" "$output_path"
+    else
+        rm -f "$output_path"
+    fi
+    [ $rc -eq 0 ] || { rm -rf "$work_dir"; return 1; }
+
+    # On native builds configure ran its test programs instrumented
+    find "$profile_dir" -name '*conftest*' -delete
+
+    log_tool "pgo" "Training $tool on $arch ($(basename "$script"))..."
+    if ! bash "$script" "$arch" "$work_dir/$tool" "$work_dir"; then
+        log_tool_error "pgo" "Training run of $tool failed on $arch"
+        rm -rf "$work_dir"
+        return 1
+    fi
+    rm -rf "$work_dir"
+
+    local count=$(find "$profile_dir" -name '*.gcda' | wc -l)
+    if [ "$count" -eq 0 ]; then
+        log_tool_error "pgo" "Training of $tool on $arch wrote no profile data"
+        return 1
+    fi
+    echo "$(date '+%Y-%m-%dT%H:%M:%S') $count" > "$profile_dir/.trained"
+    log_tool "pgo" "Profile for $tool on $arch: $count files in $profile_dir"
+}
+
+# pgo_build <tool> <arch> - build a tool with its profile, training first
+# when there is none yet. Falls back to a plain build (with a warning) when
+# the arch can't be trained.
+pgo_build() {
+    local tool=$1
+    local arch=$2
+    local output_path=$(get_output_path "$arch" "$tool")
+    local entry=$(basename "$output_path")
+
+    # The manifest row carries the binary's hash, so a plain rebuild since
+    # then doesn't count as a PGO build
+    if [ "${SKIP_IF_EXISTS:-true}" = "true" ] && [ -s "$output_path" ]; then
+        local recorded=$(manifest_get "$arch" "$entry" pgo)
+        if [ -n "$recorded" ] && [ "${recorded##*sha256=}" = "$(sha256sum < "$output_path" | cut -c1-16)" ]; then
+            log "[$arch] Already built: $output_path ($(get_binary_size "$output_path"), PGO)"
+            return 0
+        fi
+    fi
+
+    if ! pgo_supported "$tool" "$arch"; then
+        log_tool_warn "pgo" "$tool on $arch can't be trained here (Zig build or no qemu-user), building without PGO"
+        (export PGO_MODE=off; build_tool "$tool" "$arch")
+        return
+    fi
+
+    local profile_dir=$(pgo_profile_dir "$tool" "$arch")
+    if [ "${PGO_RETRAIN:-false}" = "true" ] || [ ! -s "$profile_dir/.trained" ]; then
+        if ! pgo_train "$tool" "$arch"; then
+            log_tool_warn "pgo" "No profile for $tool on $arch, building without PGO"
+            (export PGO_MODE=off; build_tool "$tool" "$arch")
+            return
+        fi
+    else
+        log_tool "pgo" "Reusing profile for $tool on $arch (trained $(cut -d' ' -f1 "$profile_dir/.trained"))"
+    fi
+
+    (export PGO_MODE=use PGO_TOOL="$tool" PGO_PROFILE_DIR="$profile_dir" SKIP_IF_EXISTS=false
+     build_tool "$tool" "$arch") || return 1
+
+    [ -s "$output_path" ] || return 1
+    manifest_set "$arch" "$entry" pgo "version=$(pgo_tool_version "$tool") profiles=$(cut -d' ' -f2 "$profile_dir/.trained") sha256=$(sha256sum < "$output_path" | cut -c1-16)"
+}
+
+export PGO_LIB_DIR PGO_TRAINING_DIR PGO_PROFILE_ROOT PGO_WORK_DIR
+export -f pgo_training_script
+export -f pgo_tool_version
+export -f pgo_profile_dir
+export -f pgo_supported
+export -f pgo_train
+export -f pgo_build
@@ -0,0 +1,136 @@
+#!/bin/bash
+# Run target binaries on the build host: natively for x86 targets, through
+# qemu-user for everything else. Outputs are fully static, so no sysroot
+# (-L) is needed.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+
+# Map our arch names to the qemu-user emulator suffix (qemu-<suffix>).
+# Prints nothing for archs qemu-user cannot run (no linux-user target).
+get_qemu_arch() {
+    local arch="$1"
+
+    case "$arch" in
+        x86_64)                         echo "x86_64" ;;
+        i486|ix86le)                    echo "i386" ;;
+        aarch64)                        echo "aarch64" ;;
+        aarch64_be)                     echo "aarch64_be" ;;
+        armeb*)                         echo "armeb" ;;
+        arm*)                           echo "arm" ;;
+        mips32be|mips32besf)            echo "mips" ;;
+        mips32le|mips32lesf)            echo "mipsel" ;;
+        mips64n32)                      echo "mipsn32" ;;
+        mips64n32el)                    echo "mipsn32el" ;;
+        mips64)                         echo "mips64" ;;
+        mips64le)                       echo "mips64el" ;;
+        ppc32be|ppc32besf)              echo "ppc" ;;
+        ppc64be)                        echo "ppc64" ;;
+        ppc64le)                        echo "ppc64le" ;;
+        riscv32)                        echo "riscv32" ;;
+        riscv64)                        echo "riscv64" ;;
+        m68k|m68k_coldfire)             echo "m68k" ;;
+        microblaze)                     echo "microblaze" ;;
+        microblazeel)                   echo "microblazeel" ;;
+        or1k)                           echo "or1k" ;;
+        s390x)                          echo "s390x" ;;
+        sh2|sh4)                        echo "sh4" ;;
+        sh2eb|sh4eb)                    echo "sh4eb" ;;
+        loongarch64)                    echo "loongarch64" ;;
+        sparc64)                        echo "sparc64" ;;
+        nios2)                          echo "nios2" ;;
+        xtensa)                         echo "xtensa" ;;
+        # x32 needs kernel support (no qemu target), ppc32le has no
+        # linux-user target and ARC is not emulated at all
+        *)                              echo "" ;;
+    esac
+}
+
+# Extra qemu -cpu selection for variants the default CPU model can't run
+get_qemu_cpu() {
+    local arch="$1"
+
+    case "$arch" in
+        m68k_coldfire)  echo "cfv4e" ;;
+        *)              echo "" ;;
+    esac
+}
+
+is_native_arch() {
+    local arch="$1"
+    local host_arch=$(uname -m)
+
+    case "$host_arch:$arch" in
+        x86_64:x86_64|x86_64:i486|x86_64:ix86le) return 0 ;;
+        aarch64:aarch64) return 0 ;;
+    esac
+    return 1
+}
+
+find_qemu_binary() {
+    local qemu_arch="$1"
+    local candidate
+
+    for candidate in "qemu-${qemu_arch}-static" "qemu-${qemu_arch}"; do
+        if command -v "$candidate" >/dev/null 2>&1; then
+            command -v "$candidate"
+            return 0
+        fi
+    done
+    return 1
+}
+
+# Succeeds if binaries for $arch can be executed on this host
+can_run_arch() {
+    local arch="$1"
+
+    if is_native_arch "$arch"; then
+        return 0
+    fi
+
+    local qemu_arch=$(get_qemu_arch "$arch")
+    [ -n "$qemu_arch" ] && find_qemu_binary "$qemu_arch" >/dev/null
+}
+
+# Print the command prefix used to execute a binary built for $arch
+get_target_runner() {
+    local arch="$1"
+
+    if is_native_arch "$arch"; then
+        return 0
+    fi
+
+    local qemu_arch=$(get_qemu_arch "$arch")
+    if [ -z "$qemu_arch" ]; then
+        log_error "qemu-user has no emulator for $arch"
+        return 1
+    fi
+
+    local qemu_bin
+    qemu_bin=$(find_qemu_binary "$qemu_arch") || {
+        log_error "qemu-${qemu_arch} not found (install qemu-user)"
+        return 1
+    }
+
+    local cpu=$(get_qemu_cpu "$arch")
+    echo "$qemu_bin${cpu:+ -cpu $cpu}"
+}
+
+# run_target <arch> <binary> [args...]
+# Honours RUN_TIMEOUT (seconds, default 60) so hung emulation can't stall a run.
+run_target() {
+    local arch="$1"
+    shift
+
+    local runner
+    runner=$(get_target_runner "$arch") || return 127
+
+    timeout "${RUN_TIMEOUT:-60}" $runner "$@"
+}
+
+export -f get_qemu_arch
+export -f get_qemu_cpu
+export -f is_native_arch
+export -f find_qemu_binary
+export -f can_run_arch
+export -f get_target_runner
+export -f run_target
@@ -0,0 +1,288 @@
+#!/bin/bash
+# Size analysis for static outputs: section breakdown (.text/.rodata/.data/
+# .bss) per binary, the largest symbols taken from the link map, and a
+# diff against the sizes recorded in output/<arch>/manifest.tsv by the
+# previous build. Growth over SIZE_GROWTH_THRESHOLD percent is flagged.
+
+source "$(dirname "${BASH_SOURCE[0]}")/logging.sh"
+source "$(dirname "${BASH_SOURCE[0]}")/manifest.sh"
+
+SIZE_GROWTH_THRESHOLD="${SIZE_GROWTH_THRESHOLD:-5}"
+SIZE_TOP_SYMBOLS="${SIZE_TOP_SYMBOLS:-25}"
+
+get_size_report_dir() {
+    echo "${LOGS_DIR:-/build/logs}/size"
+}
+
+# get_cross_binutil <util> - binutils program matching the active toolchain,
+# falling back to the host one (readelf understands any ELF target)
+get_cross_binutil() {
+    local util=$1
+    local prefix="${CROSS_COMPILE:-}"
+
+    if [ -z "$prefix" ] && [[ "${STRIP:-}" == *-strip ]]; then
+        prefix="${STRIP%strip}"
+    fi
+
+    if [ -n "$prefix" ] && command -v "${prefix}${util}" >/dev/null 2>&1; then
+        echo "${prefix}${util}"
+    else
+        echo "$util"
+    fi
+}
+
+# get_section_sizes <binary> - print "<text> <rodata> <data> <bss>" in bytes
+get_section_sizes() {
+    local binary=$1
+    local readelf=$(get_cross_binutil readelf)
+
+    $readelf -SW "$binary" 2>/dev/null | sed -n 's/^ *\[ *[0-9]*\] //p' | awk '
+        function hex(s,    i, n) {
+            n = 0
+            s = tolower(s)
+            for (i = 1; i <= length(s); i++)
+                n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+            return n
+        }
+        $1 ~ /^\.text/ || $1 == ".init" || $1 == ".fini"                     { text += hex($5) }
+        $1 ~ /^\.rodata/ || $1 ~ /^\.eh_frame/ || $1 == ".gcc_except_table"  { rodata += hex($5) }
+        $1 ~ /^\.data/ || $1 ~ /^\.got/ || $1 == ".tdata" || $1 ~ /_array$/  { data += hex($5) }
+        $1 ~ /^\.bss/ || $1 == ".tbss" || $1 == ".sbss"                      { bss += hex($5) }
+        END { printf "%d %d %d %d\n", text, rodata, data, bss }
+    '
+}
+
+# Static links pass -Wl,--strip-all, so nm finds nothing in the linked
+# binary. The final link of each tool instead asks GNU ld for a map
+# (-Map=<dir>/ names it <output>.map), which lists each input section with
+# its size and object; with -ffunction-sections that is one entry per
+# function or object. SIZE_LINK_MAP=false turns the maps off.
+get_link_map_dir() {
+    local arch=$1
+
+    echo "$(get_size_report_dir)/maps/$arch/${TOOL_NAME:-other}.$(get_libc_suffix)"
+}
+
+# link_map_supported - whether the active linker takes a directory for -Map
+# (binutils 2.37+); probed once per compiler and remembered
+link_map_supported() {
+    [ -n "${CC:-}" ] || return 1
+
+    local probe_dir="$(get_size_report_dir)/maps"
+    local key=$(echo "$CC ${CFLAGS_ARCH:-}" | cksum | cut -d' ' -f1)
+    local result="$probe_dir/.probe-$key"
+
+    if [ ! -f "$result" ]; then
+        local tmp=$(mktemp -d 2>/dev/null) || return 1
+        mkdir -p "$tmp/map" "$probe_dir" 2>/dev/null || { rm -rf "$tmp"; return 1; }
+        echo 'int main(void) { return 0; }' > "$tmp/probe.c"
+        if $CC ${CFLAGS_ARCH:-} -nostdlib -Wl,--entry=main -o "$tmp/probe" "$tmp/probe.c" \
+                -Wl,-Map="$tmp/map/" >/dev/null 2>&1 && [ -s "$tmp/map/probe.map" ]; then
+            echo yes > "$tmp/result"
+        else
+            echo no > "$tmp/result"
+        fi
+        # Parallel builds probe the same compiler; rename is atomic
+        mv -f "$tmp/result" "$result"
+        rm -rf "$tmp"
+    fi
+    [ "$(cat "$result" 2>/dev/null)" = "yes" ]
+}
+
+# get_link_map_flags <arch> <tool> - link flag that writes the map for
+# save_symbol_sizes, empty where the linker can't. Only the tool being
+# built (TOOL_NAME) gets it, and only on its final link: given to configure
+# or a dependency build it would leave a map for every throwaway link.
+get_link_map_flags() {
+    local arch=$1
+    local tool=${2:-}
+
+    [ -n "$tool" ] && [ "$tool" = "${TOOL_NAME:-}" ] || return 0
+    [ "${SIZE_LINK_MAP:-true}" = "true" ] || return 0
+    [ "${USE_ZIG:-0}" != "1" ] || return 0
+    link_map_supported || return 0
+
+    local dir=$(get_link_map_dir "$arch")
+    mkdir -p "$dir" 2>/dev/null || return 0
+    echo "-Wl,-Map=$dir/"
+}
+
+# link_map_make_args <arch> <tool> - arguments for the make that links an
+# autoconf tool: a second makefile appends the map flag to the top-level
+# Makefile's LDFLAGS, keeping whatever configure put there. Sub-makes don't
+# read it. Empty when there is no map flag.
+link_map_make_args() {
+    local arch=$1
+    local tool=$2
+    local flags=$(get_link_map_flags "$arch" "$tool")
+
+    [ -n "$flags" ] || return 0
+    local fragment="$(get_link_map_dir "$arch")/ldflags.mk"
+    echo "override LDFLAGS += $flags" > "$fragment" || return 0
+    echo "-f Makefile -f $fragment"
+}
+
+# map_symbol_sizes <map> - "<bytes>\t<kind>\t<name>\t<object>" for every
+# allocated input section in a GNU ld map. A function or data section is
+# named after its symbol; a plain .text/.data section after its object.
+map_symbol_sizes() {
+    local map=$1
+
+    awk '
+        function hex(s,    i, n) {
+            n = 0
+            s = tolower(substr(s, 3))
+            for (i = 1; i <= length(s); i++)
+                n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+            return n
+        }
+        function add(sec, size, obj,    kind, name) {
+            if (sec ~ /^\.(text|init|fini)/)                                 kind = "text"
+            else if (sec ~ /^\.rodata/)                                      kind = "rodata"
+            else if (sec ~ /^\.(data|sdata|tdata|got|init_array|fini_array)/) kind = "data"
+            else if (sec ~ /^\.(bss|sbss|tbss)/ || sec == "COMMON")          kind = "bss"
+            else return
+            size = hex(size)
+            if (size == 0) return
+
+            sub(/.*\//, "", obj)
+            name = sec
+            sub(/^\.(text|rodata|data\.rel\.ro|data\.rel|data|sdata|tdata|bss|sbss|tbss)(\.(startup|unlikely|hot|exit|local))?\.?/, "", name)
+            # Merged string/constant pools (.rodata.str1.1, .rodata.cst8) have no symbol
+            if (name == "" || name == sec || name ~ /^(str|cst)[0-9]/) name = obj
+            total[kind "\t" name "\t" obj] += size
+        }
+        /^Linker script and memory map/ { on = 1; next }
+        !on { next }
+        /^OUTPUT\(/ { exit }
+        pending != "" {
+            # Long section names put address, size and object on the next line
+            if ($1 ~ /^0x/ && $2 ~ /^0x/ && NF >= 3) add(pending, $2, $3)
+            pending = ""
+            next
+        }
+        /^ [.A-Z]/ && NF == 1 { pending = $1; next }
+        /^ [.A-Z]/ && $2 ~ /^0x/ && $3 ~ /^0x/ && NF >= 4 { add($1, $3, $4) }
+        END { for (k in total) printf "%d\t%s\n", total[k], k }
+    ' "$map"
+}
+
+# save_symbol_sizes <binary> <arch> <name> [map] - record the largest
+# symbols of a binary from its link map (the one get_link_map_flags asked for,
+# or [map] for builds that write their own), or from its symbol table when
+# it was linked without one (and not stripped yet). Call right before
+# $STRIP. Warns when neither is available; never fails the build.
+save_symbol_sizes() {
+    local binary=$1
+    local arch=$2
+    local name=$3
+    local map=${4:-"$(get_link_map_dir "$arch")/$(basename "$binary").map"}
+    local nm=$(get_cross_binutil nm)
+    local sym_dir="$(get_size_report_dir)/$arch"
+    local sym_file="$sym_dir/${name}.$(get_libc_suffix).syms"
+
+    mkdir -p "$sym_dir" 2>/dev/null || return 0
+
+    # A map much older than the binary is left over from another link (ld
+    # may finish the map a moment before the output file)
+    if [ -f "$map" ] && [ $(( $(stat -c %Y "$binary") - $(stat -c %Y "$map") )) -lt 60 ] \
+        && grep -q "^OUTPUT(.*$(basename "$binary") " "$map"; then
+        map_symbol_sizes "$map"
+    else
+        $nm -S --size-sort -t d "$binary" 2>/dev/null \
+            | awk 'NF == 4 { printf "%d\t%s\t%s\t-\n", $2, $3, $4 }'
+    fi | sort -t$'\t' -k1,1nr | head -n "$SIZE_TOP_SYMBOLS" > "$sym_file"
+
+    if [ ! -s "$sym_file" ]; then
+        rm -f "$sym_file"
+        log_tool_warn "$name" "No symbol sizes for $(basename "$binary"): no link map and no symbol table"
+    fi
+    return 0
+}
+
+# size_growth_pct <old> <new> - growth in percent with one decimal
+size_growth_pct() {
+    awk -v a="$1" -v b="$2" 'BEGIN { if (a > 0) printf "%.1f", (b - a) * 100 / a; else print "0.0" }'
+}
+
+# run_size_report <arch> - analyse every ELF output of an arch, update the
+# manifest and write logs/size/<arch>.txt. Returns 1 when a binary grew past
+# the threshold and SIZE_GROWTH_FAIL=true.
+run_size_report() {
+    local arch=$1
+    local out_dir="${STATIC_OUTPUT_DIR:-/build/output}/$arch"
+    local report_dir=$(get_size_report_dir)
+    local report="$report_dir/$arch.txt"
+    local readelf=$(get_cross_binutil readelf)
+
+    [ -d "$out_dir" ] || return 0
+    mkdir -p "$report_dir"
+
+    local regressions=0
+    {
+        echo "Size report for $arch ($(date '+%Y-%m-%d %H:%M:%S'), threshold ${SIZE_GROWTH_THRESHOLD}%)"
+        echo
+        printf "%-36s %10s %10s %10s %10s %10s %8s\n" binary file text rodata data bss growth
+    } > "$report"
+
+    local binary
+    while IFS= read -r binary; do
+        $readelf -h "$binary" >/dev/null 2>&1 || continue
+
+        local entry="${binary#$out_dir/}"
+        local file_size=$(stat -c %s "$binary")
+        local text rodata data bss
+        read -r text rodata data bss <<< "$(get_section_sizes "$binary")"
+
+        local prev=$(manifest_get "$arch" "$entry" size_bytes)
+        local growth="-"
+        if [ -n "$prev" ] && [ "$prev" != "$file_size" ]; then
+            growth="$(size_growth_pct "$prev" "$file_size")%"
+            manifest_set "$arch" "$entry" size_prev "$prev"
+            if awk -v g="${growth%\%}" -v t="$SIZE_GROWTH_THRESHOLD" 'BEGIN { exit !(g > t) }'; then
+                log_tool_warn "$arch" "$entry grew ${growth} ($prev -> $file_size bytes, text $(manifest_get "$arch" "$entry" text) -> $text)"
+                growth="${growth}!"
+                regressions=$((regressions + 1))
+            fi
+        fi
+
+        manifest_set "$arch" "$entry" size_bytes "$file_size"
+        manifest_set "$arch" "$entry" text "$text"
+        manifest_set "$arch" "$entry" rodata "$rodata"
+        manifest_set "$arch" "$entry" data "$data"
+        manifest_set "$arch" "$entry" bss "$bss"
+
+        printf "%-36s %10s %10s %10s %10s %10s %8s\n" \
+            "$entry" "$file_size" "$text" "$rodata" "$data" "$bss" "$growth" >> "$report"
+    done < <(find "$out_dir" -path "$out_dir/shared" -prune -o -type f ! -name 'manifest.tsv' -print | sort)
+
+    local sym_file
+    for sym_file in "$report_dir/$arch"/*.syms; do
+        [ -f "$sym_file" ] || continue
+        {
+            echo
+            echo "Largest symbols in $(basename "$sym_file" .syms):"
+            head -n 10 "$sym_file" | awk -F'\t' '{ printf "  %10d  %-6s  %s%s\n", $1, $2, $3, ($4 == "-" || $4 == $3 ? "" : "  " $4) }'
+        } >> "$report"
+    done
+
+    if [ $regressions -gt 0 ]; then
+        log_tool_warn "$arch" "$regressions binaries grew more than ${SIZE_GROWTH_THRESHOLD}% (see ${report#/build/})"
+        [ "${SIZE_GROWTH_FAIL:-false}" = "true" ] && return 1
+    else
+        log_tool "$arch" "Size report: ${report#/build/}"
+    fi
+    return 0
+}
+
+export -f get_size_report_dir
+export -f get_cross_binutil
+export -f get_section_sizes
+export -f get_link_map_dir
+export -f link_map_supported
+export -f get_link_map_flags
+export -f link_map_make_args
+export -f map_symbol_sizes
+export -f save_symbol_sizes
+export -f size_growth_pct
+export -f run_size_report
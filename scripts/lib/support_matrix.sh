@@ -0,0 +1,102 @@
+#!/bin/bash
+# Declarative tool x arch support matrix, consulted by the planners
+# (build-static.sh, build-shared.sh) before any toolchain setup, download
+# or extraction, and by the tool scripts when they are run directly.
+#
+# One rule per line: tool | libc | archs | reason
+#   libc   "any" or a comma list (musl,glibc,uclibc)
+#   archs  space-separated globs; "!glob" excludes matching archs, plain
+#          globs allow only the matching archs. A combo is unsupported when
+#          an exclude matches or when allow globs exist and none match.
+# Several rules may name the same tool; the first that rejects wins.
+#
+# Only list combinations that fail for structural reasons (no upstream
+# port, missing libc feature). Flaky or unexplained failures belong in the
+# failure cache (failure_cache.sh), which forgets them when inputs change.
+
+SUPPORT_MATRIX='
+# strace-6.x only has a riscv64 port; configure errors out with
+# "architecture riscv32 is not supported by strace"
+strace     | any | !riscv32 | no upstream strace port for riscv32
+
+# gdb-16.3: microblaze/nios2 have no case in gdbserver/configure.srv (no
+# linux-<arch>-low.cc, link fails on initialize_low). or1k has one, but
+# musl sys/procfs.h lacks elf_gregset_t/elf_fpregset_t for or1k.
+gdbserver  | any | !microblaze !microblazeel !nios2 !or1k | no upstream gdbserver backend for this arch
+
+# The in-process agent (fast tracepoints) only has linux-<arch>-ipa.cc for
+# i386, amd64, aarch64, powerpc and s390; 32-bit ARM has none. x32 is left
+# out: configure.srv builds no x32 agent.
+gdbserver-ipa | any | x86_64 i486 ix86le aarch64 aarch64_be ppc* s390x | gdbserver has no in-process agent for this arch
+
+# ply emits BPF for little-endian targets it has a backend for
+ply        | any | x86_64 aarch64 arm32v5le arm32v5lehf arm32v7le arm32v7lehf armv6 mips32le mips64le riscv32 riscv64 ppc64le | ply has no BPF backend for this arch (little-endian only)
+
+# ltrace 0.8.1 only knows big-endian aarch64 (sysdeps/linux-gnu/aarch64)
+ltrace     | any | !aarch64 | ltrace 0.8.1 does not support little-endian aarch64
+
+# libdesock needs src/include/arch/<arch> upstream (see get_desock_arch)
+libdesock  | any | x86_64 x86_64_x32 i486 ix86le aarch64 aarch64_be arm* armeb* armel* armv* mips* ppc* s390x riscv64 m68k m68k_coldfire microblaze microblazeel or1k sh2 sh2eb sh4 sh4eb | libdesock has no syscall headers for this arch
+'
+
+# support_matrix_reason <tool> <arch> [libc] - print why a combination is
+# unsupported and return 1; print nothing and return 0 when it is buildable
+support_matrix_reason() {
+    local tool=$1
+    local arch=$2
+    local libc=${3:-${LIBC_TYPE:-musl}}
+
+    local line
+    while IFS= read -r line; do
+        case "$line" in ''|'#'*) continue ;; esac
+
+        local rule_tool rule_libc rule_archs reason
+        IFS='|' read -r rule_tool rule_libc rule_archs reason <<< "$line"
+        rule_tool=$(echo $rule_tool)
+        rule_libc=$(echo $rule_libc)
+        [ "$rule_tool" = "$tool" ] || continue
+        if [ "$rule_libc" != "any" ] && [[ ",$rule_libc," != *",$libc,"* ]]; then
+            continue
+        fi
+
+        local glob allowed="" denied=false
+        set -f
+        for glob in $rule_archs; do
+            if [ "${glob#!}" != "$glob" ]; then
+                [[ "$arch" == ${glob#!} ]] && denied=true
+            else
+                [ -z "$allowed" ] && allowed=false
+                [[ "$arch" == $glob ]] && allowed=true
+            fi
+        done
+        set +f
+
+        if [ "$denied" = true ] || [ "$allowed" = false ]; then
+            echo $reason
+            return 1
+        fi
+    done <<< "$SUPPORT_MATRIX"
+
+    return 0
+}
+
+# support_matrix_allows <tool> <arch> [libc]
+support_matrix_allows() {
+    support_matrix_reason "$@" >/dev/null
+}
+
+# support_matrix_skip <tool> <arch> [libc] - for tool scripts: log the
+# reason and return 1 when the combination is unsupported
+support_matrix_skip() {
+    local reason
+    if reason=$(support_matrix_reason "$@"); then
+        return 1
+    fi
+    log_tool "$1" "SKIP: $2: $reason"
+    return 0
+}
+
+export SUPPORT_MATRIX
+export -f support_matrix_reason
+export -f support_matrix_allows
+export -f support_matrix_skip
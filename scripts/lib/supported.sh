@@ -18,6 +18,8 @@ SUPPORTED_SHARED_LIBS=(
     libdesock
     libtlsnoverify
     libcustom
+    libheapprof
+    libiotrace
 )
 
 export SUPPORTED_ARCHS
@@ -278,6 +278,12 @@ ensure_toolchain() {
         return 0
     fi
 
+    # --toolchain zig: zig cc and its bundled musl replace the GCC toolchain
+    if uses_zig_linux "$arch"; then
+        log "Zig backend covers $arch ($(get_zig_linux_target "$arch")), skipping toolchain download"
+        return 0
+    fi
+
     log "Checking toolchain availability for architecture: $arch"
 
     if arch_supports_musl "$arch"; then
@@ -4,6 +4,7 @@ if [ -z "$SCRIPT_DIR" ]; then
     SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
     source "$SCRIPT_DIR/common.sh"
 fi
+source "$(dirname "${BASH_SOURCE[0]}")/pgo.sh"
 
 
 parallel_make() {
@@ -28,6 +29,12 @@ build_tool() {
         echo "Build script not found for $tool: $script"
         return 1
     fi
+
+    # ./build --pgo: train the tool and build it with the profile
+    if [ "${PGO:-false}" = "true" ] && [ -z "${PGO_MODE:-}" ] && [ -n "$(pgo_training_script "$tool")" ]; then
+        pgo_build "$tool" "$arch"
+        return
+    fi
     
     if [ -n "$DEBUG" ]; then
         bash -x "$script" "$arch"
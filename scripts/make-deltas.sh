@@ -0,0 +1,192 @@
+#!/bin/bash
+# Build per-architecture delta bundles between two releases, so a field
+# device only receives what changed instead of the whole archive.
+#
+# Usage: make-deltas.sh <previous> <current-output> <dest-dir> [label]
+#
+#   <previous>        an earlier output/ tree, or a directory holding that
+#                     release's sthenos-<arch>-*.tar.xz archives
+#   <current-output>  the new output/ tree (usually ./output)
+#   <dest-dir>        where sthenos-<arch>-<label>.delta.tar files go
+#
+# Each bundle unpacks to <arch>-delta/ with an index (DELTA) and one patch
+# per changed or new file. Apply it on the target with the static `delta`
+# tool from the new release:
+#
+#   tar -xf sthenos-<arch>-<label>.delta.tar
+#   ./delta apply-bundle <arch>-delta /path/to/installed/<arch>
+#
+# Patches are made against the exact previous file and verified against
+# the new SHA-256 before anything is replaced. The diff engine is built
+# for the host from delta-tool/delta.c with $HOST_CC (default cc).
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+source "$SCRIPT_DIR/lib/logging.sh"
+
+DELTA_SRC="$SCRIPT_DIR/../delta-tool/delta.c"
+HOST_CC="${HOST_CC:-cc}"
+# Also xz the new arch tree to report the saving against a full archive
+DELTA_COMPARE_FULL="${DELTA_COMPARE_FULL:-true}"
+
+build_host_delta() {
+    local out=$1
+
+    if [ ! -f "$DELTA_SRC" ]; then
+        log_error "Delta source not found: $DELTA_SRC"
+        return 1
+    fi
+    $HOST_CC -O2 -DDELTA_WITH_DIFF -o "$out" "$DELTA_SRC" || {
+        log_error "Failed to build the host delta tool with $HOST_CC"
+        return 1
+    }
+}
+
+# previous_arch_dir <previous> <arch> <scratch> - print the directory with
+# the previous files for an arch, unpacking its archive if needed
+previous_arch_dir() {
+    local previous=$1
+    local arch=$2
+    local scratch=$3
+
+    if [ -d "$previous/$arch" ]; then
+        echo "$previous/$arch"
+        return 0
+    fi
+
+    local archive
+    archive=$(ls "$previous"/sthenos-"$arch"-*.tar.xz 2>/dev/null | head -1)
+    [ -n "$archive" ] || return 1
+
+    mkdir -p "$scratch/previous"
+    tar -xJf "$archive" -C "$scratch/previous" "$arch" || return 1
+    echo "$scratch/previous/$arch"
+}
+
+file_sha256() {
+    sha256sum "$1" | cut -d' ' -f1
+}
+
+# make_arch_bundle <delta-bin> <old-dir> <new-dir> <bundle-dir> - write the
+# index and patches; prints "changed added removed unchanged"
+make_arch_bundle() {
+    local delta=$1
+    local old_dir=$2
+    local new_dir=$3
+    local bundle=$4
+    local changed=0 added=0 removed=0 unchanged=0
+
+    mkdir -p "$bundle/patches"
+    local index="$bundle/DELTA"
+    echo "# sthenos-delta 1" > "$index"
+
+    local entry
+    while IFS= read -r entry; do
+        local new_file="$new_dir/$entry"
+        local old_file="$old_dir/$entry"
+        local new_sha=$(file_sha256 "$new_file")
+        local old_sha="-"
+        local base=/dev/null
+
+        if [ -f "$old_file" ]; then
+            old_sha=$(file_sha256 "$old_file")
+            if [ "$old_sha" = "$new_sha" ]; then
+                unchanged=$((unchanged + 1))
+                continue
+            fi
+            base=$old_file
+            changed=$((changed + 1))
+        else
+            added=$((added + 1))
+        fi
+
+        mkdir -p "$(dirname "$bundle/patches/$entry")"
+        "$delta" diff "$base" "$new_file" "$bundle/patches/$entry.sdp" > /dev/null || return 1
+        printf 'patch %s %s %s %s\n' "$(stat -c %a "$new_file")" "$old_sha" "$new_sha" "$entry" >> "$index"
+    done < <(cd "$new_dir" && find . -type f | sed 's|^\./||' | sort)
+
+    while IFS= read -r entry; do
+        [ -e "$new_dir/$entry" ] && continue
+        printf 'delete %s %s\n' "$(file_sha256 "$old_dir/$entry")" "$entry" >> "$index"
+        removed=$((removed + 1))
+    done < <(cd "$old_dir" && find . -type f | sed 's|^\./||' | sort)
+
+    echo "$changed $added $removed $unchanged"
+}
+
+main() {
+    if [ $# -lt 3 ]; then
+        echo "Usage: $0 <previous-output-or-archives> <current-output> <dest-dir> [label]" >&2
+        exit 1
+    fi
+
+    local previous=$1
+    local current=$2
+    local dest=$3
+    local label=${4:-delta}
+
+    if [ ! -d "$previous" ] || [ ! -d "$current" ]; then
+        log_error "Both <previous> and <current-output> must be directories"
+        exit 1
+    fi
+    mkdir -p "$dest"
+    dest=$(cd "$dest" && pwd)
+
+    local work=$(mktemp -d)
+    trap "rm -rf '$work'" EXIT
+
+    build_host_delta "$work/delta"
+
+    local summary="$dest/DELTA-SUMMARY.tsv"
+    printf 'arch\tchanged\tadded\tremoved\tunchanged\tbundle_bytes\tfull_xz_bytes\n' > "$summary"
+
+    local arch_dir
+    for arch_dir in "$current"/*/; do
+        local arch=$(basename "$arch_dir")
+        local scratch="$work/$arch"
+        mkdir -p "$scratch"
+
+        local old_dir
+        if ! old_dir=$(previous_arch_dir "$previous" "$arch" "$scratch"); then
+            log_warn "$arch: not in the previous release, ship the full archive"
+            continue
+        fi
+
+        local counts
+        if ! counts=$(make_arch_bundle "$work/delta" "$old_dir" "${arch_dir%/}" "$scratch/$arch-delta"); then
+            log_error "$arch: failed to create patches"
+            exit 1
+        fi
+        local changed added removed unchanged
+        read -r changed added removed unchanged <<< "$counts"
+
+        if [ $((changed + added + removed)) -eq 0 ]; then
+            log "$arch: unchanged, no bundle"
+            rm -rf "$scratch"
+            continue
+        fi
+
+        # Plain tar: the patches are already compressed
+        local bundle="$dest/sthenos-$arch-$label.delta.tar"
+        tar -cf "$bundle" -C "$scratch" "$arch-delta"
+        local bundle_bytes=$(stat -c %s "$bundle")
+
+        local full_bytes="-"
+        local ratio=""
+        if [ "$DELTA_COMPARE_FULL" = "true" ]; then
+            full_bytes=$(tar -cf - -C "$current" "$arch" | xz -T0 -c | wc -c)
+            ratio=$(awk -v b="$bundle_bytes" -v f="$full_bytes" \
+                'BEGIN { if (b > 0) printf ", %.1fx smaller than the full archive", f / b }')
+        fi
+
+        log "$arch: $changed changed, $added new, $removed removed, $unchanged unchanged -> $(basename "$bundle") ($bundle_bytes bytes$ratio)"
+        printf '%s\t%s\t%s\t%s\t%s\t%s\t%s\n' "$arch" "$changed" "$added" "$removed" \
+            "$unchanged" "$bundle_bytes" "$full_bytes" >> "$summary"
+        rm -rf "$scratch"
+    done
+
+    log "Summary: $summary"
+}
+
+main "$@"
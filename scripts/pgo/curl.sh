@@ -0,0 +1,36 @@
+#!/bin/bash
+# PGO training for curl and curl-full: large downloads from a loopback
+# HTTP server, plus a globbed run of small requests for the per-transfer
+# setup and header parsing paths.
+#
+# Usage: curl.sh <arch> <binary> <work_dir>  (run by pgo_train)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/bench_helpers.sh"
+
+arch=$1
+binary=$2
+work_dir=$3
+export RUN_TIMEOUT="${RUN_TIMEOUT:-600}"
+
+mkdir -p "$work_dir/www" "$work_dir/small"
+bench_make_payload "$work_dir/www/payload.bin" "${PGO_TRAIN_MB:-16}" || exit 1
+head -c 4096 "$work_dir/www/payload.bin" > "$work_dir/www/small.bin"
+
+port=$(bench_free_port)
+server=$(bench_start_http_server "$work_dir/www" "$port") || exit 1
+
+rc=0
+for run in 1 2 3; do
+    run_target "$arch" "$binary" -s --fail -o "$work_dir/fetched" \
+        "http://127.0.0.1:$port/payload.bin" || { rc=1; break; }
+    cmp -s "$work_dir/www/payload.bin" "$work_dir/fetched" || { rc=1; break; }
+done
+if [ $rc -eq 0 ]; then
+    run_target "$arch" "$binary" -s --fail -o "$work_dir/small/#1" \
+        "http://127.0.0.1:$port/small.bin?n=[1-200]" || rc=1
+fi
+
+bench_stop "$server"
+exit $rc
@@ -0,0 +1,50 @@
+#!/bin/bash
+# PGO training for ncat and ncat-ssl: a file pushed over loopback TCP in
+# both directions (listener receiving, then listener sending), with both
+# ends running the trained binary.
+#
+# Usage: ncat.sh <arch> <binary> <work_dir>  (run by pgo_train)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/bench_helpers.sh"
+
+arch=$1
+binary=$2
+work_dir=$3
+export RUN_TIMEOUT="${RUN_TIMEOUT:-600}"
+
+payload="$work_dir/payload.bin"
+bench_make_payload "$payload" "${PGO_TRAIN_MB:-16}" || exit 1
+
+# relay <listener_flag> <client_flag> - one transfer; the side with
+# --send-only reads the payload, the other writes what it receives
+relay() {
+    local listener_flag=$1
+    local client_flag=$2
+    local port=$(bench_free_port)
+    local listener
+
+    if [ "$listener_flag" = "--send-only" ]; then
+        run_target "$arch" "$binary" -l "$listener_flag" 127.0.0.1 "$port" < "$payload" > /dev/null 2>&1 &
+    else
+        run_target "$arch" "$binary" -l "$listener_flag" 127.0.0.1 "$port" > "$work_dir/received" 2> /dev/null &
+    fi
+    listener=$!
+    if ! bench_wait_port "$port" 30; then
+        bench_stop "$listener"
+        return 1
+    fi
+
+    if [ "$client_flag" = "--send-only" ]; then
+        run_target "$arch" "$binary" "$client_flag" 127.0.0.1 "$port" < "$payload" > /dev/null 2>&1 || return 1
+    else
+        run_target "$arch" "$binary" "$client_flag" 127.0.0.1 "$port" > "$work_dir/received" 2> /dev/null || return 1
+    fi
+    # The listener writes its profile on exit
+    wait "$listener" || return 1
+    cmp -s "$payload" "$work_dir/received"
+}
+
+relay --recv-only --send-only || exit 1
+relay --send-only --recv-only || exit 1
@@ -0,0 +1,33 @@
+#!/bin/bash
+# PGO training for the openssl CLI: digests and an encrypt/decrypt round
+# trip over a payload, plus short speed runs of AES-GCM, RSA and ECDH for
+# the EVP and bignum paths the file commands don't reach.
+#
+# Usage: openssl.sh <arch> <binary> <work_dir>  (run by pgo_train)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/bench_helpers.sh"
+
+arch=$1
+binary=$2
+work_dir=$3
+export RUN_TIMEOUT="${RUN_TIMEOUT:-600}"
+
+payload="$work_dir/payload.bin"
+bench_make_payload "$payload" "${PGO_TRAIN_MB:-16}" || exit 1
+
+for digest in sha256 sha1 sha512 md5; do
+    run_target "$arch" "$binary" dgst "-$digest" "$payload" > /dev/null || exit 1
+done
+
+for cipher in aes-128-cbc chacha20; do
+    run_target "$arch" "$binary" enc "-$cipher" -pbkdf2 -pass pass:pgo \
+        -in "$payload" -out "$work_dir/payload.enc" || exit 1
+    run_target "$arch" "$binary" enc -d "-$cipher" -pbkdf2 -pass pass:pgo \
+        -in "$work_dir/payload.enc" -out "$work_dir/payload.dec" || exit 1
+    cmp -s "$payload" "$work_dir/payload.dec" || exit 1
+done
+
+run_target "$arch" "$binary" speed -seconds 1 -bytes 16384 -evp aes-128-gcm > /dev/null 2>&1 || exit 1
+run_target "$arch" "$binary" speed -seconds 1 rsa2048 ecdhp256 > /dev/null 2>&1 || exit 1
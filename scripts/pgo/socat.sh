@@ -0,0 +1,34 @@
+#!/bin/bash
+# PGO training for socat and socat-ssl: a file relayed over loopback TCP
+# (both ends are the trained binary) and file-to-file copies with the
+# default and a large transfer block.
+#
+# Usage: socat.sh <arch> <binary> <work_dir>  (run by pgo_train)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/bench_helpers.sh"
+
+arch=$1
+binary=$2
+work_dir=$3
+export RUN_TIMEOUT="${RUN_TIMEOUT:-600}"
+
+payload="$work_dir/payload.bin"
+bench_make_payload "$payload" "${PGO_TRAIN_MB:-16}" || exit 1
+
+port=$(bench_free_port)
+run_target "$arch" "$binary" -u "TCP-LISTEN:$port,bind=127.0.0.1,reuseaddr" \
+    "OPEN:$work_dir/received,creat,trunc" > /dev/null 2>&1 &
+listener=$!
+if ! bench_wait_port "$port" 30; then
+    bench_stop "$listener"
+    exit 1
+fi
+run_target "$arch" "$binary" -u "OPEN:$payload,rdonly" "TCP:127.0.0.1:$port" || exit 1
+# The listener writes its profile on exit
+wait "$listener" || exit 1
+cmp -s "$payload" "$work_dir/received" || exit 1
+
+run_target "$arch" "$binary" -u "OPEN:$payload,rdonly" "GOPEN:/dev/null" || exit 1
+run_target "$arch" "$binary" -u -b 131072 "OPEN:$payload,rdonly" "GOPEN:/dev/null" || exit 1
@@ -0,0 +1,24 @@
+#!/bin/bash
+# PGO training for tcpdump: replay a synthetic capture (Ethernet/IPv4 with
+# TCP/HTTP and UDP/DNS, as bench_make_pcap writes it) through the
+# dissectors verbose and terse, through a BPF filter, as hex dumps and
+# into a new capture file.
+#
+# Usage: tcpdump.sh <arch> <binary> <work_dir>  (run by pgo_train)
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/bench_helpers.sh"
+
+arch=$1
+binary=$2
+work_dir=$3
+export RUN_TIMEOUT="${RUN_TIMEOUT:-600}"
+
+pcap="$work_dir/training.pcap"
+bench_make_pcap "$pcap" "${PGO_TRAIN_PACKETS:-50000}" || exit 1
+
+run_target "$arch" "$binary" -nn -vvv -r "$pcap" > /dev/null || exit 1
+run_target "$arch" "$binary" -q -r "$pcap" 'tcp port 80 or udp port 53' > /dev/null || exit 1
+run_target "$arch" "$binary" -nn -x -c 10000 -r "$pcap" > /dev/null || exit 1
+run_target "$arch" "$binary" -r "$pcap" -w "$work_dir/filtered.pcap" 'tcp' 2> /dev/null || exit 1
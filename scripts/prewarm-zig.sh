@@ -0,0 +1,130 @@
+#!/bin/bash
+# Pre-build Zig's bundled libc (musl, mingw-w64, BSD and Darwin shims) and
+# compiler-rt for each Zig target, so the first real build of a target
+# starts from a hot global cache instead of compiling them itself.
+#
+# Each target links a small program with the same flags the tool builds
+# use, once per optimization profile (speed and size), since Zig caches the
+# libc and compiler-rt builds per target, optimize mode and PIC setting.
+# Targets run in parallel; Zig locks its cache entries, so concurrent
+# compilers for one target wait for each other instead of racing.
+#
+# The cache lives in ZIG_GLOBAL_CACHE_DIR (the zig-cache volume that
+# ./build mounts at /build/zig-cache).
+#
+# Usage: prewarm-zig.sh [zig_arch...]
+#   With no arguments, every ZIG_PREWARM_ARCHS x primary OS combination,
+#   e.g. x86_64_windows aarch64_macos. Linux arch names (aarch64, mips32le)
+#   work with TOOLCHAIN_BACKEND=zig.
+
+set -uo pipefail
+
+PREWARM_SCRIPT="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)/$(basename "${BASH_SOURCE[0]}")"
+PREWARM_LIB_DIR="$(dirname "$PREWARM_SCRIPT")/lib"
+source "$PREWARM_LIB_DIR/common.sh"
+source "$PREWARM_LIB_DIR/core/os_targets.sh"
+
+ZIG_PREWARM_ARCHS="${ZIG_PREWARM_ARCHS:-x86_64 aarch64}"
+ZIG_PREWARM_PROFILES="${ZIG_PREWARM_PROFILES:-speed size}"
+PARALLEL_JOBS="${ZIG_PREWARM_JOBS:-$(nproc)}"
+
+export ZIG_GLOBAL_CACHE_DIR="${ZIG_GLOBAL_CACHE_DIR:-/build/zig-cache/global}"
+export ZIG_LOCAL_CACHE_DIR="${ZIG_LOCAL_CACHE_DIR:-/build/zig-cache/local}"
+
+# default_prewarm_targets - ZIG_PREWARM_ARCHS crossed with the primary OS
+# targets; android builds as a linux target, so it adds nothing
+default_prewarm_targets() {
+    local arch os
+    for arch in $ZIG_PREWARM_ARCHS; do
+        for os in "${PRIMARY_OS_TARGETS[@]}"; do
+            [ "$os" = "android" ] && continue
+            echo "${arch}_${os}"
+        done
+    done
+}
+
+# prewarm_zig_target <zig_arch> - link a test program for the target in each
+# profile; prints "OK <arch> <triple> <seconds>", "SKIP <arch> <reason>" or
+# "FAIL <arch> <triple>"
+prewarm_zig_target() {
+    local arch=$1
+    local start=$(date +%s)
+
+    (
+        if ! setup_arch "$arch" >/dev/null 2>&1; then
+            echo "SKIP $arch no bundled libc"
+            exit 0
+        fi
+        local triple=${CC##*-target }
+        local work_dir=$(mktemp -d)
+        trap 'rm -rf "$work_dir"' EXIT
+
+        cat > "$work_dir/prewarm.c" << 'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    char *copy = strdup(argc > 0 ? argv[0] : "");
+    printf("%s %llu\n", copy, (unsigned long long)strlen(copy) / 3);
+    free(copy);
+    return 0;
+}
+EOF
+
+        local profile
+        for profile in $ZIG_PREWARM_PROFILES; do
+            local cflags=$(OPT_PROFILE=$profile get_compile_flags "$arch" "static" "prewarm")
+            local ldflags=$(get_link_flags "$arch" "static")
+            if ! $CC $cflags "$work_dir/prewarm.c" -o "$work_dir/prewarm" $ldflags \
+                > "$work_dir/log" 2>&1; then
+                echo "FAIL $arch $triple ($profile): $(head -1 "$work_dir/log")"
+                exit 1
+            fi
+        done
+
+        echo "OK $arch $triple $(( $(date +%s) - start ))s"
+    )
+}
+
+main() {
+    local targets=("$@")
+    if [ ${#targets[@]} -eq 0 ]; then
+        mapfile -t targets < <(default_prewarm_targets)
+    fi
+
+    if ! command -v zig >/dev/null 2>&1; then
+        log_error "zig not found in PATH"
+        return 1
+    fi
+
+    mkdir -p "$ZIG_GLOBAL_CACHE_DIR" "$ZIG_LOCAL_CACHE_DIR"
+    log "Pre-warming the Zig cache for ${#targets[@]} targets ($PARALLEL_JOBS parallel jobs)"
+    log "Cache: $ZIG_GLOBAL_CACHE_DIR ($(du -sh "$ZIG_GLOBAL_CACHE_DIR" 2>/dev/null | cut -f1) before)"
+
+    # Each worker is a fresh instance of this script (--one), so it gets
+    # the compile flag helpers without exporting them
+    local results=$(printf '%s\n' "${targets[@]}" \
+        | xargs -P "$PARALLEL_JOBS" -I {} bash "$PREWARM_SCRIPT" --one {})
+
+    local status arch rest failed=0
+    while read -r status arch rest; do
+        case "$status" in
+            OK)   log "  $arch: $rest" ;;
+            SKIP) log_warn "  $arch: skipped, $rest" ;;
+            *)    log_error "  $arch: $rest"; failed=$((failed + 1)) ;;
+        esac
+    done <<< "$results"
+
+    log "Cache: $ZIG_GLOBAL_CACHE_DIR ($(du -sh "$ZIG_GLOBAL_CACHE_DIR" 2>/dev/null | cut -f1) after)"
+    [ $failed -eq 0 ] || log_warn "$failed targets failed; their first build compiles libc itself"
+    return 0
+}
+
+if [ "${1:-}" = "--one" ]; then
+    prewarm_zig_target "$2"
+    exit $?
+fi
+
+main "$@"
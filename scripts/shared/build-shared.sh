@@ -150,6 +150,9 @@ build_shared_library() {
 TOTAL=0
 FAILED=0
 SKIPPED=0
+KNOWN_FAILED=0
+
+failure_cache_init
 
 for lib in $LIBS_TO_BUILD; do
     for arch in $ARCHS_TO_BUILD; do
@@ -180,6 +183,21 @@ for lib in $LIBS_TO_BUILD; do
             # Export LIBC_TYPE for the build scripts
             export LIBC_TYPE="$libc_type"
             
+            if ! reason=$(support_matrix_reason "$lib" "$arch" "$libc_type"); then
+                log_tool "$arch" "[$COUNT/$TOTAL] SKIP: $lib: $reason"
+                SKIPPED=$((SKIPPED + 1))
+                echo
+                continue
+            fi
+            
+            fingerprint=$(failure_fingerprint "$lib" "$arch" "$libc_type" "${SHARED_LIB_SCRIPTS[$lib]}")
+            if known=$(failure_cache_check "$lib" "$arch" "$libc_type" "$fingerprint"); then
+                log_tool "$arch" "[$COUNT/$TOTAL] SKIP: $lib with $libc_type failed at ${known%% *} with the same inputs (log: ${known#* }); --retry-failed to try again"
+                KNOWN_FAILED=$((KNOWN_FAILED + 1))
+                echo
+                continue
+            fi
+            
             log_tool "$arch" "[$COUNT/$TOTAL] Building $lib with $libc_type..."
             
             build_shared_library "$lib" "$arch" "$LOG_ENABLED" "$DEBUG"
@@ -187,12 +205,15 @@ for lib in $LIBS_TO_BUILD; do
             
             if [ $ret -eq 0 ]; then
                 log_tool "$arch" "[$COUNT/$TOTAL] SUCCESS: Built $lib with $libc_type"
+                failure_cache_clear "$lib" "$arch" "$libc_type"
             elif [ $ret -eq 2 ]; then
                 log_debug "Skipped $lib for $arch with $libc_type (unsupported)"
                 SKIPPED=$((SKIPPED + 1))
             else
                 log_tool "$arch" "[$COUNT/$TOTAL] ERROR: Failed to build $lib with $libc_type"
                 FAILED=$((FAILED + 1))
+                last_log=$(ls -t "$LOGS_DIR"/"$lib"-"$arch"-"$libc_type"-*.log 2>/dev/null | head -1)
+                failure_cache_record "$lib" "$arch" "$libc_type" "$fingerprint" "${last_log#/build/}"
             fi
             echo
         done
@@ -201,8 +222,9 @@ done
 
 echo "Build Summary"
 echo "Total: $TOTAL"
-echo "Successful: $((TOTAL - FAILED - SKIPPED))"
+echo "Successful: $((TOTAL - FAILED - SKIPPED - KNOWN_FAILED))"
 echo "Skipped (unsupported arch/libc): $SKIPPED"
+echo "Skipped (known failures): $KNOWN_FAILED"
 if [ $FAILED -gt 0 ]; then
     log_error "Failed: $FAILED"
 fi
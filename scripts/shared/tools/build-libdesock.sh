@@ -13,6 +13,34 @@ TOOL_NAME="libdesock"
 LIBDESOCK_URL="https://github.com/f0rw4rd/libdesock/archive/refs/heads/master.tar.gz"
 LIBDESOCK_SHA512="4668cb5697bad73747cb972f0b3ba8742eb71133c24e1b6022aa35476d057e6010d594ec45ce50d5e0deb2c9c323801ddd2a88e740a7f11951903b89611eb3c9"
 
+# Build-time knobs. Smaller tables mean less to set up on every exec of a
+# fuzzed target; MAX_CONNS bounds how many accept()s one input can feed,
+# split on REQUEST_DELIMITER. A build with other values is still written to
+# libdesock.so, so rebuild with -f when changing them.
+DESOCK_FD_TABLE_SIZE="${DESOCK_FD_TABLE_SIZE:-128}"
+DESOCK_MAX_CONNS="${DESOCK_MAX_CONNS:-128}"
+DESOCK_REQUEST_DELIMITER="${DESOCK_REQUEST_DELIMITER:--=^..^=-}"
+
+validate_desock_options() {
+    local var
+    for var in DESOCK_FD_TABLE_SIZE DESOCK_MAX_CONNS; do
+        if ! [[ "${!var}" =~ ^[1-9][0-9]*$ ]]; then
+            log_error "$var must be a positive integer (got '${!var}')"
+            return 1
+        fi
+    done
+    if [ "$DESOCK_MAX_CONNS" -gt "$DESOCK_FD_TABLE_SIZE" ]; then
+        log_error "DESOCK_MAX_CONNS ($DESOCK_MAX_CONNS) exceeds DESOCK_FD_TABLE_SIZE ($DESOCK_FD_TABLE_SIZE)"
+        return 1
+    fi
+    # Spliced into CFLAGS as a C string literal
+    if [ -z "$DESOCK_REQUEST_DELIMITER" ] || [[ "$DESOCK_REQUEST_DELIMITER" =~ [[:space:]\"\'\\] ]]; then
+        log_error "DESOCK_REQUEST_DELIMITER must be non-empty, without whitespace, quotes or backslashes"
+        return 1
+    fi
+    return 0
+}
+
 get_desock_arch() {
     local arch="$1"
 
@@ -52,7 +80,15 @@ main() {
     fi
     
     arch=$(map_arch_name "$arch")
-    
+
+    validate_desock_options || return 1
+
+    # Arches get_desock_arch cannot map are in scripts/lib/support_matrix.sh,
+    # so this fails before any toolchain or download work
+    if support_matrix_skip "libdesock" "$arch"; then
+        return 2
+    fi
+
     # Check if toolchain is available
     if ! check_toolchain_availability "$arch"; then
         return 2
@@ -145,10 +181,10 @@ main() {
     # runtime can report which syscall flavor it was compiled against.
     cflags="$cflags -Isrc/include -Isrc/include/arch/$desock_arch"
     cflags="$cflags -DSHARED -DDESOCK_BIND"
-    cflags="$cflags -DFD_TABLE_SIZE=128 -DMAX_CONNS=128"
+    cflags="$cflags -DFD_TABLE_SIZE=$DESOCK_FD_TABLE_SIZE -DMAX_CONNS=$DESOCK_MAX_CONNS"
     cflags="$cflags -DDESOCKARCH=\"$desock_arch\""
     cflags="$cflags -DINTERPRETER=\"$interpreter\""
-    cflags="$cflags -DREQUEST_DELIMITER=\"-=^..^=-\""
+    cflags="$cflags -DREQUEST_DELIMITER=\"$DESOCK_REQUEST_DELIMITER\""
 
     # libdesock's main.c installs __libdesock_main via -Wl,-e so the .so is also
     # runnable; it also uses pthread primitives (dependency('threads') in meson).
@@ -163,21 +199,38 @@ main() {
         src/sendfile.c src/shutdown.c src/sockopt.c src/write.c
     )
 
-    log "Compiling libdesock (${#sources[@]} sources, arch=$desock_arch)..."
+    local jobs=$(nproc 2>/dev/null || echo 2)
+    log "Compiling libdesock (${#sources[@]} sources, arch=$desock_arch, -j$jobs)..."
+    log "  FD_TABLE_SIZE=$DESOCK_FD_TABLE_SIZE MAX_CONNS=$DESOCK_MAX_CONNS REQUEST_DELIMITER=$DESOCK_REQUEST_DELIMITER"
 
-    local objs=()
-    local s obj
+    # One compiler per CPU; each job's diagnostics go to <obj>.log and are
+    # printed for the sources that failed
+    local objs=() pids=()
+    local s obj i
     for s in "${sources[@]}"; do
         obj="${s##*/}"
         obj="${obj%.c}.o"
-        if ! $CC $cflags -c "$s" -o "$obj"; then
-            log_error "Compilation failed for $s"
-            cleanup_build_dir "$build_dir"
-            return 1
-        fi
+        $CC $cflags -c "$s" -o "$obj" > "$obj.log" 2>&1 &
+        pids+=($!)
         objs+=("$obj")
+        while [ "$(jobs -rp | wc -l)" -ge "$jobs" ]; do
+            wait -n || true
+        done
     done
 
+    local failed=0
+    for i in "${!pids[@]}"; do
+        if ! wait "${pids[$i]}"; then
+            log_error "Compilation failed for ${sources[$i]}"
+            cat "${objs[$i]}.log" >&2
+            failed=1
+        fi
+    done
+    if [ $failed -ne 0 ]; then
+        cleanup_build_dir "$build_dir"
+        return 1
+    fi
+
     log "Linking libdesock.so..."
     if ! $CC $ldflags -o libdesock.so "${objs[@]}" -lpthread -ldl; then
         log_error "Linking failed"
@@ -13,6 +13,7 @@ source "$BASE_DIR/scripts/lib/core/arch_helper.sh"
 source "$BASE_DIR/scripts/lib/logging.sh"
 source "$BASE_DIR/scripts/lib/core/compile_flags.sh"
 source "$BASE_DIR/scripts/lib/tools.sh"
+source "$BASE_DIR/scripts/lib/dependency_builder.sh"
 
 setup_arch_glibc() {
     local canonical_arch="$1"
@@ -124,6 +125,7 @@ do_static_build() {
     fi
     
     if [ "$libc" = "glibc" ]; then
+        unset STRING_ROUTINES_DIR
         local log_file=""
         if [ "$log_enabled" = "true" ]; then
             log_file="${LOGS_DIR}/build-${tool}-${canonical_arch}-$(date +%Y%m%d-%H%M%S).log"
@@ -161,6 +163,10 @@ do_static_build() {
             return 1
         fi
 
+        if [ -n "$(get_string_routines "$canonical_arch" 2>/dev/null)" ]; then
+            prepare_string_routines "$canonical_arch"
+        fi
+
         if [ "$debug" = "1" ]; then
             log_tool "$canonical_arch" "DEBUG: CC=$CC, PATH=$PATH"
         fi
@@ -193,6 +199,23 @@ do_static_build() {
     fi
 }
 
+# Section/symbol size report for one arch, using that arch's binutils
+run_static_size_report() {
+    local arch="$1"
+    local libc="${2:-musl}"
+
+    (
+        if [ "$libc" = "glibc" ]; then
+            TOOLCHAINS_DIR="$GLIBC_TOOLCHAINS_DIR"
+            setup_arch_glibc "$arch"
+        else
+            [ "$libc" = "uclibc" ] && export LIBC_TYPE="uclibc"
+            setup_arch "$arch"
+        fi >/dev/null 2>&1
+        run_size_report "$arch"
+    )
+}
+
 configure_static_build_env() {
     local libc="${1:-musl}"
     
@@ -306,8 +329,20 @@ run_static_builds() {
     echo "Logging: $log_enabled"
     echo ""
     
-    echo "Checking toolchain availability for architectures: ${ARCHS_TO_BUILD[@]}"
-    if ! ensure_toolchains "${ARCHS_TO_BUILD[@]}"; then
+    # Only fetch toolchains for archs where at least one requested tool is
+    # in the support matrix
+    local TOOLCHAIN_ARCHS=()
+    for arch in "${ARCHS_TO_BUILD[@]}"; do
+        for tool in "${TOOLS_TO_BUILD[@]}"; do
+            if support_matrix_allows "$tool" "$arch" "$libc"; then
+                TOOLCHAIN_ARCHS+=("$arch")
+                break
+            fi
+        done
+    done
+    
+    echo "Checking toolchain availability for architectures: ${TOOLCHAIN_ARCHS[@]}"
+    if [ ${#TOOLCHAIN_ARCHS[@]} -gt 0 ] && ! ensure_toolchains "${TOOLCHAIN_ARCHS[@]}"; then
         log_error "Failed to ensure toolchains are available"
         return 1
     fi
@@ -316,19 +351,54 @@ run_static_builds() {
     local TOTAL_BUILDS=$((${#TOOLS_TO_BUILD[@]} * ${#ARCHS_TO_BUILD[@]}))
     local COMPLETED=0
     local FAILED=0
+    local UNSUPPORTED=()
+    local KNOWN_FAILURES=()
     local START_TIME=$(date +%s)
+    # Tool scripts that build several outputs from one tree (busybox) use
+    # these to tell what this run still needs
+    export BUILD_RUN_START=$START_TIME
+    export BUILD_TOOLS="${TOOLS_TO_BUILD[*]}"
+    
+    failure_cache_init
     
     for tool in "${TOOLS_TO_BUILD[@]}"; do
         for arch in "${ARCHS_TO_BUILD[@]}"; do
+            # Structural no-gos are settled before any toolchain work
+            local reason
+            if ! reason=$(support_matrix_reason "$tool" "$arch" "$libc"); then
+                log_tool "$arch" "SKIP: $tool: $reason"
+                UNSUPPORTED+=("$tool/$arch")
+                continue
+            fi
+            
+            local fingerprint=$(failure_fingerprint "$tool" "$arch" "$libc" "${TOOL_SCRIPTS[$tool]}")
+            local known
+            if known=$(failure_cache_check "$tool" "$arch" "$libc" "$fingerprint"); then
+                log_tool "$arch" "SKIP: $tool failed at ${known%% *} with the same inputs (log: ${known#* }); --retry-failed to try again"
+                KNOWN_FAILURES+=("$tool/$arch")
+                continue
+            fi
+            
             if do_static_build "$tool" "$arch" "$libc" "$mode" "$log_enabled" "$debug"; then
                 COMPLETED=$((COMPLETED + 1))
+                failure_cache_clear "$tool" "$arch" "$libc"
             else
                 FAILED=$((FAILED + 1))
+                local last_log=$(ls -t "$LOGS_DIR"/build-"$tool"-"$arch"-*.log 2>/dev/null | head -1)
+                failure_cache_record "$tool" "$arch" "$libc" "$fingerprint" "${last_log#/build/}"
             fi
         done
         echo
     done
     
+    local SIZE_REGRESSION=false
+    if [ "${SIZE_REPORT:-true}" = "true" ] && [ $COMPLETED -gt 0 ]; then
+        for arch in "${ARCHS_TO_BUILD[@]}"; do
+            run_static_size_report "$arch" "$libc" || SIZE_REGRESSION=true
+        done
+        echo
+    fi
+    
     local END_TIME=$(date +%s)
     local BUILD_TIME=$((END_TIME - START_TIME))
     local BUILD_MINS=$((BUILD_TIME / 60))
@@ -337,11 +407,18 @@ run_static_builds() {
     echo "Total builds: $TOTAL_BUILDS"
     echo "Successful: $COMPLETED"
     echo "Failed: $FAILED"
+    echo "Skipped (unsupported): ${#UNSUPPORTED[@]}${UNSUPPORTED:+ (${UNSUPPORTED[*]})}"
+    echo "Skipped (known failures): ${#KNOWN_FAILURES[@]}${KNOWN_FAILURES:+ (${KNOWN_FAILURES[*]})}"
     echo "Build time: ${BUILD_MINS}m ${BUILD_SECS}s"
     
     log_info "Cleaning up empty directories..."
     find ${OUTPUT_DIR} -type d -empty -delete 2>/dev/null || true
     
+    if [ "$SIZE_REGRESSION" = true ]; then
+        log_error "Size regression above ${SIZE_GROWTH_THRESHOLD}% (SIZE_GROWTH_FAIL=true)"
+        return 1
+    fi
+    
     # Return success if at least one build succeeded
     if [ $COMPLETED -gt 0 ]; then
         return 0
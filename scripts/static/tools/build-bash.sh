@@ -51,11 +51,12 @@ build_bash() {
         return 1
     }
     
-    make -j$(nproc) || {
+    make -j$(nproc) $(link_map_make_args "$arch" "$TOOL_NAME") || {
         cleanup_build_dir "$build_dir"
         return 1
     }
     
+    save_symbol_sizes bash "$arch" "bash"
     $STRIP bash
     local output_path=$(get_output_path "$arch" "bash")
     mkdir -p "$(dirname "$output_path")"
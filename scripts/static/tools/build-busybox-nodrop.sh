@@ -1,6 +1,7 @@
 #!/bin/bash
 # busybox_nodrop: Delegates to build-busybox.sh with "nodrop" variant
-# This avoids duplicating busybox build logic. See build-busybox.sh for details.
+# This avoids duplicating busybox build logic. See build-busybox.sh for details;
+# both variants are installed from one tree, so after `busybox` this is a no-op.
 # SUPPORTED_OS="linux,android" inherited from build-busybox.sh
 set -e
 
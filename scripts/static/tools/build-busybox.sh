@@ -6,113 +6,277 @@ LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/sc
 source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
+source "$LIB_DIR/host_tools_cache.sh"
 
 SUPPORTED_OS="linux,android"  # BusyBox is Unix-specific
 BUSYBOX_VERSION="${BUSYBOX_VERSION:-1.37.0}"
 BUSYBOX_URL="https://busybox.net/downloads/busybox-${BUSYBOX_VERSION}.tar.bz2"
 BUSYBOX_SHA512="ad8fd06f082699774f990a53d7a73b189ed404fe0a2166aff13eae4d9d8ee5c9239493befe949c98801fe7897520dbff3ed0224faa7205854ce4fa975e18467e"
+BUSYBOX_CONFIG_CACHE="${BUSYBOX_CONFIG_CACHE:-/build/deps-cache/busybox-config}"
 
+# Host side of Kbuild (fixdep, the kconfig programs): one host compiler and
+# flag set for every arch, given on the make command line so neither the
+# target flags nor Makefile defaults change it. The cached host tools are
+# keyed on it and fit every tree.
+BUSYBOX_HOSTCFLAGS="-O2"
+BUSYBOX_HOST_MAKE=(HOSTCC=/usr/bin/gcc "HOSTCFLAGS=$BUSYBOX_HOSTCFLAGS" HOSTLDFLAGS=)
+
+# busybox_config_fragment <arch> - what this repo changes on top of
+# `make defconfig`, in .config syntax
+busybox_config_fragment() {
+    local arch=$1
+
+    cat << 'EOF'
+CONFIG_STATIC=y
+# CONFIG_BUILD_LIBBUSYBOX is not set
+# CONFIG_FEATURE_SHARED_BUSYBOX is not set
+EOF
+
+    case "$arch" in
+        x86_64|i486|ix86le) ;;
+        *)
+            echo "# CONFIG_SHA1_HWACCEL is not set"
+            echo "# CONFIG_SHA256_HWACCEL is not set"
+            ;;
+    esac
+
+    # riscv32 (rv32) lacks __NR_settimeofday in its syscall table; disable hwclock
+    # which unconditionally references SYS_settimeofday in util-linux/hwclock.c.
+    if [ "$arch" = "riscv32" ]; then
+        echo "# CONFIG_HWCLOCK is not set"
+        echo "# CONFIG_FEATURE_HWCLOCK_LONG_OPTIONS is not set"
+        echo "# CONFIG_FEATURE_HWCLOCK_ADJTIME_FHS is not set"
+    fi
+}
+
+# merge_config_fragment <fragment> - replace every symbol the fragment
+# mentions in ./.config with the fragment's line
+merge_config_fragment() {
+    local fragment=$1
+
+    awk '
+        NR == FNR {
+            if (match($0, /CONFIG_[A-Za-z0-9_]+/))
+                override[substr($0, RSTART, RLENGTH)] = 1
+            lines[++n] = $0
+            next
+        }
+        match($0, /CONFIG_[A-Za-z0-9_]+/) && (substr($0, RSTART, RLENGTH) in override) { next }
+        { print }
+        END { for (i = 1; i <= n; i++) print lines[i] }
+    ' "$fragment" .config > .config.merged && mv .config.merged .config
+}
+
+# prepare_busybox_config <arch> - write ./.config: defconfig plus the arch
+# fragment, cached per busybox version and fragment content so later
+# builds (and every arch sharing the fragment) skip the defconfig pass
+prepare_busybox_config() {
+    local arch=$1
+    local fragment=".config.fragment"
+
+    busybox_config_fragment "$arch" > "$fragment"
+    local key=$(sha256sum < "$fragment" | cut -c1-16)
+    local cached="$BUSYBOX_CONFIG_CACHE/$BUSYBOX_VERSION/$key.config"
+
+    if [ -s "$cached" ]; then
+        cp "$cached" .config
+        log_tool "busybox" "Using cached .config ($key) for $arch"
+        return 0
+    fi
+
+    make "${BUSYBOX_HOST_MAKE[@]}" defconfig > /dev/null || return 1
+    merge_config_fragment "$fragment" || return 1
+
+    if mkdir -p "$(dirname "$cached")" 2>/dev/null; then
+        cp .config "$cached.tmp.$$" 2>/dev/null && mv "$cached.tmp.$$" "$cached" 2>/dev/null || true
+    fi
+}
+
+# apply_nodrop - turn BB_SUID_DROP into BB_SUID_MAYBE in the //applet:
+# lines. The build only reads those comments to generate the applet
+# tables, so each file keeps its mtime: make regenerates the tables and
+# rebuilds appletlib instead of every object with an edited applet line.
+apply_nodrop() {
+    local file count=0
+
+    while IFS= read -r file; do
+        touch -r "$file" "$file.mtime"
+        sed -i 's/\(applet:.*\)BB_SUID_DROP/\1BB_SUID_MAYBE/g' "$file"
+        touch -r "$file.mtime" "$file"
+        rm -f "$file.mtime"
+        count=$((count + 1))
+    done < <(grep -rl --include='*.c' -e "applet:.*BB_SUID_DROP" . || true)
+
+    log_tool "busybox" "Applied nodrop modifications to $count source files"
+}
+
+# install_busybox <arch> <output_name> - copy ./busybox out and strip the
+# copy; the tree keeps its binary for the incremental nodrop make
+install_busybox() {
+    local arch=$1
+    local output_name=$2
+    local output_path=$(get_output_path "$arch" "$output_name")
+
+    # busybox is a stripped copy; scripts/trylink leaves the map of the
+    # real link next to busybox_unstripped
+    save_symbol_sizes busybox_unstripped "$arch" "$output_name" busybox_unstripped.map
+    mkdir -p "$(dirname "$output_path")"
+    cp busybox "$output_path"
+    $STRIP "$output_path"
+
+    log_tool "busybox" "Built $output_name successfully for $arch ($(get_binary_size "$output_path"))"
+}
+
+# busybox_output_current <arch> <output_name> - the output exists and can
+# stay: SKIP_IF_EXISTS keeps it, or it was built earlier in this run
+# (BUILD_RUN_START, set by build-static.sh), even under -f
+busybox_output_current() {
+    local output_path=$(get_output_path "$1" "$2")
+
+    [ -s "$output_path" ] || return 1
+    [ "${SKIP_IF_EXISTS:-true}" = "true" ] && return 0
+    [ -n "${BUILD_RUN_START:-}" ] && [ "$(stat -c %Y "$output_path")" -ge "$BUILD_RUN_START" ]
+}
+
+# build_busybox <arch> [standard|nodrop|both]
+#
+# Only variants whose output is not current are built. When this run also
+# asks for the other variant (BUILD_TOOLS) and it is not current either,
+# both come out of one tree: the standard build, then nodrop as an
+# incremental rebuild of the applet tables and the final link, so the
+# planner's second busybox job finds its binary in place.
 build_busybox() {
     local arch=$1
     local variant="${2:-standard}"
-    local build_dir=$(create_build_dir "busybox" "${arch}-${variant}")
     local TOOL_NAME="busybox"
-    
+
     # Check OS compatibility
     if ! check_tool_support "$SUPPORTED_OS" "$TOOL_NAME"; then
         return 1
     fi
-    local output_name="busybox"
-    
-    if [ "$variant" = "nodrop" ]; then
-        output_name="busybox_nodrop"
-    fi
-    
-    local output_path=$(get_output_path "$arch" "$output_name")
-    if [ -f "$output_path" ] && [ "${SKIP_IF_EXISTS:-true}" = "true" ]; then
-        local size=$(get_binary_size "$output_path")
-        log "[$arch] Already built: $output_path ($size)"
-        return 0
+
+    local wanted
+    case "$variant" in
+        standard) wanted="busybox" ;;
+        nodrop)   wanted="busybox_nodrop" ;;
+        both)     wanted="busybox busybox_nodrop" ;;
+        *)
+            log_tool_error "busybox" "Unknown variant '$variant' (standard, nodrop, both)"
+            return 1
+            ;;
+    esac
+
+    local name build_standard=false build_nodrop=false requested_stale=false
+    for name in busybox busybox_nodrop; do
+        local requested=false
+        case " $wanted " in *" $name "*) requested=true ;; esac
+
+        if busybox_output_current "$arch" "$name"; then
+            if [ "$requested" = true ]; then
+                local output_path=$(get_output_path "$arch" "$name")
+                log "[$arch] Already built: $output_path ($(get_binary_size "$output_path"))"
+            fi
+            continue
+        fi
+        [ "$requested" = false ] || requested_stale=true
+        # The sibling variant only rides along when this run wants it too
+        if [ "$requested" = true ] || [[ " ${BUILD_TOOLS:-} " == *" $name "* ]]; then
+            case "$name" in
+                busybox)        build_standard=true ;;
+                busybox_nodrop) build_nodrop=true ;;
+            esac
+        fi
+    done
+
+    [ "$requested_stale" = true ] || return 0
+
+    if [ "$build_standard" = true ] && [ "$build_nodrop" = true ]; then
+        log_tool "busybox" "Building standard and nodrop variants for $arch..."
+    elif [ "$build_standard" = true ]; then
+        log_tool "busybox" "Building standard variant for $arch..."
+    else
+        log_tool "busybox" "Building nodrop variant for $arch..."
     fi
-    
-    log_tool "busybox" "Building $variant variant for $arch..."
-    
+
     setup_toolchain_for_arch "$arch" || return 1
-    
+
+    local build_dir=$(create_build_dir "busybox" "$arch")
+
     if ! download_and_extract "$BUSYBOX_URL" "$build_dir" 0 "$BUSYBOX_SHA512"; then
         log_tool_error "busybox" "Failed to download and extract source"
         return 1
     fi
-    
+
     cd "$build_dir/busybox-${BUSYBOX_VERSION}"
-    
-    make defconfig
-    
-    sed -i 's/# CONFIG_STATIC is not set/CONFIG_STATIC=y/' .config
-    sed -i 's/CONFIG_BUILD_LIBBUSYBOX=y/# CONFIG_BUILD_LIBBUSYBOX is not set/' .config
-    sed -i 's/CONFIG_FEATURE_SHARED_BUSYBOX=y/# CONFIG_FEATURE_SHARED_BUSYBOX is not set/' .config
-    
-    if [[ "$arch" != "x86_64" && "$arch" != "i486" && "$arch" != "ix86le" ]]; then
-        sed -i 's/CONFIG_SHA1_HWACCEL=y/# CONFIG_SHA1_HWACCEL is not set/' .config
-        sed -i 's/CONFIG_SHA256_HWACCEL=y/# CONFIG_SHA256_HWACCEL is not set/' .config
-    fi
 
-    # riscv32 (rv32) lacks __NR_settimeofday in its syscall table; disable hwclock
-    # which unconditionally references SYS_settimeofday in util-linux/hwclock.c.
-    if [ "$arch" = "riscv32" ]; then
-        log_tool "busybox" "Disabling CONFIG_HWCLOCK for riscv32 (no SYS_settimeofday)"
-        sed -i 's/^CONFIG_HWCLOCK=y/# CONFIG_HWCLOCK is not set/' .config
-        sed -i 's/^CONFIG_FEATURE_HWCLOCK_LONG_OPTIONS=y/# CONFIG_FEATURE_HWCLOCK_LONG_OPTIONS is not set/' .config
-        sed -i 's/^CONFIG_FEATURE_HWCLOCK_ADJTIME_FHS=y/# CONFIG_FEATURE_HWCLOCK_ADJTIME_FHS is not set/' .config
-    fi
-    
-    if [ "$variant" = "nodrop" ]; then
-        log_tool "busybox" "Applying nodrop modifications..."
-        grep -e "applet:.*BB_SUID_DROP" -rl . | xargs sed -i 's/\(applet:.*\)BB_SUID_DROP/\1BB_SUID_MAYBE/g' || true
-    fi
-    
     local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
     local ldflags=$(get_link_flags "$arch" "static")
-    
+
+    # fixdep and the kconfig programs only depend on the host side
+    local host_key=$(host_tools_key "busybox" "$BUSYBOX_VERSION" "${BUSYBOX_HOST_MAKE[*]}")
+    local host_cached=false
+    host_tools_restore "busybox" "$host_key" && host_cached=true
+
+    prepare_busybox_config "$arch" || {
+        log_tool_error "busybox" "Could not create .config for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+
     export CROSS_COMPILE="$CROSS_COMPILE"
     export CFLAGS="$cflags"
     export LDFLAGS="$ldflags"
-    
+
     if [ "$LIBC_TYPE" = "glibc" ]; then
         export_cross_compiler "$CROSS_COMPILE"
     fi
-    
-    export HOSTCFLAGS="$(echo "$cflags" | sed -E 's/-m(cpu|arch|tune)=[^ ]*//g')"
-    
+
     debug_compiler_info "$arch" "busybox"
-    
-    make ARCH="$CONFIG_ARCH" -j$(nproc) || {
+
+    # Kbuild derives CC from CROSS_COMPILE, which is empty under zig cc
+    local make_tools=()
+    if [ "${USE_ZIG:-0}" = "1" ]; then
+        make_tools=(CC="$CC" AR="$AR" STRIP="$STRIP")
+    fi
+
+    # nodrop alone is a plain build of the edited tree
+    [ "$build_standard" = true ] || apply_nodrop
+
+    make ARCH="$CONFIG_ARCH" "${BUSYBOX_HOST_MAKE[@]}" "${make_tools[@]}" -j$(nproc) || {
         log_tool_error "busybox" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
-    
-    $STRIP busybox
-    local output_path=$(get_output_path "$arch" "$output_name")
-    mkdir -p "$(dirname "$output_path")"
-    cp busybox "$output_path"
-    
-    local size=$(get_binary_size "$output_path")
-    log_tool "busybox" "Built $variant variant successfully for $arch ($size)"
-    
+    [ "$host_cached" = true ] || host_tools_save "busybox" "$host_key" scripts/basic scripts/kconfig
+
+    if [ "$build_standard" = false ]; then
+        install_busybox "$arch" "busybox_nodrop"
+        cleanup_build_dir "$build_dir"
+        return 0
+    fi
+    install_busybox "$arch" "busybox"
+
+    if [ "$build_nodrop" = true ]; then
+        cp busybox busybox.standard
+        apply_nodrop
+        make ARCH="$CONFIG_ARCH" "${BUSYBOX_HOST_MAKE[@]}" "${make_tools[@]}" -j$(nproc) || {
+            log_tool_error "busybox" "nodrop rebuild failed for $arch"
+            cleanup_build_dir "$build_dir"
+            return 1
+        }
+        # Same bytes means make missed the regenerated applet tables
+        if cmp -s busybox busybox.standard; then
+            log_tool_error "busybox" "nodrop rebuild left the standard binary unchanged for $arch"
+            cleanup_build_dir "$build_dir"
+            return 1
+        fi
+        install_busybox "$arch" "busybox_nodrop"
+    fi
+
     cleanup_build_dir "$build_dir"
     return 0
 }
 
 validate_args 1 "Usage: $0 <architecture> [variant]\nVariants: standard (default), nodrop, both" "$@"
 
-arch=$1
-variant="${2:-standard}"
-
-if [ "$variant" = "both" ]; then
-    log_tool "busybox" "Building both standard and nodrop variants for $arch..."
-    build_busybox "$arch" "standard" || exit 1
-    build_busybox "$arch" "nodrop" || exit 1
-else
-    build_busybox "$arch" "$variant" || exit 1
-fi
+build_busybox "$1" "${2:-standard}" || exit 1
@@ -6,6 +6,7 @@ LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/sc
 source "$LIB_DIR/common.sh"        # Core functions: setup_arch, download_source, etc.
 source "$LIB_DIR/core/compile_flags.sh"   # Architecture-specific compiler flags
 source "$LIB_DIR/build_helpers.sh"  # Build utilities: standard_configure, install_binary, etc.
+source "$LIB_DIR/multicall.sh"     # Optional single-binary (argv[0] dispatch) install
 
 CAN_UTILS_VERSION="${CAN_UTILS_VERSION:-2025.01}"
 CAN_UTILS_URL="https://github.com/linux-can/can-utils/archive/refs/tags/v${CAN_UTILS_VERSION}.tar.gz"
@@ -41,6 +42,12 @@ build_can_utils() {
     
     make clean || true
     
+    local multicall=false
+    if multicall_enabled "can-utils"; then
+        multicall=true
+        multicall_begin "$build_dir"
+    fi
+    
     CC="${CC}" \
     CFLAGS="${CFLAGS:-} $cflags -I./include" \
     LDFLAGS="${LDFLAGS:-} $ldflags" \
@@ -57,6 +64,17 @@ build_can_utils() {
     mkdir -p "$can_dir"
     
     local tools="candump cansend canplayer cangen canbusload canfdtest isotpdump isotprecv isotpsend"
+    local extra_tools="canlogserver bcmserver slcan_attach slcand can-calc-bit-timing mcp251xfd-dump"
+    local j1939_tools="j1939spy j1939cat j1939acd j1939sr testj1939"
+    
+    if [ "$multicall" = true ]; then
+        if multicall_install "can-utils" "$arch" "$can_dir" $tools $extra_tools $j1939_tools; then
+            cleanup_build_dir "$build_dir"
+            return 0
+        fi
+        log_tool_warn "can-utils" "Multicall build failed, installing separate binaries"
+    fi
+    
     local installed_count=0
     for tool in $tools; do
         if [ -f "$tool" ]; then
@@ -66,7 +84,6 @@ build_can_utils() {
         fi
     done
     
-    local extra_tools="canlogserver bcmserver slcan_attach slcand can-calc-bit-timing mcp251xfd-dump"
     for tool in $extra_tools; do
         if [ -f "$tool" ]; then
             $STRIP "$tool" 2>/dev/null || true
@@ -75,7 +92,6 @@ build_can_utils() {
         fi
     done
     
-    local j1939_tools="j1939spy j1939cat j1939acd j1939sr testj1939"
     for tool in $j1939_tools; do
         if [ -f "$tool" ]; then
             $STRIP "$tool" 2>/dev/null || true
@@ -50,6 +50,22 @@ build_curl_full() {
         cleanup_build_dir "$build_dir"
         return 1
     }
+
+    # HTTP/2 (multiplexed transfers over one connection) and zstd content
+    # decoding are part of curl-full, not optional extras
+    local nghttp2_dir
+    nghttp2_dir=$(build_nghttp2_cached "$arch") || {
+        log_tool_error "curl-full" "Failed to build/get nghttp2 for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+
+    local zstd_dir
+    zstd_dir=$(build_zstd_cached "$arch") || {
+        log_tool_error "curl-full" "Failed to build/get zstd for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
     
     if ! download_and_extract "$CURL_URL" "$build_dir" 0 "$CURL_SHA512"; then
         log_tool_error "curl-full" "Failed to download and extract source"
@@ -80,13 +96,28 @@ EOF
     local ldflags=$(get_link_flags "$arch" "static")
     
     local cppflags="-I$openssl_dir/include -I$zlib_dir/include -I$libssh2_dir/include"
+    cppflags="$cppflags -I$nghttp2_dir/include -I$zstd_dir/include"
     ldflags="$ldflags -L$openssl_dir/lib -L$zlib_dir/lib -L$libssh2_dir/lib"
+    ldflags="$ldflags -L$nghttp2_dir/lib -L$zstd_dir/lib"
+    local pkg_config_path="$openssl_dir/lib/pkgconfig:$zlib_dir/lib/pkgconfig:$libssh2_dir/lib/pkgconfig"
+    pkg_config_path="$pkg_config_path:$nghttp2_dir/lib/pkgconfig:$zstd_dir/lib/pkgconfig"
+
+    local malloc_flags
+
+    malloc_flags=$(get_malloc_link_flags "$arch" "$TOOL_NAME") || {
+
+        cleanup_build_dir "$build_dir"
+
+        return 1
+
+    }
+    ldflags="$ldflags $malloc_flags"
 
     export CFLAGS="$cflags"
     export CPPFLAGS="$cppflags"
     export LDFLAGS="$ldflags"
     export PKG_CONFIG="pkg-config --static"
-    export PKG_CONFIG_PATH="$openssl_dir/lib/pkgconfig:$zlib_dir/lib/pkgconfig:$libssh2_dir/lib/pkgconfig"
+    export PKG_CONFIG_PATH="$pkg_config_path"
     
     log_tool "curl-full" "Configuring curl-full for $arch..."
     
@@ -140,17 +171,17 @@ EOF
         --with-openssl="$openssl_dir" \
         --with-zlib="$zlib_dir" \
         --with-libssh2="$libssh2_dir" \
+        --with-nghttp2="$nghttp2_dir" \
+        --with-zstd="$zstd_dir" \
         --with-ca-bundle=/etc/ssl/certs/ca-certificates.crt \
         --with-ca-path=/etc/ssl/certs \
         --with-ca-fallback \
         --without-brotli \
-        --without-zstd \
         --without-libpsl \
         --without-libgsasl \
         --without-librtmp \
         --without-winidn \
         --without-libidn2 \
-        --without-nghttp2 \
         --without-nghttp3 \
         --without-ngtcp2 \
         --without-quiche \
@@ -167,12 +198,23 @@ EOF
         cleanup_build_dir "$build_dir"
         return 1
     }
+
+    # configure drops a library it can't link against with only a warning
+    local -A required_macros=([nghttp2]="USE_NGHTTP2" [zstd]="HAVE_ZSTD")
+    local dep
+    for dep in nghttp2 zstd; do
+        if ! grep -q "^#define ${required_macros[$dep]} 1" lib/curl_config.h; then
+            log_tool_error "curl-full" "configure did not enable $dep for $arch (see config.log)"
+            cleanup_build_dir "$build_dir"
+            return 1
+        fi
+    done
     
     log_tool "curl-full" "Building curl-full for $arch..."
 
-    local make_ldflags="$ldflags"
+    local make_ldflags="$ldflags $(get_link_map_flags "$arch" "$TOOL_NAME")"
     if platform_supports_static; then
-        make_ldflags="$ldflags -all-static"
+        make_ldflags="$make_ldflags -all-static"
     fi
 
     make -j$(nproc) LDFLAGS="$make_ldflags" || {
@@ -181,6 +223,12 @@ EOF
         return 1
     }
     
+    if [ -n "$malloc_flags" ] && ! check_malloc_linked src/curl "curl-full"; then
+        cleanup_build_dir "$build_dir"
+        return 1
+    fi
+    
+    save_symbol_sizes src/curl "$arch" "curl-full"
     $STRIP src/curl
     mkdir -p "$(dirname "$output_path")"
     cp src/curl "$output_path"
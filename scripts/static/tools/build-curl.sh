@@ -163,9 +163,9 @@ EOF
     log_tool "curl" "Building curl for $arch..."
 
     # libtool -all-static forces a static executable; Darwin/BSD can't do that.
-    local make_ldflags="$ldflags"
+    local make_ldflags="$ldflags $(get_link_map_flags "$arch" "$TOOL_NAME")"
     if platform_supports_static; then
-        make_ldflags="$ldflags -all-static"
+        make_ldflags="$make_ldflags -all-static"
     fi
 
     make -j$(nproc) LDFLAGS="$make_ldflags" || {
@@ -174,6 +174,7 @@ EOF
         return 1
     }
     
+    save_symbol_sizes src/curl "$arch" "curl"
     $STRIP src/curl
     mkdir -p "$(dirname "$output_path")"
     cp src/curl "$output_path"
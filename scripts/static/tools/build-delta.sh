@@ -0,0 +1,68 @@
+#!/bin/bash
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/core/compile_flags.sh"
+source "$LIB_DIR/build_helpers.sh"
+
+TOOL_NAME="delta"
+SUPPORTED_OS="any"
+SOURCE_PATH="/build/delta-tool"
+
+# Target side of the release delta packages (scripts/make-deltas.sh): only
+# apply/apply-bundle/info are compiled in, the diff engine stays on the host
+build_delta() {
+    local arch=$1
+
+    if ! check_tool_support "$SUPPORTED_OS" "$TOOL_NAME"; then
+        return 1
+    fi
+
+    if check_binary_exists "$arch" "$TOOL_NAME"; then
+        return 0
+    fi
+
+    if [ ! -f "$SOURCE_PATH/delta.c" ]; then
+        log_tool_error "$TOOL_NAME" "$SOURCE_PATH/delta.c missing, is delta-tool/ mounted?"
+        return 1
+    fi
+
+    setup_toolchain_for_arch "$arch" || return 1
+
+    local build_dir=$(create_build_dir "$TOOL_NAME" "$arch")
+    cp "$SOURCE_PATH/delta.c" "$build_dir/"
+    cd "$build_dir"
+
+    local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
+    local ldflags=$(get_link_flags "$arch" "static")
+
+    log_tool "$TOOL_NAME" "Building delta apply tool for $arch..."
+
+    $CC $cflags -o delta delta.c $ldflags $(get_link_map_flags "$arch" "$TOOL_NAME") || {
+        log_tool_error "$TOOL_NAME" "Build failed for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+
+    save_symbol_sizes delta "$arch" "$TOOL_NAME"
+    $STRIP delta 2>/dev/null || true
+    local output_path=$(get_output_path "$arch" "$TOOL_NAME")
+    mkdir -p "$(dirname "$output_path")"
+    cp delta "$output_path"
+
+    local size=$(get_binary_size "$output_path")
+    log_tool "$TOOL_NAME" "Built successfully for $arch ($size)"
+
+    cleanup_build_dir "$build_dir"
+    return 0
+}
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <architecture>"
+    exit 1
+fi
+
+arch=$1
+build_delta "$arch"
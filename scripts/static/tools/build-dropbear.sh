@@ -13,6 +13,34 @@ DROPBEAR_SHA512="c63afa615d64b0c8c5e739c758eb8ae277ecc36a4223b766bf562702de69910
 
 SUPPORTED_OS="linux,android,freebsd,openbsd,netbsd,macos"
 
+# default: size-oriented upstream options. throughput: AEAD/CTR ciphers,
+# larger windows and packets, unrolled crypto built at -O2 (see
+# write_throughput_options)
+DROPBEAR_PROFILE="${DROPBEAR_PROFILE:-default}"
+
+# write_throughput_options - append the throughput profile to localoptions.h.
+# The receive window is allocated per channel as data arrives; dbclient -W
+# and dropbear -W still override it at run time.
+write_throughput_options() {
+    cat >> localoptions.h << 'EOF'
+
+/* Throughput profile (DROPBEAR_PROFILE=throughput) */
+#define DROPBEAR_CHACHA20POLY1305 1
+#define DROPBEAR_AES128 1
+#define DROPBEAR_AES256 1
+#define DROPBEAR_ENABLE_CTR_MODE 1
+#define DROPBEAR_ENABLE_GCM_MODE 1
+
+/* Unrolled libtomcrypt ciphers and hashes instead of the compact loops */
+#define DROPBEAR_SMALL_CODE 0
+
+/* 24 KB / 16 KB upstream: a few packets in flight per round trip */
+#define DEFAULT_RECV_WINDOW (1024 * 1024)
+#define RECV_MAX_PAYLOAD_LEN 65536
+#define TRANS_MAX_PAYLOAD_LEN 32768
+EOF
+}
+
 build_dropbear() {
     local arch=$1
     local build_dir=$(create_build_dir "dropbear" "$arch")
@@ -22,11 +50,18 @@ build_dropbear() {
         return 1
     fi
 
+    case "$DROPBEAR_PROFILE" in
+        default|throughput) ;;
+        *)
+            log_tool_error "dropbear" "Unknown DROPBEAR_PROFILE '$DROPBEAR_PROFILE' (default or throughput)"
+            return 1
+            ;;
+    esac
+
     if check_binary_exists "$arch" "dropbear"; then
         return 0
     fi
 
-
     setup_toolchain_for_arch "$arch" || return 1
     
     if ! download_and_extract "$DROPBEAR_URL" "$build_dir" 0 "$DROPBEAR_SHA512"; then
@@ -104,6 +139,23 @@ EOF
 /* Algorithms - disable weaker ones to save space */
 EOF
     fi
+
+    if [ "$DROPBEAR_PROFILE" = "throughput" ]; then
+        log_tool "dropbear" "Using throughput profile (AEAD ciphers, 1 MB window, -O2 crypto)"
+        write_throughput_options
+
+        # configure substituted the tool's CFLAGS into the bundled
+        # libtomcrypt/libtommath Makefiles; only those get -O2
+        local crypto_mk
+        for crypto_mk in libtomcrypt/Makefile libtommath/Makefile; do
+            [ -f "$crypto_mk" ] || continue
+            if grep -q -- '-Os' "$crypto_mk"; then
+                sed -i 's/-Os\b/-O2/g' "$crypto_mk"
+            elif ! grep -q -- '-O2' "$crypto_mk"; then
+                log_tool_warn "dropbear" "No opt flags in $crypto_mk, crypto keeps the default level"
+            fi
+        done
+    fi
     
     # STATIC=1 appends -static to the final link. Darwin/BSD libc via Zig CC
     # does not support static linking. Passing an empty string on the command
@@ -119,12 +171,13 @@ EOF
         *_macos|*_darwin) _mj=1 ;;
     esac
 
-    make -j$_mj PROGRAMS="dropbear dbclient dropbearkey scp" $static_arg || {
+    make -j$_mj $(link_map_make_args "$arch" "$TOOL_NAME") PROGRAMS="dropbear dbclient dropbearkey scp" $static_arg || {
         log_tool_error "dropbear" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
     
+    save_symbol_sizes dropbear "$arch" "dropbear"
     $STRIP dropbear
     $STRIP dbclient
     $STRIP dropbearkey
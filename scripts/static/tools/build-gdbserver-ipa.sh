@@ -0,0 +1,16 @@
+#!/bin/bash
+# gdbserver plus the in-process agent (libinproctrace.so) for fast
+# tracepoints. Shares the build with build-gdbserver.sh; the output is a
+# directory: output/<arch>/gdbserver-ipa.<libc>/{gdbserver,libinproctrace.so}
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+source "$SCRIPT_DIR/build-gdbserver.sh"
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <architecture>"
+    exit 1
+fi
+
+arch=$1
+build_gdbserver "$arch" "gdbserver-ipa"
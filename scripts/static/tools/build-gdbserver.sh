@@ -13,33 +13,45 @@ GDB_SHA512="fffd6689c3405466a179670b04720dc825e4f210a761f63dd2b33027432f8cd5d1c0
 
 SUPPORTED_OS="linux,android"  # gdbserver uses Linux ptrace flavor and /proc
 
-# Arches with no upstream gdbserver support in gdb-16.3:
-#   - microblaze, microblazeel, nios2: no case in gdbserver/configure.srv (no
-#     linux-<arch>-low.cc, no register object) — link fails with undefined
-#     references to initialize_low() and using_threads.
-#   - or1k: configure.srv has or1k*-*-linux*, but musl's sys/procfs.h omits
-#     elf_gregset_t/elf_fpregset_t for or1k, causing linux-or1k-low.cc to
-#     fail to compile against the or1k-linux-musl toolchain.
-GDBSERVER_UNSUPPORTED_ARCHS="microblaze microblazeel nios2 or1k"
+# Arches with no gdbserver backend in gdb-16.3 (microblaze, nios2, or1k)
+# are listed, with the reasons, in scripts/lib/support_matrix.sh
 
+# ipa_already_built <arch> - gdbserver-ipa ships as a directory holding the
+# static gdbserver and the agent library
+ipa_already_built() {
+    local out_dir=$(get_output_dir "$1" "gdbserver-ipa")
+
+    [ "${SKIP_IF_EXISTS:-true}" = "true" ] || return 1
+    [ -s "$out_dir/gdbserver" ] && [ -s "$out_dir/libinproctrace.so" ] || return 1
+    log "[$1] Already built: $out_dir"
+}
+
+# build_gdbserver <arch> [gdbserver|gdbserver-ipa]
+#
+# gdbserver-ipa also builds the in-process agent (libinproctrace.so) that
+# fast tracepoints (gdb "ftrace") need: the inferior loads it (LD_PRELOAD)
+# and tracepoint hits jump into it instead of trapping to gdbserver. The
+# agent links dynamically against the target libc, so use the build whose
+# libc matches the process being traced.
 build_gdbserver() {
     local arch=$1
-    local TOOL_NAME="gdbserver"
+    local TOOL_NAME="${2:-gdbserver}"
+    local ipa=false
+    [ "$TOOL_NAME" = "gdbserver-ipa" ] && ipa=true
 
     if ! check_tool_support "$SUPPORTED_OS" "$TOOL_NAME"; then
         return 1
     fi
 
-    for unsupported in $GDBSERVER_UNSUPPORTED_ARCHS; do
-        if [ "$arch" = "$unsupported" ]; then
-            log_tool "gdbserver" "SKIP: $arch has no upstream gdbserver support in gdb-${GDB_VERSION}"
-            return 2
-        fi
-    done
+    if support_matrix_skip "gdbserver" "$arch" || support_matrix_skip "$TOOL_NAME" "$arch"; then
+        return 2
+    fi
 
-    local build_dir=$(create_build_dir "gdbserver" "$arch")
+    local build_dir=$(create_build_dir "$TOOL_NAME" "$arch")
 
-    if check_binary_exists "$arch" "gdbserver"; then
+    if [ "$ipa" = true ]; then
+        ipa_already_built "$arch" && return 0
+    elif check_binary_exists "$arch" "gdbserver"; then
         return 0
     fi
 
@@ -80,6 +92,9 @@ PATCH
     export CFLAGS="$cflags"
     export LDFLAGS="$ldflags"
 
+    local ipa_flag="--disable-inprocess-agent"
+    [ "$ipa" = true ] && ipa_flag="--enable-inprocess-agent"
+
     ./configure \
         --host=$HOST \
         --target=$HOST \
@@ -96,7 +111,7 @@ PATCH
         --without-guile \
         --without-gmp \
         --without-mpfr \
-        --disable-inprocess-agent \
+        $ipa_flag \
         --disable-nls \
         --without-expat \
         --disable-source-highlight || {
@@ -105,28 +120,67 @@ PATCH
         return 1
     }
     
-    make -j$(nproc) all-gdbserver MAKEINFO=true || {
+    # The agent is left out of this pass (extra_libraries=): it cannot be
+    # linked with the -static LDFLAGS the gdbserver binary needs
+    make -j$(nproc) all-gdbserver MAKEINFO=true extra_libraries= || {
         log_tool_error "gdbserver" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
+
+    # Relink with the link map for the size report; given to the first make
+    # it would also reach gdbserver's own configure run
+    local map_args=$(link_map_make_args "$arch" "$TOOL_NAME")
+    if [ -n "$map_args" ]; then
+        rm -f gdbserver/gdbserver
+        make -C gdbserver $map_args gdbserver MAKEINFO=true || {
+            log_tool_error "gdbserver" "Link failed for $arch"
+            cleanup_build_dir "$build_dir"
+            return 1
+        }
+    fi
+
+    if [ "$ipa" = true ]; then
+        # Objects are already -fPIC (IPA_CFLAGS); link as a plain shared
+        # library against the toolchain's libc
+        make -C gdbserver -j$(nproc) libinproctrace.so MAKEINFO=true \
+            LDFLAGS="-Wl,--build-id=sha1" || {
+            log_tool_error "$TOOL_NAME" "In-process agent build failed for $arch"
+            cleanup_build_dir "$build_dir"
+            return 1
+        }
+    fi
     
+    save_symbol_sizes gdbserver/gdbserver "$arch" "$TOOL_NAME"
     $STRIP gdbserver/gdbserver
+
+    if [ "$ipa" = true ]; then
+        local out_dir=$(get_output_dir "$arch" "$TOOL_NAME")
+        mkdir -p "$out_dir"
+        $STRIP --strip-unneeded gdbserver/libinproctrace.so
+        cp gdbserver/gdbserver gdbserver/libinproctrace.so "$out_dir/"
+        log_tool "$TOOL_NAME" "Built successfully for $arch ($(du -sh "$out_dir" | cut -f1) in ${out_dir##*/})"
+        cleanup_build_dir "$build_dir"
+        return 0
+    fi
+
     local output_path=$(get_output_path "$arch" "gdbserver")
     mkdir -p "$(dirname "$output_path")"
     cp gdbserver/gdbserver "$output_path"
     
-    local size=$(ls -lh "/build/output/$arch/gdbserver" | awk '{print $5}')
+    local size=$(ls -lh "$output_path" | awk '{print $5}')
     log_tool "gdbserver" "Built successfully for $arch ($size)"
     
     cleanup_build_dir "$build_dir"
     return 0
 }
 
-if [ $# -eq 0 ]; then
-    echo "Usage: $0 <architecture>"
-    exit 1
-fi
+if [ "${BASH_SOURCE[0]}" = "${0}" ]; then
+    if [ $# -eq 0 ]; then
+        echo "Usage: $0 <architecture>"
+        exit 1
+    fi
 
-arch=$1
-build_gdbserver "$arch"
+    arch=$1
+    build_gdbserver "$arch"
+fi
@@ -6,6 +6,7 @@ LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/sc
 source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
+source "$LIB_DIR/multicall.sh"
 
 I2C_TOOLS_VERSION="${I2C_TOOLS_VERSION:-4.4}"
 I2C_TOOLS_URL="https://mirrors.edge.kernel.org/pub/software/utils/i2c-tools/i2c-tools-${I2C_TOOLS_VERSION}.tar.xz"
@@ -43,6 +44,12 @@ build_i2c_tools() {
     local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
     local ldflags=$(get_link_flags "$arch" "static")
 
+    local multicall=false
+    if multicall_enabled "i2c-tools"; then
+        multicall=true
+        multicall_begin "$build_dir"
+    fi
+
     # Build static library first, then tools linked against it
     # USE_STATIC_LIB=1 links tools against the static libi2c.a
     # BUILD_DYNAMIC_LIB=0 skips shared library (not needed)
@@ -63,6 +70,15 @@ build_i2c_tools() {
     mkdir -p "$i2c_dir"
 
     local tools="i2cdetect i2cdump i2cset i2cget i2ctransfer"
+
+    if [ "$multicall" = true ]; then
+        if multicall_install "i2c-tools" "$arch" "$i2c_dir" $tools; then
+            cleanup_build_dir "$build_dir"
+            return 0
+        fi
+        log_tool_warn "i2c-tools" "Multicall build failed, installing separate binaries"
+    fi
+
     local installed_count=0
     for tool in $tools; do
         if [ -f "tools/$tool" ]; then
@@ -0,0 +1,69 @@
+#!/bin/bash
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/core/compile_flags.sh"
+source "$LIB_DIR/build_helpers.sh"
+
+TOOL_NAME="iotrace-read"
+SUPPORTED_OS="linux,android"  # Reads /proc and the shared ring libiotrace maps
+SOURCE_PATH="/build/iotrace"
+
+# Reader side of libiotrace (scripts/shared/tools/build-iotrace.sh): drains
+# the ring a traced process writes and prints per-fd latency histograms.
+# Static, so it runs next to a target built against any libc.
+build_iotrace_read() {
+    local arch=$1
+
+    if ! check_tool_support "$SUPPORTED_OS" "$TOOL_NAME"; then
+        return 1
+    fi
+
+    if check_binary_exists "$arch" "$TOOL_NAME"; then
+        return 0
+    fi
+
+    if [ ! -f "$SOURCE_PATH/iotrace-read.c" ]; then
+        log_tool_error "$TOOL_NAME" "$SOURCE_PATH/iotrace-read.c missing, is iotrace/ mounted?"
+        return 1
+    fi
+
+    setup_toolchain_for_arch "$arch" || return 1
+
+    local build_dir=$(create_build_dir "$TOOL_NAME" "$arch")
+    cp "$SOURCE_PATH/iotrace-read.c" "$SOURCE_PATH/iotrace.h" "$build_dir/"
+    cd "$build_dir"
+
+    local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
+    local ldflags=$(get_link_flags "$arch" "static")
+
+    log_tool "$TOOL_NAME" "Building iotrace ring reader for $arch..."
+
+    $CC $cflags -o iotrace-read iotrace-read.c $ldflags $(get_link_map_flags "$arch" "$TOOL_NAME") || {
+        log_tool_error "$TOOL_NAME" "Build failed for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+
+    save_symbol_sizes iotrace-read "$arch" "$TOOL_NAME"
+    $STRIP iotrace-read 2>/dev/null || true
+    local output_path=$(get_output_path "$arch" "$TOOL_NAME")
+    mkdir -p "$(dirname "$output_path")"
+    cp iotrace-read "$output_path"
+
+    local size=$(get_binary_size "$output_path")
+    log_tool "$TOOL_NAME" "Built successfully for $arch ($size)"
+
+    cleanup_build_dir "$build_dir"
+    return 0
+}
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <architecture>"
+    exit 1
+fi
+
+arch=$1
+build_iotrace_read "$arch"
@@ -67,6 +67,10 @@ build_ltrace() {
         return 1
     fi
 
+    if support_matrix_skip "$TOOL_NAME" "$arch"; then
+        return 2
+    fi
+
     log_tool "$arch" "Starting ltrace build..."
 
     local arch_build_dir="${BUILD_DIR}/${TOOL_NAME}-${TOOL_VERSION}-${arch}"
@@ -198,7 +202,7 @@ build_ltrace() {
         done
     fi
 
-    ${CC} $cflags $ldflags -o ltrace \
+    ${CC} $cflags $ldflags $(get_link_map_flags "$arch" "$TOOL_NAME") -o ltrace \
         main.o \
         ./.libs/libltrace.a \
         sysdeps/.libs/libos.a \
@@ -212,6 +216,7 @@ build_ltrace() {
 
     local output_file=$(get_output_path "$arch" "$TOOL_NAME")
     mkdir -p "$(dirname "$output_file")"
+    save_symbol_sizes ltrace "$arch" "$TOOL_NAME"
     ${STRIP} ltrace
     cp ltrace "$output_file"
     
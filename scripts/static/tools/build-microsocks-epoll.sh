@@ -0,0 +1,89 @@
+#!/bin/bash
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/scripts/lib"
+source "$LIB_DIR/common.sh"
+source "$LIB_DIR/core/compile_flags.sh"
+source "$LIB_DIR/build_helpers.sh"
+
+MICROSOCKS_VERSION="${MICROSOCKS_VERSION:-1.0.5}"
+MICROSOCKS_URL="http://ftp.barfooze.de/pub/sabotage/tarballs/microsocks-${MICROSOCKS_VERSION}.tar.xz"
+MICROSOCKS_SHA512="16b99f1b94dd857f6ee303f2fb3ef85acd5d8cad2a7635bca7d78c3106bd9beb846a4363286d2d1f395a9bcc115890736c883835590f22234e7955fab6066a66"
+
+# epoll and splice() are Linux-only (see patches/microsocks-epoll/)
+SUPPORTED_OS="linux,android"
+
+build_microsocks_epoll() {
+    local arch=$1
+    local build_dir=$(create_build_dir "microsocks-epoll" "$arch")
+    local TOOL_NAME="microsocks-epoll"
+
+    if ! check_tool_support "$SUPPORTED_OS" "$TOOL_NAME"; then
+        return 1
+    fi
+
+    if check_binary_exists "$arch" "microsocks-epoll"; then
+        return 0
+    fi
+
+    setup_toolchain_for_arch "$arch" || return 1
+
+    if ! download_and_extract "$MICROSOCKS_URL" "$build_dir" 0 "$MICROSOCKS_SHA512"; then
+        log_tool_error "microsocks-epoll" "Failed to download and extract source"
+        cleanup_build_dir "$build_dir"
+        return 1
+    fi
+
+    cd "$build_dir/microsocks-${MICROSOCKS_VERSION}"
+
+    local patches_dir="/build/patches/microsocks-epoll"
+    for patch_file in "$patches_dir"/*.patch; do
+        [ -f "$patch_file" ] || continue
+        log_tool "microsocks-epoll" "Applying $(basename "$patch_file")..."
+        patch -p1 < "$patch_file" || {
+            log_tool_error "microsocks-epoll" "Failed to apply $(basename "$patch_file")"
+            cleanup_build_dir "$build_dir"
+            return 1
+        }
+    done
+
+    if [ ! -f sockssrv-epoll.c ]; then
+        log_tool_error "microsocks-epoll" "sockssrv-epoll.c missing, is $patches_dir mounted?"
+        cleanup_build_dir "$build_dir"
+        return 1
+    fi
+
+    local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
+    local ldflags=$(get_link_flags "$arch" "static")
+
+    log_tool "microsocks-epoll" "Building microsocks (epoll/splice) for $arch..."
+
+    # Single translation unit; the upstream Makefile only knows the
+    # threaded server
+    $CC $cflags -o microsocks sockssrv-epoll.c $ldflags -lpthread || {
+        log_tool_error "microsocks-epoll" "Build failed for $arch"
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+
+    save_symbol_sizes microsocks "$arch" "microsocks-epoll"
+    $STRIP microsocks 2>/dev/null || true
+    local output_path=$(get_output_path "$arch" "microsocks-epoll")
+    mkdir -p "$(dirname "$output_path")"
+    cp microsocks "$output_path"
+
+    local size=$(get_binary_size "$output_path")
+    log_tool "microsocks-epoll" "Built successfully for $arch ($size)"
+
+    cleanup_build_dir "$build_dir"
+    return 0
+}
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <architecture>"
+    exit 1
+fi
+
+arch=$1
+build_microsocks_epoll "$arch"
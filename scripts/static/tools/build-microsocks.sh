@@ -67,7 +67,8 @@ build_microsocks() {
 
     log_tool "microsocks" "Building microsocks for $arch..."
 
-    make -j$(nproc) CC="${CC}" CFLAGS="$cflags" LDFLAGS="$ldflags $extra_libs" LIBS="$extra_libs" || {
+    local map_flags=$(get_link_map_flags "$arch" "$TOOL_NAME")
+    make -j$(nproc) CC="${CC}" CFLAGS="$cflags" LDFLAGS="$ldflags $map_flags $extra_libs" LIBS="$extra_libs" || {
         log_tool_error "microsocks" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
@@ -78,6 +79,7 @@ build_microsocks() {
     local built_binary="microsocks"
     [ -f "microsocks.exe" ] && built_binary="microsocks.exe"
 
+    save_symbol_sizes "$built_binary" "$arch" "microsocks"
     $STRIP "$built_binary" 2>/dev/null || true
     local output_path=$(get_output_path "$arch" "microsocks")
     mkdir -p "$(dirname "$output_path")"
@@ -7,6 +7,7 @@ source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
 source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/multicall.sh"
 
 TOOL_NAME="mtd-utils"
 SUPPORTED_OS="linux,android"
@@ -62,6 +63,12 @@ build_mtd_utils() {
         export_cross_compiler "$CROSS_COMPILE"
     fi
 
+    local multicall=false
+    if multicall_enabled "mtd-utils"; then
+        multicall=true
+        multicall_begin "$build_dir"
+    fi
+
     # Generate configure script (GitHub archive has no pre-generated configure).
     # Strip toolchain from PATH: Buildroot glibc toolchains ship broken autoreconf
     # wrappers with a hardcoded Perl @INC pointing at /builds/buildroot.org/...
@@ -118,6 +125,15 @@ build_mtd_utils() {
     # Misc flash utilities
     local misc_tools="flash_erase flash_lock flash_unlock flashcp mtdpart flash_otp_info flash_otp_dump flash_otp_lock flash_otp_erase flash_otp_write ftl_format ftl_check doc_loadbios docfdisk mtd_debug serve_image recv_image"
 
+    if [ "$multicall" = true ]; then
+        if multicall_install "mtd-utils" "$arch" "$mtd_dir" $nand_tools $ubi_tools $misc_tools; then
+            trap - EXIT
+            cleanup_build_dir "$build_dir"
+            return 0
+        fi
+        log_tool_warn "mtd-utils" "Multicall build failed, installing separate binaries"
+    fi
+
     local installed_count=0
     for tool in $nand_tools $ubi_tools $misc_tools; do
         if [ -f "$tool" ]; then
@@ -242,7 +242,7 @@ makefile.dep:\
         esac
     fi
 
-    make $make_jobs "${make_vars[@]}" AR="$AR" RANLIB="$RANLIB" LIBS="$extra_libs" || {
+    make $make_jobs $(link_map_make_args "$arch" "$TOOL_NAME") "${make_vars[@]}" AR="$AR" RANLIB="$RANLIB" LIBS="$extra_libs" || {
         log_tool_error "ncat-ssl" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
@@ -251,6 +251,7 @@ makefile.dep:\
     local built_binary="ncat"
     [ -f "ncat.exe" ] && built_binary="ncat.exe"
 
+    save_symbol_sizes "$built_binary" "$arch" "ncat-ssl"
     $STRIP "$built_binary" 2>/dev/null || true
     local output_path=$(get_output_path "$arch" "ncat-ssl")
     mkdir -p "$(dirname "$output_path")"
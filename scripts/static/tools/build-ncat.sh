@@ -341,7 +341,7 @@ makefile.dep:\
             *windows*|*macos*|*darwin*) make_jobs="-j1" ;;
         esac
     fi
-    make $make_jobs "${make_vars[@]}" AR="$AR" RANLIB="$RANLIB" LIBS="$extra_libs" || {
+    make $make_jobs $(link_map_make_args "$arch" "$TOOL_NAME") "${make_vars[@]}" AR="$AR" RANLIB="$RANLIB" LIBS="$extra_libs" || {
         log_tool_error "ncat" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
@@ -351,6 +351,7 @@ makefile.dep:\
     local built_binary="ncat"
     [ -f "ncat.exe" ] && built_binary="ncat.exe"
 
+    save_symbol_sizes "$built_binary" "$arch" "ncat"
     $STRIP "$built_binary" 2>/dev/null || true
     local output_path=$(get_output_path "$arch" "ncat")
     mkdir -p "$(dirname "$output_path")"
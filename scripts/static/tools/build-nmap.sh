@@ -62,6 +62,12 @@ build_nmap() {
     cflags="$cflags -I$pcap_dir/include -I$ssl_dir/include -I$zlib_dir/include"
     cxxflags="$cxxflags -I$pcap_dir/include -I$ssl_dir/include -I$zlib_dir/include"
     ldflags="$ldflags -L$pcap_dir/lib -L$ssl_dir/lib -L$zlib_dir/lib"
+    local malloc_flags
+    malloc_flags=$(get_malloc_link_flags "$arch" "$TOOL_NAME") || {
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+    ldflags="$ldflags $malloc_flags"
     
     export CC="$CC"
     export CXX="$CXX"
@@ -99,13 +105,18 @@ build_nmap() {
     fi
     
     
-    make V=1 -j$(nproc) || {
+    make V=1 -j$(nproc) $(link_map_make_args "$arch" "$TOOL_NAME") || {
         log_tool_error "nmap" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
     
     if [ -f "nmap" ]; then
+        if [ -n "$malloc_flags" ] && ! check_malloc_linked nmap "nmap"; then
+            cleanup_build_dir "$build_dir"
+            return 1
+        fi
+        save_symbol_sizes nmap "$arch" "nmap"
         $STRIP nmap
         local output_path=$(get_output_path "$arch" "nmap")
     mkdir -p "$(dirname "$output_path")"
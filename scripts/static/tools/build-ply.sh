@@ -195,7 +195,7 @@ EOF
     }
     
     log_tool "$arch" "Building ${TOOL_NAME}..."
-    make -j$(nproc) LDFLAGS="$ldflags" AM_LDFLAGS="-all-static" || {
+    make -j$(nproc) LDFLAGS="$ldflags $(get_link_map_flags "$arch" "$TOOL_NAME")" AM_LDFLAGS="-all-static" || {
         log_tool "$arch" "ERROR: Build failed" >&2
         return 1
     }
@@ -241,6 +241,7 @@ install_tool() {
     fi
     
     log_tool "$arch" "Stripping ${TOOL_NAME} binary..."
+    save_symbol_sizes "${install_dir}/ply" "$arch" "$TOOL_NAME"
     "${STRIP}" "${install_dir}/ply" || {
         log_tool "$arch" "WARNING: Failed to strip binary" >&2
     }
@@ -256,28 +257,11 @@ main() {
     
     local arch=$1
     
-    case "$arch" in
-        x86_64)
-            ;;
-        aarch64)
-            ;;
-        arm32v5le|arm32v5lehf|arm32v7le|arm32v7lehf|armv6)
-            ;;
-        mips32le|mips64le)
-            ;;
-        riscv32)
-            ;;
-        riscv64)
-            ;;
-        ppc64le)
-            ;;
-        *)
-            log_tool "$arch" "ERROR: Architecture is not supported by ply" >&2
-            log_tool "$arch" "Supported: x86_64, aarch64 (LE), arm32 (LE), mips (LE), riscv32/64, ppc64le" >&2
-            log_tool "$arch" "Note: Big-endian variants are not confirmed to work" >&2
-            return 1
-            ;;
-    esac
+    # Supported arches (little-endian BPF backends) are listed in
+    # scripts/lib/support_matrix.sh
+    if support_matrix_skip "ply" "$arch"; then
+        return 2
+    fi
     
     mkdir -p "/build/output/$arch"
     
@@ -96,12 +96,13 @@ build_socat_ssl() {
         return 1
     }
     
-    make V=1 -j$(nproc) || {
+    make V=1 -j$(nproc) $(link_map_make_args "$arch" "$TOOL_NAME") || {
         log_tool_error "socat-ssl" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
     
+    save_symbol_sizes socat "$arch" "socat-ssl"
     $STRIP socat
     local output_path=$(get_output_path "$arch" "socat-ssl")
     mkdir -p "$(dirname "$output_path")"
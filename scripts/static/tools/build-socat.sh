@@ -67,12 +67,13 @@ build_socat() {
         return 1
     }
     
-    make -j$(nproc) || {
+    make -j$(nproc) $(link_map_make_args "$arch" "$TOOL_NAME") || {
         log_tool_error "socat" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
     
+    save_symbol_sizes socat "$arch" "socat"
     $STRIP socat
     local output_path=$(get_output_path "$arch" "socat")
     mkdir -p "$(dirname "$output_path")"
@@ -6,6 +6,7 @@ LIB_DIR="$(cd "$SCRIPT_DIR/../../lib" 2>/dev/null && pwd)" || LIB_DIR="/build/sc
 source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
+source "$LIB_DIR/multicall.sh"
 
 TOOL_NAME="spidev-tools"
 SUPPORTED_OS="linux,android"
@@ -58,6 +59,12 @@ build_spidev_tools() {
     export LDFLAGS="$ldflags"
     export_cross_compiler "$CROSS_COMPILE"
 
+    local multicall=false
+    if multicall_enabled "spidev-tools"; then
+        multicall=true
+        multicall_begin "$build_dir"
+    fi
+
     ./configure \
         --host="$HOST" \
         --enable-static \
@@ -77,6 +84,15 @@ build_spidev_tools() {
     mkdir -p "$spi_dir"
 
     local tools="spi-pipe spi-config"
+
+    if [ "$multicall" = true ]; then
+        if multicall_install "spidev-tools" "$arch" "$spi_dir" $tools; then
+            cleanup_build_dir "$build_dir"
+            return 0
+        fi
+        log_tool_warn "spidev-tools" "Multicall build failed, installing separate binaries"
+    fi
+
     local installed_count=0
     for tool in $tools; do
         if [ -f "src/$tool" ]; then
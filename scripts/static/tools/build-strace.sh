@@ -6,13 +6,11 @@ source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
 source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/qemu_runner.sh"
 
 TOOL_NAME="strace"
 SUPPORTED_OS="linux,android"  # strace is Linux-specific
-# Arches with no upstream strace support:
-#   - riscv32: upstream strace only supports riscv64 (configure errors out with
-#     "architecture riscv32 is not supported by strace"). Hard upstream gate.
-STRACE_UNSUPPORTED_ARCHS="riscv32"
+# Unsupported arches (riscv32) are listed in scripts/lib/support_matrix.sh
 STRACE_VERSION="${STRACE_VERSION:-6.6}"
 STRACE_URL="https://github.com/strace/strace/releases/download/v${STRACE_VERSION}/strace-${STRACE_VERSION}.tar.xz"
 STRACE_SHA512="77ea45c72e513f6c07026cd9b2cc1a84696a5a35cdd3b06dd4a360fb9f9196958e3f6133b4a9c91e091c24066ba29e0330b6459d18a9c390caae2dba97ab399b"
@@ -36,6 +34,66 @@ install_strace() {
     install_binary "src/strace" "$arch" "strace" "$TOOL_NAME"
 }
 
+# --seccomp-bpf needs a kernel that selects HAVE_ARCH_SECCOMP_FILTER for the
+# arch. strace builds the filter code everywhere (it bundles the uapi
+# headers), so this is the only structural limit. Prints the reason when
+# the fast path is unavailable, nothing otherwise.
+get_seccomp_unavailable_reason() {
+    local arch=$1
+
+    case "$arch" in
+        x86_64|x86_64_x32|i486|ix86le) ;;
+        aarch64|aarch64_be|arm*|armeb*|armel*|armv*) ;;
+        mips*|ppc*|riscv64|s390x|loongarch64) ;;
+        m68k|m68k_coldfire|sh2|sh2eb|sh4|sh4eb|xtensa) ;;
+        microblaze|microblazeel|nios2|or1k|arcle_hs38)
+            echo "kernel has no seccomp filter support for this arch" ;;
+        sparc64)
+            echo "kernel only has strict seccomp (no filters) on sparc64" ;;
+        *)
+            echo "seccomp filter support not known for this arch" ;;
+    esac
+}
+
+# verify_strace_seccomp <arch> - record in the manifest whether
+# `strace --seccomp-bpf` works for this build:
+#   verified             ran natively, filter attached and the trace completed
+#   built                kernel ABI supports it, not run here (qemu-user
+#                        cannot ptrace) or ptrace is blocked in this container
+#   unavailable: <why>   strace falls back to stopping on every syscall
+verify_strace_seccomp() {
+    local arch=$1
+    local binary=$(get_output_path "$arch" "$TOOL_NAME")
+    local entry=$(basename "$binary")
+    local status reason
+
+    if reason=$(get_seccomp_unavailable_reason "$arch") && [ -n "$reason" ]; then
+        status="unavailable: $reason"
+        log_tool "$TOOL_NAME" "--seccomp-bpf unavailable on $arch: $reason"
+    elif ! is_native_arch "$arch" || [ ! -x /bin/true ]; then
+        status="built"
+    else
+        local out rc
+        out=$("$binary" -f --seccomp-bpf -e trace=execve -o /dev/null /bin/true 2>&1)
+        rc=$?
+
+        if echo "$out" | grep -q "seccomp"; then
+            # "--seccomp-bpf is not enabled because ..." or a failed
+            # PR_SET_SECCOMP: the fast path silently degrades, say so
+            status="unavailable: $(echo "$out" | grep -m1 "seccomp" | sed 's/^[^:]*: //')"
+            log_tool_warn "$TOOL_NAME" "--seccomp-bpf does not work on $arch: ${status#unavailable: }"
+        elif [ $rc -ne 0 ]; then
+            status="built"
+            log_tool "$TOOL_NAME" "Cannot ptrace in this environment, --seccomp-bpf not runtime-verified"
+        else
+            status="verified"
+            log_tool "$TOOL_NAME" "--seccomp-bpf verified on $arch"
+        fi
+    fi
+
+    manifest_set "$arch" "$entry" seccomp_bpf "$status"
+}
+
 build_strace() {
     local arch=$1
     
@@ -44,14 +102,13 @@ build_strace() {
         return 1
     fi
 
-    for unsupported in $STRACE_UNSUPPORTED_ARCHS; do
-        if [ "$arch" = "$unsupported" ]; then
-            log_tool "$TOOL_NAME" "SKIP: $arch has no upstream strace support in strace-${STRACE_VERSION}"
-            return 2
-        fi
-    done
+    if support_matrix_skip "$TOOL_NAME" "$arch"; then
+        return 2
+    fi
 
     if check_binary_exists "$arch" "$TOOL_NAME"; then
+        local entry=$(basename "$(get_output_path "$arch" "$TOOL_NAME")")
+        [ -n "$(manifest_get "$arch" "$entry" seccomp_bpf)" ] || verify_strace_seccomp "$arch"
         return 0
     fi
     
@@ -121,6 +178,8 @@ build_strace() {
         log_tool_error "$TOOL_NAME" "Installation failed for $arch"
         return 1
     }
+
+    verify_strace_seccomp "$arch"
     
     trap - EXIT
     cleanup_build_dir "$build_dir"
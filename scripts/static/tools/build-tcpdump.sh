@@ -53,6 +53,12 @@ build_tcpdump() {
     
     local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
     local ldflags=$(get_link_flags "$arch" "static")
+    local malloc_flags
+    malloc_flags=$(get_malloc_link_flags "$arch" "$TOOL_NAME") || {
+        cleanup_build_dir "$build_dir"
+        return 1
+    }
+    ldflags="$ldflags $malloc_flags"
     
     # Tell tcpdump's autoconf that our bundled libpcap 1.10.4 provides these
     # functions — otherwise it links its own missing/*.o compatibility shims,
@@ -77,12 +83,18 @@ build_tcpdump() {
         return 1
     }
     
-    make -j$(nproc) || {
+    make -j$(nproc) $(link_map_make_args "$arch" "$TOOL_NAME") || {
         log_tool_error "tcpdump" "Build failed for $arch"
         cleanup_build_dir "$build_dir"
         return 1
     }
     
+    if [ -n "$malloc_flags" ] && ! check_malloc_linked tcpdump "tcpdump"; then
+        cleanup_build_dir "$build_dir"
+        return 1
+    fi
+    
+    save_symbol_sizes tcpdump "$arch" "tcpdump"
     $STRIP tcpdump
     local output_path=$(get_output_path "$arch" "tcpdump")
     mkdir -p "$(dirname "$output_path")"
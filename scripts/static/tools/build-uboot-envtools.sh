@@ -6,6 +6,7 @@ source "$LIB_DIR/common.sh"
 source "$LIB_DIR/core/compile_flags.sh"
 source "$LIB_DIR/build_helpers.sh"
 source "$LIB_DIR/tools.sh"
+source "$LIB_DIR/host_tools_cache.sh"
 
 TOOL_NAME="uboot-envtools"
 SUPPORTED_OS="linux,android"
@@ -27,9 +28,17 @@ build_uboot_envtools_impl() {
     # This implicitly builds scripts/basic/fixdep with the real HOST compiler —
     # so target cross flags MUST NOT leak from the environment (otherwise host
     # gcc chokes on -mx32, -mabi=ilp32d, -march=<cross>, etc.).
-    env -u CFLAGS -u CXXFLAGS -u LDFLAGS -u CC -u CXX -u LD -u AR -u RANLIB -u STRIP -u NM \
-        make sandbox_defconfig HOSTCC=/usr/bin/gcc HOSTCXX=/usr/bin/g++ HOSTLD=/usr/bin/ld \
-            HOSTCFLAGS= HOSTLDFLAGS= 2>&1 | tail -5 || return 1
+    #
+    # None of that depends on the target, so the first arch caches fixdep,
+    # kconfig and the resulting .config and later arches unpack them.
+    local host_key=$(host_tools_key "$TOOL_NAME" "$UBOOT_ENVTOOLS_VERSION" sandbox_defconfig)
+    if ! host_tools_restore "$TOOL_NAME" "$host_key"; then
+        env -u CFLAGS -u CXXFLAGS -u LDFLAGS -u CC -u CXX -u LD -u AR -u RANLIB -u STRIP -u NM \
+            make sandbox_defconfig HOSTCC=/usr/bin/gcc HOSTCXX=/usr/bin/g++ HOSTLD=/usr/bin/ld \
+                HOSTCFLAGS= HOSTLDFLAGS= 2>&1 | tail -5
+        [ -s .config ] || return 1
+        host_tools_save "$TOOL_NAME" "$host_key" .config scripts/basic scripts/kconfig include/config
+    fi
 
     local cflags=$(get_compile_flags "$arch" "static" "$TOOL_NAME")
     local ldflags=$(get_link_flags "$arch" "static")